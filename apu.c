@@ -20,6 +20,8 @@
 #include "audio.h"
 #include "mem.h"
 #include "cpu.h"
+#include "state.h"
+#include "stats.h"
 
 #define P1_ENABLE (1<<0)
 #define P2_ENABLE (1<<1)
@@ -37,10 +39,6 @@
 
 static struct {
 	uint8_t reg[0x18];
-	uint32_t BufSize;
-	uint32_t BufSizeBytes;
-	uint32_t curBufPos;
-	uint32_t Frequency;
 	uint16_t freq1;
 	uint16_t freq2;
 	uint16_t triFreq;
@@ -74,7 +72,6 @@ static struct {
 	float tndLookupTbl[204];
 	float lpVal;
 	float hpVal;
-	float *OutBuf;
 	float lastHPOut;
 	float lastLPOut;
 	float *ampVol;
@@ -83,7 +80,6 @@ static struct {
 	int32_t tndLookupTbl[204];
 	int32_t lpVal;
 	int32_t hpVal;
-	int16_t *OutBuf;
 	int32_t lastHPOut;
 	int32_t lastLPOut;
 	int32_t *ampVol;
@@ -105,7 +101,22 @@ static struct {
 	const uint8_t *lengthLookupTbl;
 	const uint8_t *triSeq;
 
-	bool waitForRefill;
+	//everything from here on is output side,
+	//machine snapshots stop right before it
+	uint32_t BufSize;
+	uint32_t BufSizeBytes;
+	uint32_t curBufPos;
+	uint32_t Frequency;
+	#if AUDIO_FLOAT
+	float *OutBuf;
+	#else
+	int16_t *OutBuf;
+	#endif
+	//fast-forward output decimation
+	uint8_t outStride, outStrideCtr;
+	bool outMute;
+	//times the buffer got handed out or dropped
+	uint32_t BufFlushes;
 } apu;
 
 #if AUDIO_FLOAT
@@ -174,6 +185,8 @@ extern uint32_t vrc7CycleTimer;
 
 extern bool nesPAL;
 uint8_t audioExpansion;
+//skips sample output for frames nobody will hear
+bool apuSkipOutput = false;
 void apuInitBufs()
 {
 	apu.noisePeriod = nesPAL ? noisePeriodPal : noisePeriodNtsc;
@@ -183,6 +196,9 @@ void apuInitBufs()
 	apu.lengthLookupTbl = lengthLookupTbl;
 	apu.triSeq = triSeq;
 	apu.ampVol = APU_ampVol;
+	apu.outStride = 1;
+	apu.outStrideCtr = 0;
+	apu.outMute = false;
 	//effective frequencies for 50.000Hz and 60.000Hz Video out
 	//apu.Frequency = nesPAL ? 831187 : 893415;
 	//effective frequencies for Original PPU Video out
@@ -245,6 +261,7 @@ void apuInit()
 	memset(apu.reg,0,0x18);
 	memset(apu.OutBuf, 0, apu.BufSizeBytes);
 	apu.curBufPos = 0;
+	apu.BufFlushes++;
 
 	apu.freq1 = 0; apu.freq2 = 0; apu.triFreq = 0; apu.noiseFreq = apu.noisePeriod[0]-1, apu.dmcFreq = apu.dmcPeriod[0]-1;
 	apu.noiseShiftReg = 1;
@@ -288,6 +305,13 @@ void apuInit()
 
 	apu.p1seq = pulseSeqs[0];
 	apu.p2seq = pulseSeqs[1];
+
+	uint8_t group = stateSetGroup(STATE_GROUP_APU);
+	stateAdd(&apu, (uint8_t*)&apu.BufSize - (uint8_t*)&apu);
+	stateNoHashVar(apu.ampVol);
+	stateNoHash(&apu.dmcPeriod, (uint8_t*)(&apu.mode5Ctr+1) - (uint8_t*)&apu.dmcPeriod);
+	stateNoHash(&apu.p1seq, (uint8_t*)(&apu.triSeq+1) - (uint8_t*)&apu.p1seq);
+	stateSetGroup(group);
 }
 void apuWriteDMCBuf(uint8_t val)
 {
@@ -444,7 +468,9 @@ void apuClockB()
 void apuCycle()
 {
 	uint8_t aExp = audioExpansion;
-	if(!(apu.apuClock&7))
+	if(aExp)
+		STATS_INC(STATS_EXP_AUDIO);
+	if(!(apu.apuClock&7) && !apuSkipOutput)
 	{
 		if(apu.p1LengthCtr && (apu.reg[0x15] & P1_ENABLE))
 		{
@@ -564,7 +590,13 @@ void apuCycle()
 		apu.OutBuf[apu.curBufPos] = (curOut > 32767)?(32767):((curOut < -32768)?(-32768):curOut);
 #endif
 		apu.OutBuf[apu.curBufPos+1] = apu.OutBuf[apu.curBufPos];
-		apu.curBufPos+=2;
+		//in fast-forward only every nth sample is kept,
+		//a stride of 0 keeps overwriting the first one
+		if(apu.outStride && ++apu.outStrideCtr >= apu.outStride)
+		{
+			apu.outStrideCtr = 0;
+			apu.curBufPos+=2;
+		}
 	}
 	apu.apuClock++;
 
@@ -644,6 +676,7 @@ void apuCycle()
 	{
 		if(apu.vrc7Clock == vrc7CycleTimer)
 		{
+			STATS_INC(STATS_VRC7_AUDIO);
 			vrc7AudioCycle();
 			apu.vrc7Clock = 1;
 		}
@@ -713,8 +746,6 @@ void apuCycle()
 	}
 }
 
-extern bool emuSkipVsync, emuSkipFrame;
-
 void apuSet8(uint8_t reg, uint8_t val)
 {
 	//printf("%02x %02x %04x\n", reg, val, cpuGetPc());
@@ -917,35 +948,43 @@ uint32_t apuGetBufSize()
 #endif
 }
 
+uint32_t apuGetBufFlushes()
+{
+	return apu.BufFlushes;
+}
+
+uint32_t apuGetMaxBufSize()
+{
+	return apu.BufSizeBytes;
+}
+
 uint32_t apuGetFrequency()
 {
 	return apu.Frequency;
 }
 
-bool apuUpdate()
+//speed 1 is normal output, n keeps every nth sample so
+//audio stays in sync at n times speed, 0 drops all output
+void apuSetTurbo(uint8_t speed, bool mute)
+{
+	apu.outStride = speed;
+	apu.outStrideCtr = 0;
+	apu.outMute = mute;
+	apuDiscardBuf();
+}
+
+//starts the buffer over without handing the samples to audio
+void apuDiscardBuf()
+{
+	apu.curBufPos = 0;
+	apu.BufFlushes++;
+}
+
+void apuUpdate()
 {
-#ifdef __LIBRETRO__
+	if(apu.outMute)
+		memset(apu.OutBuf, 0, apuGetBufSize());
 	audioUpdate();
-#else
-	int updateRes = audioUpdate();
-	//printf("%i\n",updateRes);
-	if(updateRes == 0)
-	{
-		emuSkipFrame = false;
-		apu.waitForRefill = false;
-		return false;
-	}
-	if(apu.waitForRefill && updateRes < 2)
-	{
-		apu.waitForRefill = false;
-		emuSkipFrame = false;
-	}
-	else if(!apu.waitForRefill && updateRes > 2)
-	{
-		emuSkipFrame = true;
-		apu.waitForRefill = true;
-	}
-#endif
 	apu.curBufPos = 0;
-	return true;
+	apu.BufFlushes++;
 }
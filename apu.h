@@ -24,10 +24,14 @@ void apuCycle();
 void apuWriteDMCBuf(uint8_t val);
 uint8_t *apuGetBuf();
 uint32_t apuGetBufSize();
+uint32_t apuGetBufFlushes();
+uint32_t apuGetMaxBufSize();
 uint32_t apuGetFrequency();
 void apuSet8(uint8_t reg, uint8_t val);
 uint8_t apuGet8(uint8_t reg);
-bool apuUpdate();
+void apuUpdate();
+void apuDiscardBuf();
+void apuSetTurbo(uint8_t speed, bool mute);
 
 typedef struct _envelope_t {
 	bool start;
@@ -52,4 +56,6 @@ typedef struct _sweep_t {
 
 void doEnvelopeLogic(envelope_t *env);
 
+extern bool apuSkipOutput;
+
 #endif
@@ -1,10 +1,45 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
 
 #ifndef _audio_h_
 #define _audio_h_
 
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+typedef struct _audioSink_t {
+	const char *name;
+	//arg is whatever followed "name:" when selecting the sink
+	bool (*init)(const char *arg);
+	//data holds size bytes of interleaved stereo samples
+	//at apuGetFrequency(), returns 0 if any got dropped
+	int (*update)(const uint8_t *data, uint32_t size);
+	void (*deinit)();
+} audioSink_t;
+
+extern const audioSink_t audioSinkOpenAL;
+extern const audioSink_t audioSinkNull;
+extern const audioSink_t audioSinkWav;
+extern const audioSink_t audioSinkRaw;
+
+bool audioSelectSink(const char *spec);
+void audioSetSink(const audioSink_t *sink, const char *arg);
+void audioListSinks();
 int audioInit();
 int audioUpdate();
 void audioDeinit();
-void audioSleep();
+
+//openal sink queue setup
+void audioSetLatency(int numBuffers, int periodMs);
+unsigned audioGetUnderruns();
+unsigned audioGetQueuedMs();
+
+//44 byte header for the apu output format
+void audioWriteWavHeader(FILE *f, uint32_t dataSize);
 
 #endif
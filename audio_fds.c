@@ -15,6 +15,7 @@
 #include "audio.h"
 #include "mem.h"
 #include "cpu.h"
+#include "state.h"
 
 //used externally
 extern uint8_t audioExpansion;
@@ -74,6 +75,8 @@ void fdsAudioInit()
 	fds_apu.sweepEnabled = false;
 	fds_apu.modEnabled = false;
 	fds_apu.wavWrite = false;
+	stateAddVar(fds_apu);
+	stateAddVar(fdsOut);
 }
 
 FIXNES_NOINLINE void fdsAudioCycle()
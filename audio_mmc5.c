@@ -15,6 +15,7 @@
 #include "audio.h"
 #include "mem.h"
 #include "cpu.h"
+#include "state.h"
 
 //used externally
 extern uint8_t audioExpansion;
@@ -47,6 +48,7 @@ static struct {
 	bool p1haltloop, p2haltloop;
 	bool dmcirqenable;
 } mmc5_apu;
+static uint8_t mmc5_p1Out = 0, mmc5_p2Out = 0;
 
 //from apu.c
 extern const uint8_t lengthLookupTbl[0x20];
@@ -88,6 +90,15 @@ void mmc5AudioInit()
 	mmc5_apu.p1haltloop = false; mmc5_apu.p2haltloop = false;
 	mmc5_apu.dmcirqenable = false;
 	mmc5_dmcreadmode = false;
+	stateAddVar(mmc5_apu);
+	stateNoHashVar(mmc5_apu.mode4Ctr);
+	stateNoHashVar(mmc5_apu.p1seq);
+	stateNoHashVar(mmc5_apu.p2seq);
+	stateAddVar(mmc5Out);
+	stateAddVar(mmc5pcm);
+	stateAddVar(mmc5_dmcreadmode);
+	stateAddVar(mmc5_p1Out);
+	stateAddVar(mmc5_p2Out);
 }
 
 void mmc5AudioClockTimers()
@@ -120,8 +131,6 @@ void mmc5AudioPCMWrite(uint8_t val)
 	mmc5pcm = val;
 }
 
-static uint8_t mmc5_p1Out = 0, mmc5_p2Out = 0;
-
 FIXNES_NOINLINE void mmc5AudioCycle()
 {
 	if(mmc5_apu.p1LengthCtr && (mmc5_apu.reg[0x15] & P1_ENABLE))
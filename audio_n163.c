@@ -15,6 +15,7 @@
 #include "mem.h"
 #include "cpu.h"
 #include "apu.h"
+#include "state.h"
 
 //used externally
 extern uint8_t audioExpansion;
@@ -38,6 +39,13 @@ void n163AudioInit()
 	n163Ctr = 15;
 	n163_addrInc = false;
 	//printf("n163 Audio Inited!\n");
+	stateAddVar(n163Out);
+	stateAddVar(n163cOut);
+	stateAddVar(n163Buf);
+	stateAddVar(n163CurChan);
+	stateAddVar(n163CurAddr);
+	stateAddVar(n163Ctr);
+	stateAddVar(n163_addrInc);
 }
 
 //helper function to get current 4-bit sample
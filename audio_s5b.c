@@ -16,6 +16,7 @@
 #include "mem.h"
 #include "cpu.h"
 #include "apu.h"
+#include "state.h"
 
 //repeat values for all 16 shapes
 static const bool s5b_envRepeatTbl[16] = { 
@@ -118,6 +119,9 @@ void s5BAudioInit()
 		s5b_apu.envShapeTbl[0x8][i+32] = s5b_apu.envShapeTbl[0xE][i+32] = 31-i;
 		s5b_apu.envShapeTbl[0xA][i+32] = s5b_apu.envShapeTbl[0xC][i+32] = i;
 	}
+	stateAddVar(s5b_apu);
+	stateNoHashVar(s5b_apu.envRepeatTbl);
+	stateAddVar(s5BOut);
 }
 
 void s5BAudioClockTimers()
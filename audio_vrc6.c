@@ -14,6 +14,7 @@
 #include "mem.h"
 #include "cpu.h"
 #include "apu.h"
+#include "state.h"
 
 //used externally
 extern uint8_t audioExpansion;
@@ -47,6 +48,8 @@ void vrc6AudioInit()
 	vrc6_apu.p1enable = false, vrc6_apu.p2enable = false, vrc6_apu.sawenable = false;
 	vrc6_apu.halt = false;
 	//printf("VRC6 Audio Inited!\n");
+	stateAddVar(vrc6_apu);
+	stateAddVar(vrc6Out);
 }
 
 FIXNES_NOINLINE void vrc6AudioCycle()
@@ -16,6 +16,7 @@
 #include "mem.h"
 #include "cpu.h"
 #include "apu.h"
+#include "state.h"
 
 //used externally
 extern uint8_t audioExpansion;
@@ -180,6 +181,9 @@ void vrc7AudioInit()
 	// Fm Lut
 	for(i = 0; i < 256; ++i)
 		vrc7_apu.fmLut[i] = pow(2.0, 13.75 / 1200 * sin(M_2PI * i / 256));
+	stateAddVar(vrc7_apu);
+	stateNoHashVar(vrc7_apu.multi);
+	stateAddVar(vrc7Out);
 }
 
 void vrc7SetR(vrc7Ksr_t *k, int32_t r)
@@ -0,0 +1,370 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include <math.h>
+#include "apu.h"
+#include "audio_fds.h"
+#include "audio_mmc5.h"
+#include "audio_n163.h"
+#include "audio_s5b.h"
+#include "audio_vrc6.h"
+#include "audio_vrc7.h"
+#include "cpu.h"
+#include "input.h"
+#include "mapper.h"
+#include "mem.h"
+#include "pacer.h"
+#include "ppu.h"
+#include "state.h"
+#include "bench.h"
+
+/*
+ * Drives the cpu, ppu and apu on their own with made up work instead
+ * of a game, so a change to one of them can be measured without the
+ * rest of the machine in the numbers. Every case runs a number of
+ * times on a fresh NROM machine and reports the mean host time per
+ * emulated cpu cycle with a 95% confidence interval over those runs.
+ */
+
+#define BENCH_CYCLES 300000
+#define BENCH_MAX_RUNS 64
+//cpu cycles in one ntsc frame, audio gets thrown away after each
+#define BENCH_FRAME_CYCLES 29781
+#define BENCH_REPEAT 32
+
+extern bool nesPAL;
+extern uint32_t cpuCycleTimer;
+extern uint32_t vrc7CycleTimer;
+extern uint8_t audioExpansion;
+
+//two sided 95% student t for 1 to 30 degrees of freedom
+static const double benchT95[31] = { 0.0,
+	12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+	2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+	2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+};
+
+static uint8_t benchPRG[0x8000];
+static uint8_t benchCHR[0x2000];
+static uint8_t benchPrgRAM[0x2000];
+static uint8_t benchApuMask;
+
+typedef struct _benchCpuCase_t {
+	const char *name;
+	uint8_t len;
+	uint8_t op[5];
+} benchCpuCase_t;
+
+//the body gets repeated BENCH_REPEAT times inside the loop, X is 4
+//and Y is $10 so the indexed ones below cross a page, ($20) is $0300
+static const benchCpuCase_t benchCpuCases[] = {
+	{ "implied",      1, { 0xE8 } },                   //inx
+	{ "immediate",    2, { 0xA9, 0x55 } },             //lda #$55
+	{ "zeropage",     2, { 0xA5, 0x10 } },             //lda $10
+	{ "zeropage,x",   2, { 0xB5, 0x10 } },             //lda $10,x
+	{ "absolute",     3, { 0xAD, 0x00, 0x03 } },       //lda $0300
+	{ "absolute,x",   3, { 0xBD, 0xFE, 0x03 } },       //lda $03FE,x
+	{ "absolute,y",   3, { 0xB9, 0xF8, 0x03 } },       //lda $03F8,y
+	{ "(indirect,x)", 2, { 0xA1, 0x1C } },             //lda ($1C,x)
+	{ "(indirect),y", 2, { 0xB1, 0x20 } },             //lda ($20),y
+	{ "store",        3, { 0x8D, 0x00, 0x03 } },       //sta $0300
+	{ "rmw",          3, { 0xEE, 0x00, 0x03 } },       //inc $0300
+	{ "branch",       2, { 0xD0, 0x00 } },             //bne to the next one
+	{ "stack",        2, { 0x48, 0x68 } },             //pha, pla
+	{ "jsr/rts",      3, { 0x20, 0x00, 0xF0 } },       //jsr $F000, which is rts
+	{ "oam dma",      5, { 0xA9, 0x02, 0x8D, 0x14, 0x40 } }, //lda #2, sta $4014
+};
+
+static const char *benchPpuScenes[] = {
+	"rendering off", "background", "8x8 sprites", "8x16 sprites",
+};
+
+static const char *benchApuNames[] = {
+	"2a03", "vrc6", "vrc7", "fds", "mmc5", "n163", "s5b",
+};
+
+//nrom with everything pointing at the given loop, jumping back forever
+static void benchMachine(const uint8_t *body, uint8_t len)
+{
+	static const uint8_t setup[] = {
+		0x78, 0xA2, 0x04, 0xA0, 0x10, //sei, ldx #4, ldy #$10
+		0xA9, 0x00, 0x85, 0x20, 0xA9, 0x03, 0x85, 0x21, //($20) = $0300
+	};
+	uint16_t pos = sizeof(setup), i;
+	memset(benchPRG, 0xEA, sizeof(benchPRG));
+	memcpy(benchPRG, setup, sizeof(setup));
+	for(i = 0; i < BENCH_REPEAT; i++, pos += len)
+		memcpy(benchPRG+pos, body, len);
+	benchPRG[pos] = 0x4C; //jmp back to the repeated part
+	benchPRG[pos+1] = sizeof(setup);
+	benchPRG[pos+2] = 0x80;
+	benchPRG[0x7000] = 0x60; //rts
+	for(i = 0x7FFA; i < 0x8000; i += 2)
+	{
+		benchPRG[i] = 0x00;
+		benchPRG[i+1] = 0x80;
+	}
+	//tile 1 solid, the others some pattern
+	for(i = 0; i < sizeof(benchCHR); i++)
+		benchCHR[i] = (i>>4) == 1 ? 0xFF : (uint8_t)(i*0x3B + (i>>4));
+	memset(benchPrgRAM, 0, sizeof(benchPrgRAM));
+	nesPAL = false;
+	cpuCycleTimer = 12;
+	vrc7CycleTimer = 432 / cpuCycleTimer;
+	stateClear();
+	cpuInit();
+	ppuInit();
+	memInit();
+	apuInit();
+	inputInit();
+	ppuSetNameTblVertical();
+	audioExpansion = 0;
+	mapperInit(0, benchPRG, sizeof(benchPRG), benchPrgRAM, sizeof(benchPrgRAM), benchCHR, sizeof(benchCHR));
+}
+
+static void benchRunCpu(uint32_t cycles)
+{
+	while(cycles--)
+		cpuCycle();
+}
+
+static void benchRunPpu(uint32_t cycles)
+{
+	while(cycles--)
+		ppuCycle();
+}
+
+//same per cycle work as nsf playback does for the expansions
+static void benchRunApu(uint32_t cycles)
+{
+	uint8_t mask = benchApuMask;
+	uint32_t frame = 0;
+	while(cycles--)
+	{
+		apuCycle();
+		if(mask&EXP_VRC6)
+			vrc6AudioClockTimers();
+		if(mask&EXP_FDS)
+			fdsAudioClockTimers();
+		if(mask&EXP_MMC5)
+			mmc5AudioClockTimers();
+		if(mask&EXP_N163)
+			n163AudioClockTimers();
+		if(mask&EXP_S5B)
+			s5BAudioClockTimers();
+		//nobody listens, just make room
+		if(++frame == BENCH_FRAME_CYCLES)
+		{
+			apuDiscardBuf();
+			frame = 0;
+		}
+	}
+}
+
+static void benchMeasure(const char *name, void (*run)(uint32_t), uint8_t runs)
+{
+	double ns[BENCH_MAX_RUNS], mean = 0.0, var = 0.0, min = 0.0;
+	uint8_t i;
+	//caches and branch predictors warm first
+	run(BENCH_CYCLES/4);
+	for(i = 0; i < runs; i++)
+	{
+		uint64_t start = pacerNow();
+		run(BENCH_CYCLES);
+		ns[i] = (double)(pacerNow()-start)/BENCH_CYCLES;
+		mean += ns[i];
+		if(i == 0 || ns[i] < min)
+			min = ns[i];
+	}
+	mean /= runs;
+	for(i = 0; i < runs; i++)
+		var += (ns[i]-mean)*(ns[i]-mean);
+	var /= (runs-1);
+	double t = (runs-1 <= 30) ? benchT95[runs-1] : 1.960;
+	printf("%-16s %9.2f +-%6.2f ns  (min %.2f)\n", name, mean, t*sqrt(var/runs), min);
+}
+
+static void benchCpu(uint8_t runs)
+{
+	uint8_t i;
+	printf("Bench: cpuCycle, ns per cpu cycle\n");
+	for(i = 0; i < sizeof(benchCpuCases)/sizeof(benchCpuCases[0]); i++)
+	{
+		benchMachine(benchCpuCases[i].op, benchCpuCases[i].len);
+		benchMeasure(benchCpuCases[i].name, benchRunCpu, runs);
+	}
+}
+
+static void benchPpuScene(uint8_t scene)
+{
+	uint16_t i;
+	uint8_t *oam = ppuGetOAM();
+	ppuSet8(1, 0);
+	ppuSet8(0, scene == 3 ? 0x20 : 0x00);
+	//some palette, nametable and attributes
+	ppuGet8(2);
+	ppuSet8(6, 0x3F);
+	ppuSet8(6, 0x00);
+	for(i = 0; i < 0x20; i++)
+		ppuSet8(7, (i*7)&0x3F);
+	ppuSet8(6, 0x20);
+	ppuSet8(6, 0x00);
+	for(i = 0; i < 0x400; i++)
+		ppuSet8(7, i < 0x3C0 ? (uint8_t)(i*5) : 0xE4);
+	ppuSet8(6, 0x00);
+	ppuSet8(6, 0x00);
+	ppuSet8(5, 0);
+	ppuSet8(5, 0);
+	//eight bands of eight sprites side by side
+	memset(oam, 0xFF, PPU_OAM_SIZE);
+	if(scene >= 2)
+	{
+		for(i = 0; i < 64; i++)
+		{
+			oam[i*4] = (i/8)*28;
+			oam[i*4+1] = scene == 3 ? 0x02 : 0x01;
+			oam[i*4+2] = i&3;
+			oam[i*4+3] = (i%8)*32;
+		}
+	}
+	if(scene == 1)
+		ppuSet8(1, 0x0A);
+	else if(scene >= 2)
+		ppuSet8(1, 0x1E);
+}
+
+static void benchPpu(uint8_t runs)
+{
+	static const uint8_t idle[1] = { 0xEA };
+	uint8_t i;
+	printf("Bench: ppuCycle, ns per cpu cycle (3 dots)\n");
+	for(i = 0; i < sizeof(benchPpuScenes)/sizeof(benchPpuScenes[0]); i++)
+	{
+		benchMachine(idle, sizeof(idle));
+		benchPpuScene(i);
+		benchMeasure(benchPpuScenes[i], benchRunPpu, runs);
+	}
+}
+
+//a tone on every channel the expansion has
+static void benchApuSetup(uint8_t mask)
+{
+	uint8_t i;
+	apuSet8(0x15, 0x0F);
+	apuSet8(0x00, 0xBF); apuSet8(0x02, 0xFD); apuSet8(0x03, 0x08);
+	apuSet8(0x04, 0x7F); apuSet8(0x06, 0x80); apuSet8(0x07, 0x08);
+	apuSet8(0x08, 0xFF); apuSet8(0x0A, 0x40); apuSet8(0x0B, 0x08);
+	apuSet8(0x0C, 0x3F); apuSet8(0x0E, 0x05); apuSet8(0x0F, 0x08);
+	if(mask&EXP_VRC6)
+	{
+		vrc6AudioInit();
+		vrc6AudioSet8(0x9000, 0x3F); vrc6AudioSet8(0x9001, 0x80); vrc6AudioSet8(0x9002, 0x81);
+		vrc6AudioSet8(0xA000, 0x5F); vrc6AudioSet8(0xA001, 0x40); vrc6AudioSet8(0xA002, 0x81);
+		vrc6AudioSet8(0xB000, 0x20); vrc6AudioSet8(0xB001, 0x00); vrc6AudioSet8(0xB002, 0x82);
+	}
+	if(mask&EXP_VRC7)
+	{
+		vrc7AudioInit();
+		for(i = 0; i < 6; i++)
+		{
+			vrc7AudioSet8(0x10+i, 0x80+i*0x10);
+			vrc7AudioSet8(0x30+i, (i+1)<<4);
+			vrc7AudioSet8(0x20+i, 0x18);
+		}
+	}
+	if(mask&EXP_FDS)
+	{
+		fdsAudioInit();
+		fdsAudioSet8(0x09, 0x80);
+		for(i = 0; i < 64; i++)
+			fdsAudioSetWave(i, i < 32 ? i*2 : (63-i)*2);
+		fdsAudioSet8(0x09, 0x00);
+		fdsAudioSet8(0x00, 0xA0);
+		fdsAudioSet8(0x02, 0x00);
+		fdsAudioSet8(0x03, 0x02);
+	}
+	if(mask&EXP_MMC5)
+	{
+		mmc5AudioInit();
+		mmc5AudioSet8(0x15, 0x03);
+		mmc5AudioSet8(0x00, 0xBF); mmc5AudioSet8(0x02, 0xFD); mmc5AudioSet8(0x03, 0x08);
+		mmc5AudioSet8(0x04, 0x7F); mmc5AudioSet8(0x06, 0x80); mmc5AudioSet8(0x07, 0x08);
+	}
+	if(mask&EXP_N163)
+	{
+		n163AudioInit();
+		//a 32 sample wave and all 8 channels playing it
+		n163AudioSet8(0xF800, 0x80);
+		for(i = 0; i < 16; i++)
+			n163AudioSet8(0x4800, 0x98);
+		for(i = 0; i < 8; i++)
+		{
+			n163AudioSet8(0xF800, 0x80|(0x40+i*8));
+			n163AudioSet8(0x4800, 0x00); n163AudioSet8(0x4800, 0x00);
+			n163AudioSet8(0x4800, 0x20+i); n163AudioSet8(0x4800, 0x00);
+			n163AudioSet8(0x4800, 0xE0); n163AudioSet8(0x4800, 0x00);
+			n163AudioSet8(0x4800, 0x00); n163AudioSet8(0x4800, i == 7 ? 0x7F : 0x0F);
+		}
+	}
+	if(mask&EXP_S5B)
+	{
+		s5BAudioInit();
+		for(i = 0; i < 3; i++)
+		{
+			s5BAudioSet8(0xC000, i*2); s5BAudioSet8(0xE000, 0x80+i*0x20);
+			s5BAudioSet8(0xC000, i*2+1); s5BAudioSet8(0xE000, 0x00);
+			s5BAudioSet8(0xC000, 8+i); s5BAudioSet8(0xE000, 0x0F);
+		}
+		s5BAudioSet8(0xC000, 7); s5BAudioSet8(0xE000, 0x38);
+	}
+	audioExpansion = mask;
+	benchApuMask = mask;
+}
+
+static void benchApu(uint8_t runs)
+{
+	static const uint8_t idle[1] = { 0xEA };
+	static const uint8_t masks[] = { 0, EXP_VRC6, EXP_VRC7, EXP_FDS, EXP_MMC5, EXP_N163, EXP_S5B };
+	uint8_t i;
+	printf("Bench: apuCycle, ns per cpu cycle\n");
+	for(i = 0; i < sizeof(masks); i++)
+	{
+		benchMachine(idle, sizeof(idle));
+		benchApuSetup(masks[i]);
+		benchMeasure(benchApuNames[i], benchRunApu, runs);
+	}
+}
+
+bool benchRun(const char *part, int runs)
+{
+	bool all = (strcmp(part, "all") == 0);
+	if(!all && strcmp(part, "cpu") != 0 && strcmp(part, "ppu") != 0 && strcmp(part, "apu") != 0)
+	{
+		printf("Bench: Unknown part %s, use cpu, ppu, apu or all\n", part);
+		return false;
+	}
+	if(runs < 2)
+		runs = 2;
+	if(runs > BENCH_MAX_RUNS)
+		runs = BENCH_MAX_RUNS;
+	pacerInit(60.0);
+	apuInitBufs();
+	printf("Bench: %i runs of %u cycles per case\n", runs, BENCH_CYCLES);
+	if(all || strcmp(part, "cpu") == 0)
+		benchCpu(runs);
+	if(all || strcmp(part, "ppu") == 0)
+		benchPpu(runs);
+	if(all || strcmp(part, "apu") == 0)
+		benchApu(runs);
+	apuDeinitBufs();
+	pacerDeinit();
+	return true;
+}
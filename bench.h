@@ -5,12 +5,9 @@
  * of the MIT license.  See the LICENSE file for details.
  */
 
-#ifndef _fm2play_h_
-#define _fm2play_h_
+#ifndef _bench_h_
+#define _bench_h_
 
-bool fm2playInit(char *fName, int fstart, bool wait);
-void fm2playUpdate();
-bool fm2playRunning();
-bool fm2playWaitDMAcycles();
+bool benchRun(const char *part, int runs);
 
 #endif
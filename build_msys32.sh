@@ -1,2 +1,2 @@
 #!/bin/sh
-gcc -DWINDOWS_BUILD -DZIPSUPPORT main.c apu.c audio.c audio_fds.c audio_mmc5.c audio_vrc6.c audio_vrc7.c audio_n163.c audio_s5b.c alhelpers.c cpu.c ppu.c mem.c input.c mapper.c mapperList.c fm2play.c vrc_irq.c mapper/*.c unzip/*.c -DFREEGLUT_STATIC -lfreeglut_static -lopenal32 -lopengl32 -lglu32 -lgdi32 -lwinmm -lz -Wall -Wextra -O3 -flto -s -o fixNES
\ No newline at end of file
+gcc -DWINDOWS_BUILD -DZIPSUPPORT main.c apu.c audio.c sink_openal.c sink_file.c ring.c pacer.c capture.c telemetry.c testrom.c bench.c cheat.c dbg.c trace.c prof.c stats.c hash.c rominfo.c gamedb.c romindex.c audio_fds.c audio_mmc5.c audio_vrc6.c audio_vrc7.c audio_n163.c audio_s5b.c alhelpers.c cpu.c ppu.c mem.c input.c mapper.c mapperList.c movie.c rewind.c state.c vrc_irq.c mapper/*.c unzip/*.c -DFREEGLUT_STATIC -lfreeglut_static -lopenal32 -lopengl32 -lglu32 -lgdi32 -lwinmm -lpthread -lz -Wall -Wextra -O3 -flto -s -o fixNES
\ No newline at end of file
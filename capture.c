@@ -0,0 +1,266 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include <pthread.h>
+#include "apu.h"
+#include "audio.h"
+#include "capture.h"
+
+#if WINDOWS_BUILD
+#define popen _popen
+#define pclose _pclose
+#endif
+
+#define CAPTURE_WIDTH 256
+#define CAPTURE_HEIGHT 240
+//frames the writer may fall behind before emulation waits on it
+#define CAPTURE_SLOTS 8
+
+typedef struct _captureSlot_t {
+	uint16_t img[CAPTURE_WIDTH*CAPTURE_HEIGHT];
+	uint8_t *audio;
+	uint32_t audioSize;
+} captureSlot_t;
+
+static captureSlot_t *captureSlots = NULL;
+static uint32_t captureAudioMax;
+//filled slots are captureTail up to captureHead
+static uint32_t captureHead, captureTail;
+static pthread_mutex_t captureMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t captureFilled = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t captureFreed = PTHREAD_COND_INITIALIZER;
+static pthread_t captureThread;
+static bool captureActive = false;
+static bool captureStopping;
+
+static FILE *captureVideo;
+static bool captureVideoPipe;
+static FILE *captureAudio;
+static uint32_t captureAudioSize;
+static int captureFormat;
+static uint8_t *captureOut;
+
+static inline void captureRGB(uint16_t px, int *r, int *g, int *b)
+{
+	*r = (px>>11)&0x1F; *r = (*r<<3)|(*r>>2);
+	*g = (px>>5)&0x3F; *g = (*g<<2)|(*g>>4);
+	*b = px&0x1F; *b = (*b<<3)|(*b>>2);
+}
+
+//BT.601 limited range 4:4:4, chroma keeps the full resolution but
+//the yuv rounding is not exact, only raw rgb keeps the pixels as is
+static void captureWriteY4M(const uint16_t *img)
+{
+	uint8_t *outY = captureOut;
+	uint8_t *outU = outY + CAPTURE_WIDTH*CAPTURE_HEIGHT;
+	uint8_t *outV = outU + CAPTURE_WIDTH*CAPTURE_HEIGHT;
+	int i;
+	for(i = 0; i < CAPTURE_WIDTH*CAPTURE_HEIGHT; i++)
+	{
+		int r, g, b;
+		captureRGB(img[i], &r, &g, &b);
+		outY[i] = 16 + ((66*r + 129*g + 25*b + 128)>>8);
+		outU[i] = 128 + ((-38*r - 74*g + 112*b + 128)>>8);
+		outV[i] = 128 + ((112*r - 94*g - 18*b + 128)>>8);
+	}
+	fputs("FRAME\n", captureVideo);
+	fwrite(captureOut, 1, CAPTURE_WIDTH*CAPTURE_HEIGHT*3, captureVideo);
+}
+
+static void captureWriteRGB(const uint16_t *img)
+{
+	int i;
+	for(i = 0; i < CAPTURE_WIDTH*CAPTURE_HEIGHT; i++)
+	{
+		int r, g, b;
+		captureRGB(img[i], &r, &g, &b);
+		captureOut[i*3] = r;
+		captureOut[i*3+1] = g;
+		captureOut[i*3+2] = b;
+	}
+	fwrite(captureOut, 1, CAPTURE_WIDTH*CAPTURE_HEIGHT*3, captureVideo);
+}
+
+//converts and writes out frames in the order they got queued
+static void *captureWriter(void *arg)
+{
+	(void)arg;
+	while(1)
+	{
+		pthread_mutex_lock(&captureMutex);
+		while(captureHead == captureTail && !captureStopping)
+			pthread_cond_wait(&captureFilled, &captureMutex);
+		if(captureHead == captureTail)
+		{
+			pthread_mutex_unlock(&captureMutex);
+			break;
+		}
+		captureSlot_t *slot = &captureSlots[captureTail % CAPTURE_SLOTS];
+		pthread_mutex_unlock(&captureMutex);
+
+		if(captureFormat == CAPTURE_Y4M)
+			captureWriteY4M(slot->img);
+		else
+			captureWriteRGB(slot->img);
+		if(captureAudio && slot->audioSize)
+		{
+			fwrite(slot->audio, 1, slot->audioSize, captureAudio);
+			captureAudioSize += slot->audioSize;
+		}
+
+		pthread_mutex_lock(&captureMutex);
+		captureTail++;
+		pthread_cond_signal(&captureFreed);
+		pthread_mutex_unlock(&captureMutex);
+	}
+	return NULL;
+}
+
+static void captureClose()
+{
+	if(captureVideo)
+	{
+		if(captureVideoPipe)
+			pclose(captureVideo);
+		else
+			fclose(captureVideo);
+	}
+	captureVideo = NULL;
+	if(captureAudio)
+	{
+		rewind(captureAudio);
+		audioWriteWavHeader(captureAudio, captureAudioSize);
+		fclose(captureAudio);
+	}
+	captureAudio = NULL;
+	if(captureSlots)
+	{
+		int i;
+		for(i = 0; i < CAPTURE_SLOTS; i++)
+			free(captureSlots[i].audio);
+		free(captureSlots);
+	}
+	captureSlots = NULL;
+	if(captureOut)
+		free(captureOut);
+	captureOut = NULL;
+}
+
+//a path starting with | gets piped into that command instead
+bool captureStart(const char *path, const char *audioPath, int format, bool pal)
+{
+	int i;
+	if(captureActive)
+		return false;
+	captureFormat = format;
+	captureVideoPipe = (path[0] == '|');
+	if(captureVideoPipe)
+		captureVideo = popen(path+1, "w");
+	else
+		captureVideo = fopen(path, "wb");
+	if(!captureVideo)
+	{
+		printf("Capture: Could not open %s\n", path);
+		return false;
+	}
+	captureAudioSize = 0;
+	if(audioPath)
+	{
+		captureAudio = fopen(audioPath, "wb");
+		if(!captureAudio)
+		{
+			printf("Capture: Could not open %s\n", audioPath);
+			captureClose();
+			return false;
+		}
+		//filled in on stop
+		audioWriteWavHeader(captureAudio, 0);
+	}
+	captureAudioMax = apuGetMaxBufSize();
+	captureSlots = calloc(CAPTURE_SLOTS, sizeof(captureSlot_t));
+	captureOut = malloc(CAPTURE_WIDTH*CAPTURE_HEIGHT*3);
+	if(!captureSlots || !captureOut)
+	{
+		captureClose();
+		return false;
+	}
+	for(i = 0; i < CAPTURE_SLOTS; i++)
+	{
+		captureSlots[i].audio = malloc(captureAudioMax);
+		if(!captureSlots[i].audio)
+		{
+			captureClose();
+			return false;
+		}
+	}
+	if(format == CAPTURE_Y4M)
+	{
+		//exact NES frame rates
+		if(pal)
+			fprintf(captureVideo, "YUV4MPEG2 W%i H%i F3325214:66495 Ip A1:1 C444\n", CAPTURE_WIDTH, CAPTURE_HEIGHT);
+		else
+			fprintf(captureVideo, "YUV4MPEG2 W%i H%i F39375000:655171 Ip A1:1 C444\n", CAPTURE_WIDTH, CAPTURE_HEIGHT);
+	}
+	captureHead = 0;
+	captureTail = 0;
+	captureStopping = false;
+	if(pthread_create(&captureThread, NULL, captureWriter, NULL) != 0)
+	{
+		captureClose();
+		return false;
+	}
+	captureActive = true;
+	printf("Capture: Writing %s%s%s\n", path, audioPath ? " and " : "", audioPath ? audioPath : "");
+	return true;
+}
+
+void captureFrame(const uint16_t *img, const uint8_t *audio, uint32_t audioSize)
+{
+	if(!captureActive)
+		return;
+	pthread_mutex_lock(&captureMutex);
+	//never drop frames, so if the writer is behind wait for it
+	while(captureHead - captureTail >= CAPTURE_SLOTS)
+		pthread_cond_wait(&captureFreed, &captureMutex);
+	captureSlot_t *slot = &captureSlots[captureHead % CAPTURE_SLOTS];
+	pthread_mutex_unlock(&captureMutex);
+
+	memcpy(slot->img, img, sizeof(slot->img));
+	if(audioSize > captureAudioMax)
+		audioSize = captureAudioMax;
+	memcpy(slot->audio, audio, audioSize);
+	slot->audioSize = audioSize;
+
+	pthread_mutex_lock(&captureMutex);
+	captureHead++;
+	pthread_cond_signal(&captureFilled);
+	pthread_mutex_unlock(&captureMutex);
+}
+
+void captureStop()
+{
+	if(!captureActive)
+		return;
+	pthread_mutex_lock(&captureMutex);
+	captureStopping = true;
+	pthread_cond_signal(&captureFilled);
+	pthread_mutex_unlock(&captureMutex);
+	pthread_join(captureThread, NULL);
+	captureClose();
+	captureActive = false;
+	printf("Capture: Stopped\n");
+}
+
+bool captureRunning()
+{
+	return captureActive;
+}
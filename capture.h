@@ -0,0 +1,21 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#ifndef _capture_h_
+#define _capture_h_
+
+enum {
+	CAPTURE_Y4M = 0,
+	CAPTURE_RGB,
+};
+
+bool captureStart(const char *path, const char *audioPath, int format, bool pal);
+void captureFrame(const uint16_t *img, const uint8_t *audio, uint32_t audioSize);
+void captureStop();
+bool captureRunning();
+
+#endif
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include <ctype.h>
+#include "mapper.h"
+#include "mem.h"
+#include "cheat.h"
+
+/*
+ * Game Genie codes and raw codes from $4020 up replace what the
+ * cpu reads from the cartridge, just like the real Game Genie.
+ * For that the mappers read function gets wrapped while such codes
+ * exist, so without them reads are not touched at all. Raw codes
+ * below $2000 freeze internal ram, written once per frame.
+ */
+#define CHEAT_MAX 64
+
+typedef struct _cheat_t {
+	uint16_t addr;
+	uint8_t val;
+	uint8_t cmp;
+	bool hasCmp;
+} cheat_t;
+
+static cheat_t cheatRead[CHEAT_MAX];
+static uint8_t cheatReadNum = 0;
+//bit per 4k page holding a read cheat
+static uint16_t cheatReadPages = 0;
+static cheat_t cheatRam[CHEAT_MAX];
+static uint8_t cheatRamNum = 0;
+static get8FuncT cheatOrigGet8 = NULL;
+
+static uint8_t cheatGet8(uint16_t addr, uint8_t val)
+{
+	val = cheatOrigGet8(addr, val);
+	if(cheatReadPages & (1<<(addr>>12)))
+	{
+		uint8_t i;
+		for(i = 0; i < cheatReadNum; i++)
+		{
+			if(cheatRead[i].addr == addr && (!cheatRead[i].hasCmp || cheatRead[i].cmp == val))
+				return cheatRead[i].val;
+		}
+	}
+	return val;
+}
+
+static const char cheatGGLetters[] = "APZLGITYEOXUKSVN";
+
+static bool cheatDecodeGG(const char *code, cheat_t *c)
+{
+	uint8_t n[8];
+	size_t len = strlen(code);
+	size_t i;
+	if(len != 6 && len != 8)
+		return false;
+	for(i = 0; i < len; i++)
+	{
+		const char *p = strchr(cheatGGLetters, toupper((unsigned char)code[i]));
+		if(p == NULL)
+			return false;
+		n[i] = p - cheatGGLetters;
+	}
+	c->addr = 0x8000 | ((n[3]&7)<<12) | ((n[5]&7)<<8) | ((n[4]&8)<<8)
+		| ((n[2]&7)<<4) | ((n[1]&8)<<4) | (n[4]&7) | (n[3]&8);
+	c->val = ((n[1]&7)<<4) | ((n[0]&8)<<4) | (n[0]&7);
+	if(len == 6)
+	{
+		c->val |= (n[5]&8);
+		c->hasCmp = false;
+	}
+	else
+	{
+		c->val |= (n[7]&8);
+		c->cmp = ((n[7]&7)<<4) | ((n[6]&8)<<4) | (n[6]&7) | (n[5]&8);
+		c->hasCmp = true;
+	}
+	return true;
+}
+
+//address:value or address:value:compare, all hex
+static bool cheatDecodeRaw(const char *code, cheat_t *c)
+{
+	char *end;
+	unsigned long v = strtoul(code, &end, 16);
+	if(end == code || *end != ':' || v > 0xFFFF)
+		return false;
+	c->addr = v;
+	code = end+1;
+	v = strtoul(code, &end, 16);
+	if(end == code || v > 0xFF)
+		return false;
+	c->val = v;
+	c->hasCmp = false;
+	if(*end == ':')
+	{
+		code = end+1;
+		v = strtoul(code, &end, 16);
+		if(end == code || v > 0xFF)
+			return false;
+		c->cmp = v;
+		c->hasCmp = true;
+	}
+	return (*end == '\0');
+}
+
+bool cheatAdd(const char *code)
+{
+	cheat_t c;
+	bool ok = strchr(code, ':') ? cheatDecodeRaw(code, &c) : cheatDecodeGG(code, &c);
+	if(!ok || (c.addr >= 0x2000 && c.addr < 0x4020))
+	{
+		printf("Cheat: %s is no valid code\n", code);
+		return false;
+	}
+	if(c.addr < 0x2000)
+	{
+		if(cheatRamNum == CHEAT_MAX)
+			return false;
+		c.addr &= 0x7FF;
+		cheatRam[cheatRamNum++] = c;
+	}
+	else
+	{
+		if(cheatReadNum == CHEAT_MAX)
+			return false;
+		cheatRead[cheatReadNum++] = c;
+		cheatReadPages |= 1<<(c.addr>>12);
+		if(cheatOrigGet8 == NULL)
+		{
+			cheatOrigGet8 = mapperGet8;
+			mapperGet8 = cheatGet8;
+		}
+	}
+	if(c.hasCmp)
+		printf("Cheat: %04X:%02X if %02X\n", c.addr, c.val, c.cmp);
+	else
+		printf("Cheat: %04X:%02X\n", c.addr, c.val);
+	return true;
+}
+
+void cheatClear()
+{
+	//a newly loaded game already replaced the wrapper
+	if(cheatOrigGet8 != NULL && mapperGet8 == cheatGet8)
+		mapperGet8 = cheatOrigGet8;
+	cheatOrigGet8 = NULL;
+	cheatReadNum = 0;
+	cheatReadPages = 0;
+	cheatRamNum = 0;
+}
+
+//called at the end of every emulated frame
+void cheatFrame()
+{
+	uint8_t i;
+	if(!cheatRamNum)
+		return;
+	uint8_t *ram = memGetMainMem();
+	for(i = 0; i < cheatRamNum; i++)
+	{
+		if(!cheatRam[i].hasCmp || ram[cheatRam[i].addr] == cheatRam[i].cmp)
+			ram[cheatRam[i].addr] = cheatRam[i].val;
+	}
+}
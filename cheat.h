@@ -0,0 +1,15 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#ifndef _cheat_h_
+#define _cheat_h_
+
+bool cheatAdd(const char *code);
+void cheatClear();
+void cheatFrame();
+
+#endif
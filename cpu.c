@@ -14,6 +14,10 @@
 #include "apu.h"
 #include "cpu.h"
 #include "mapper_h/nsf.h"
+#include "state.h"
+#include "trace.h"
+#include "prof.h"
+#include "stats.h"
 
 #define P_FLAG_CARRY (1<<0)
 #define P_FLAG_ZERO (1<<1)
@@ -56,6 +60,7 @@ static struct {
 	uint16_t dmc_dma_addr;
 	uint8_t oam_dma_ptr;
 	uint8_t oam_dma_val;
+	uint64_t cycles;
 } cpu;
 
 static void cpuSetStartArray();
@@ -94,6 +99,7 @@ void cpuInit()
 	cpu.dmc_dma_addr = 0;
 	cpu.oam_dma_ptr = 0;
 	cpu.oam_dma_val = 0;
+	cpu.cycles = 0;
 
 	interrupt = 0;
 	cpu_odd_cycle = false;
@@ -103,6 +109,14 @@ void cpuInit()
 	//in retroarch, so clear those
 	nsf_startPlayback = false;
 	nsf_endPlayback = false;
+
+	uint8_t group = stateSetGroup(STATE_GROUP_CPU);
+	stateAddVar(cpu);
+	stateNoHashVar(cpu.action_arr);
+	stateAddVar(interrupt);
+	stateAddVar(cpu_odd_cycle);
+	stateAddVar(cpuWriteTMP);
+	stateSetGroup(group);
 }
 
 static void setRegStats(uint8_t reg)
@@ -775,6 +789,8 @@ static bool cpuHandleIrqUpdates()
 		cpu.action_arr = cpu_nmi_arr;
 		cpu.arr_pos = 0;
 		//cpu.instr = 0;
+		if(profActive)
+			profInterrupt(PROF_NMI);
 		#if DEBUG_INTR
 		printf("NMI from cpu.p %02x cpu.pc %04x\n",cpu.p,cpu.pc);
 		#endif
@@ -786,6 +802,8 @@ static bool cpuHandleIrqUpdates()
 		cpu.action_arr = cpu_irq_arr;
 		cpu.arr_pos = 0;
 		//cpu.instr = 0;
+		if(profActive)
+			profInterrupt(PROF_IRQ);
 		#if DEBUG_INTR
 		printf("INTR %02x from cpu.p %02x cpu.pc %04x\n",interrupt,cpu.p,cpu.pc);
 		#endif
@@ -992,11 +1010,15 @@ static void cpuDoDMA()
 bool cpuCycle()
 {
 	cpu_odd_cycle^=true;
+	cpu.cycles++;
 	//printf("CPU Cycle\n");
 	//do DMC and OAM DMA first
 	cpuDoDMA();
 	if(cpu.currently_dma)
+	{
+		STATS_INC(STATS_DMA_STALL);
 		return true;
+	}
 	uint8_t instr, cpu_action;
 	cpu_action = cpu.action_arr[cpu.arr_pos];
 	cpu.arr_pos++;
@@ -1017,6 +1039,10 @@ bool cpuCycle()
 			cpu.arr_pos = 0;
 			cpu.instr = instr;
 			//printf("%04x %02x %02x %02x %02x %02x\n", cpu.pc, instr, cpu.a, cpu.x, cpu.y, cpu.p);
+			if(traceActive)
+				traceInstr(instr);
+			if(profActive)
+				profInstr(instr);
 			cpu.pc++;
 			break;
 		case CPU_NULL_READ8_PC:
@@ -1521,6 +1547,28 @@ uint16_t cpuGetPc()
 	return cpu.pc;
 }
 
+uint64_t cpuGetCycles()
+{
+	return cpu.cycles;
+}
+
+void cpuGetRegs(cpuRegs_t *regs)
+{
+	regs->pc = cpu.pc;
+	regs->a = cpu.a;
+	regs->x = cpu.x;
+	regs->y = cpu.y;
+	regs->p = cpu.p;
+	regs->s = cpu.s;
+}
+
+//true while the current cycle fetches an opcode from cpu.pc
+bool cpuInFetch()
+{
+	return cpu.arr_pos && !cpu.currently_dma
+		&& cpu.action_arr[cpu.arr_pos-1] == CPU_GET_INSTRUCTION;
+}
+
 void cpuStartPlayNSF()
 {
 	//used in NSF mapper to detect play return
@@ -18,6 +18,14 @@ void cpuDoOAM_DMA(uint16_t addr);
 void cpuDoDMC_DMA(uint16_t addr);
 bool cpuInDMC_DMA();
 uint16_t cpuGetPc();
+uint64_t cpuGetCycles();
+
+typedef struct _cpuRegs_t {
+	uint16_t pc;
+	uint8_t a, x, y, p, s;
+} cpuRegs_t;
+void cpuGetRegs(cpuRegs_t *regs);
+bool cpuInFetch();
 
 #define MAPPER_IRQ (1<<0)
 #define APU_IRQ (1<<1)
@@ -0,0 +1,472 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include "mapper.h"
+#include "mem.h"
+#include "cpu.h"
+#include "ppu.h"
+#include "dbg.h"
+
+/*
+ * Breakpoints and watchpoints work like the cheats do, the mapper
+ * functions of the space they sit in get wrapped while needed and
+ * go back to the plain ones once the last trap there is removed.
+ * Only the internal ram and registers below $4020 do not go through
+ * the mapper, those can only be trapped in EMU_DBG_LOW builds where
+ * mem.c checks dbgLowActive once per access.
+ * Breakpoints can be limited to one prg bank on mappers that report
+ * their banks through mapperPrgBank.
+ * When a trap hits, the emulation stays right inside that access
+ * while commands get read from stdin.
+ */
+#define DBG_MAX 32
+
+typedef struct _dbg_trap_t {
+	uint8_t type;
+	uint16_t addr;
+	//prg bank for DBG_EXEC and dot for DBG_LINE, -1 for any
+	int16_t arg;
+	bool hit;
+} dbg_trap_t;
+
+static dbg_trap_t dbgTraps[DBG_MAX];
+static uint8_t dbgNum = 0;
+static bool dbgStep = false;
+#if EMU_DBG_LOW
+bool dbgLowActive = false;
+#endif
+//bit per 4k page holding a cpu or ppu trap
+static uint16_t dbgCpuPages = 0;
+static uint8_t dbgPpuPages = 0;
+static bool dbgLines = false;
+
+static get8FuncT dbgOrigGet8 = NULL;
+static set8FuncT dbgOrigSet8 = NULL;
+static chrGet8FuncT dbgOrigChrGet8 = NULL;
+static chrSet8FuncT dbgOrigChrSet8 = NULL;
+static vramGet8FuncT dbgOrigVramGet8 = NULL;
+static vramSet8FuncT dbgOrigVramSet8 = NULL;
+static cycleFuncT dbgOrigCycle = NULL;
+
+static const char *dbgTypeNames[] = { "exec", "read", "write", "ppu read", "ppu write", "line" };
+
+//ram and ppu register mirrors all match the same trap
+static uint16_t dbgCpuAddr(uint16_t addr)
+{
+	if(addr < 0x2000)
+		return addr&0x7FF;
+	if(addr < 0x4000)
+		return addr&0x2007;
+	return addr;
+}
+
+static void dbgPrompt();
+
+static void dbgStop(const char *reason)
+{
+	cpuRegs_t r;
+	cpuGetRegs(&r);
+	printf("Debug: %s\n", reason);
+	printf("Debug: PC:%04X A:%02X X:%02X Y:%02X P:%02X S:%02X line %i dot %i\n",
+		r.pc, r.a, r.x, r.y, r.p, r.s, ppuGetCurLine(), ppuGetCurDot());
+	dbgPrompt();
+}
+
+static void dbgCpuCheck(uint8_t type, uint16_t addr, uint8_t val)
+{
+	char reason[48];
+	uint8_t i;
+	if(dbgStep && type == DBG_EXEC)
+	{
+		sprintf(reason, "Step to %04X (%02X)", addr, val);
+		dbgStop(reason);
+		return;
+	}
+	addr = dbgCpuAddr(addr);
+	if(!(dbgCpuPages & (1<<(addr>>12))))
+		return;
+	for(i = 0; i < dbgNum; i++)
+	{
+		if(dbgTraps[i].type == type && dbgTraps[i].addr == addr
+			&& (dbgTraps[i].arg < 0 || dbgTraps[i].arg == mapperGetPrgBank(addr)))
+		{
+			sprintf(reason, "Trap %i, %s %04X (%02X)", i, dbgTypeNames[type], addr, val);
+			dbgStop(reason);
+			return;
+		}
+	}
+}
+
+static void dbgPpuCheck(uint8_t type, uint16_t addr, uint8_t val)
+{
+	char reason[48];
+	uint8_t i;
+	if(!(dbgPpuPages & (1<<(addr>>12))))
+		return;
+	for(i = 0; i < dbgNum; i++)
+	{
+		if(dbgTraps[i].type == type && dbgTraps[i].addr == addr)
+		{
+			sprintf(reason, "Trap %i, %s %04X (%02X)", i, dbgTypeNames[type], addr, val);
+			dbgStop(reason);
+			return;
+		}
+	}
+}
+
+#if EMU_DBG_LOW
+void dbgLowGet8(uint16_t addr, uint8_t val)
+{
+	dbgCpuCheck(cpuInFetch() ? DBG_EXEC : DBG_READ, addr, val);
+}
+
+void dbgLowSet8(uint16_t addr, uint8_t val)
+{
+	dbgCpuCheck(DBG_WRITE, addr, val);
+}
+#endif
+
+static uint8_t dbgGet8(uint16_t addr, uint8_t val)
+{
+	val = dbgOrigGet8(addr, val);
+	dbgCpuCheck(cpuInFetch() ? DBG_EXEC : DBG_READ, addr, val);
+	return val;
+}
+
+static void dbgSet8(uint16_t addr, uint8_t val)
+{
+	dbgOrigSet8(addr, val);
+	dbgCpuCheck(DBG_WRITE, addr, val);
+}
+
+static uint8_t dbgChrGet8(uint16_t addr)
+{
+	uint8_t val = dbgOrigChrGet8(addr);
+	dbgPpuCheck(DBG_PPU_READ, addr&0x3FFF, val);
+	return val;
+}
+
+static void dbgChrSet8(uint16_t addr, uint8_t val)
+{
+	dbgOrigChrSet8(addr, val);
+	dbgPpuCheck(DBG_PPU_WRITE, addr&0x3FFF, val);
+}
+
+//nametables arrive as offset into the ram behind them
+static uint8_t dbgVramGet8(uint16_t addr)
+{
+	uint8_t val = dbgOrigVramGet8(addr);
+	dbgPpuCheck(DBG_PPU_READ, 0x2000|(addr&0xFFF), val);
+	return val;
+}
+
+static void dbgVramSet8(uint16_t addr, uint8_t val)
+{
+	dbgOrigVramSet8(addr, val);
+	dbgPpuCheck(DBG_PPU_WRITE, 0x2000|(addr&0xFFF), val);
+}
+
+static void dbgCycle()
+{
+	uint16_t line = ppuGetCurLine(), dot = ppuGetCurDot();
+	uint8_t i;
+	char reason[48];
+	dbgOrigCycle();
+	for(i = 0; i < dbgNum; i++)
+	{
+		if(dbgTraps[i].type != DBG_LINE)
+			continue;
+		//the ppu moves several dots per call, so stop once past it
+		if(dbgTraps[i].addr != line)
+			dbgTraps[i].hit = false;
+		else if(!dbgTraps[i].hit && dot >= dbgTraps[i].arg)
+		{
+			dbgTraps[i].hit = true;
+			sprintf(reason, "Trap %i, line %i", i, line);
+			dbgStop(reason);
+		}
+	}
+}
+
+//wraps a mapper function while on, a wrapper that got wrapped
+//again by someone else stays in place and just stops checking
+#define DBG_HOOK(on, func, orig, hook) do { \
+		if((on) && orig == NULL) \
+		{ \
+			orig = func; \
+			func = hook; \
+		} \
+		else if(!(on) && orig != NULL && func == hook) \
+		{ \
+			func = orig; \
+			orig = NULL; \
+		} \
+	} while(0)
+
+static void dbgUpdateHooks()
+{
+	bool cart = dbgStep, ppu = false;
+	uint8_t i;
+#if EMU_DBG_LOW
+	dbgLowActive = dbgStep;
+#endif
+	dbgCpuPages = 0;
+	dbgPpuPages = 0;
+	dbgLines = false;
+	for(i = 0; i < dbgNum; i++)
+	{
+		uint16_t addr = dbgTraps[i].addr;
+		switch(dbgTraps[i].type)
+		{
+			case DBG_EXEC:
+			case DBG_READ:
+				dbgCpuPages |= 1<<(addr>>12);
+				if(addr >= 0x4020)
+					cart = true;
+#if EMU_DBG_LOW
+				else
+					dbgLowActive = true;
+#endif
+				break;
+			case DBG_WRITE:
+				//everything from $4000 gets written through the mapper
+				dbgCpuPages |= 1<<(addr>>12);
+				if(addr >= 0x4000)
+					cart = true;
+#if EMU_DBG_LOW
+				else
+					dbgLowActive = true;
+#endif
+				break;
+			case DBG_PPU_READ:
+			case DBG_PPU_WRITE:
+				dbgPpuPages |= 1<<(addr>>12);
+				ppu = true;
+				break;
+			default:
+				dbgLines = true;
+				break;
+		}
+	}
+	DBG_HOOK(cart, mapperGet8, dbgOrigGet8, dbgGet8);
+	DBG_HOOK(cart, mapperSet8, dbgOrigSet8, dbgSet8);
+	DBG_HOOK(ppu, mapperChrGet8, dbgOrigChrGet8, dbgChrGet8);
+	DBG_HOOK(ppu, mapperChrSet8, dbgOrigChrSet8, dbgChrSet8);
+	DBG_HOOK(ppu, mapperVramGet8, dbgOrigVramGet8, dbgVramGet8);
+	DBG_HOOK(ppu, mapperVramSet8, dbgOrigVramSet8, dbgVramSet8);
+	DBG_HOOK(dbgLines, mapperCycle, dbgOrigCycle, dbgCycle);
+}
+
+bool dbgAdd(uint8_t type, uint16_t addr, int16_t arg)
+{
+	if(dbgNum == DBG_MAX || type > DBG_LINE)
+		return false;
+	if(type == DBG_LINE)
+	{
+		if(addr > 311 || arg > 340)
+			return false;
+		if(arg < 0)
+			arg = 0;
+	}
+	else if(type == DBG_PPU_READ || type == DBG_PPU_WRITE)
+	{
+		//palette is inside the ppu, only cartridge and vram
+		if(addr >= 0x3F00)
+			return false;
+		if(addr >= 0x2000)
+			addr = 0x2000|(addr&0xFFF);
+	}
+	else
+	{
+#if !EMU_DBG_LOW
+		if(addr < (type == DBG_WRITE ? 0x4000 : 0x4020))
+		{
+			printf("Debug: Traps below $4020 need a build with -DEMU_DBG_LOW=1\n");
+			return false;
+		}
+#endif
+		//only cartridge rom gets banked
+		if(type == DBG_EXEC && arg >= 0 && (addr < 0x8000 || mapperPrgBank == NULL))
+		{
+			printf("Debug: No prg banks at %04X\n", addr);
+			return false;
+		}
+		addr = dbgCpuAddr(addr);
+	}
+	dbgTraps[dbgNum].type = type;
+	dbgTraps[dbgNum].addr = addr;
+	dbgTraps[dbgNum].arg = (type == DBG_EXEC || type == DBG_LINE) ? arg : -1;
+	dbgTraps[dbgNum].hit = false;
+	dbgNum++;
+	dbgUpdateHooks();
+	return true;
+}
+
+bool dbgRemove(uint8_t num)
+{
+	if(num >= dbgNum)
+		return false;
+	memmove(&dbgTraps[num], &dbgTraps[num+1], (dbgNum-num-1)*sizeof(dbg_trap_t));
+	dbgNum--;
+	dbgUpdateHooks();
+	return true;
+}
+
+void dbgClear()
+{
+	dbgNum = 0;
+	dbgStep = false;
+	dbgUpdateHooks();
+	//a newly loaded game already replaced the wrappers
+	dbgOrigGet8 = NULL;
+	dbgOrigSet8 = NULL;
+	dbgOrigChrGet8 = NULL;
+	dbgOrigChrSet8 = NULL;
+	dbgOrigVramGet8 = NULL;
+	dbgOrigVramSet8 = NULL;
+	dbgOrigCycle = NULL;
+}
+
+//stops right before the next instruction
+void dbgBreak()
+{
+	dbgStep = true;
+	dbgUpdateHooks();
+}
+
+static void dbgList()
+{
+	uint8_t i;
+	for(i = 0; i < dbgNum; i++)
+	{
+		if(dbgTraps[i].type == DBG_LINE)
+			printf("%i: line %i dot %i\n", i, dbgTraps[i].addr, dbgTraps[i].arg);
+		else if(dbgTraps[i].arg >= 0)
+			printf("%i: %s %04X in bank %X\n", i, dbgTypeNames[dbgTraps[i].type], dbgTraps[i].addr, dbgTraps[i].arg);
+		else
+			printf("%i: %s %04X\n", i, dbgTypeNames[dbgTraps[i].type], dbgTraps[i].addr);
+	}
+}
+
+//reads without hitting any trap, registers may change
+//on reads so those are left alone
+bool dbgPeek8(uint16_t addr, uint8_t *val)
+{
+	if(addr < 0x2000)
+		*val = memGetMainMem()[addr&0x7FF];
+	else if(addr >= 0x4020)
+		*val = (dbgOrigGet8 ? dbgOrigGet8 : mapperGet8)(addr, 0);
+	else
+		return false;
+	return true;
+}
+
+static void dbgDump(uint16_t addr, uint16_t len)
+{
+	uint16_t i;
+	uint8_t val;
+	for(i = 0; i < len; i++, addr++)
+	{
+		if((i&15) == 0)
+			printf("%s%04X:", i ? "\n" : "", addr);
+		if(dbgPeek8(addr, &val))
+			printf(" %02X", val);
+		else
+			printf(" --");
+	}
+	printf("\n");
+}
+
+static void dbgHelp()
+{
+	printf("b addr [bank]  stop before addr runs, only in that 8k prg bank\n");
+	printf("r addr         stop on cpu reads of addr\n");
+	printf("w addr         stop on cpu writes to addr\n");
+	printf("pr addr        stop on ppu reads of addr\n");
+	printf("pw addr        stop on ppu writes to addr\n");
+	printf("l line [dot]   stop at that scanline and dot\n");
+	printf("d n            delete trap n\n");
+	printf("i              list traps\n");
+	printf("m addr [len]   show cpu memory\n");
+	printf("s              step one instruction\n");
+	printf("c              continue\n");
+	printf("q              quit\n");
+}
+
+static void dbgPrompt()
+{
+	char line[128], cmd[8];
+	unsigned int a, b;
+	int n;
+	while(1)
+	{
+		printf("> ");
+		fflush(stdout);
+		if(fgets(line, sizeof(line), stdin) == NULL)
+		{
+			//nobody there to type, just let it run
+			dbgNum = 0;
+			dbgStep = false;
+			dbgUpdateHooks();
+			return;
+		}
+		n = sscanf(line, "%7s %x%*[: ]%x", cmd, &a, &b);
+		if(n < 1)
+			continue;
+		if(strcmp(cmd, "s") == 0 || strcmp(cmd, "c") == 0)
+		{
+			dbgStep = (cmd[0] == 's');
+			dbgUpdateHooks();
+			return;
+		}
+		else if(strcmp(cmd, "q") == 0)
+			exit(EXIT_SUCCESS);
+		else if(strcmp(cmd, "i") == 0)
+			dbgList();
+		else if(strcmp(cmd, "m") == 0 && n >= 2)
+			dbgDump(a, n == 3 ? b : 16);
+		else if(strcmp(cmd, "d") == 0 && n >= 2)
+		{
+			if(!dbgRemove(a))
+				printf("Debug: No trap %x\n", a);
+		}
+		//line numbers read better in decimal
+		else if(strcmp(cmd, "l") == 0 && (n = sscanf(line, "%*s %u %u", &a, &b)) >= 1)
+		{
+			if(!dbgAdd(DBG_LINE, a, n == 2 ? (int16_t)b : -1))
+				printf("Debug: Could not add line %u\n", a);
+		}
+		else if(n >= 2 && a <= 0xFFFF)
+		{
+			uint8_t type;
+			if(strcmp(cmd, "b") == 0)
+				type = DBG_EXEC;
+			else if(strcmp(cmd, "r") == 0)
+				type = DBG_READ;
+			else if(strcmp(cmd, "w") == 0)
+				type = DBG_WRITE;
+			else if(strcmp(cmd, "pr") == 0)
+				type = DBG_PPU_READ;
+			else if(strcmp(cmd, "pw") == 0)
+				type = DBG_PPU_WRITE;
+			else
+			{
+				dbgHelp();
+				continue;
+			}
+			if(!dbgAdd(type, a, (n == 3 && b <= 0x7FFF) ? (int16_t)b : -1))
+				printf("Debug: Could not add %s %04X\n", dbgTypeNames[type], a);
+		}
+		else
+			dbgHelp();
+	}
+}
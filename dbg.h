@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#ifndef _dbg_h_
+#define _dbg_h_
+
+#define DBG_EXEC      0
+#define DBG_READ      1
+#define DBG_WRITE     2
+#define DBG_PPU_READ  3
+#define DBG_PPU_WRITE 4
+#define DBG_LINE      5
+
+//build with -DEMU_DBG_LOW=1 to also trap the internal ram and
+//registers below $4020, without it mem.c gets no debugger checks
+//and only the cartridge space and ppu can be trapped
+#ifndef EMU_DBG_LOW
+#define EMU_DBG_LOW 0
+#endif
+
+#if EMU_DBG_LOW
+extern bool dbgLowActive;
+void dbgLowGet8(uint16_t addr, uint8_t val);
+void dbgLowSet8(uint16_t addr, uint8_t val);
+#define DBG_LOW_GET8(addr, val) do { \
+		if(dbgLowActive && (addr) < 0x4020) dbgLowGet8(addr, val); \
+	} while(0)
+#define DBG_LOW_SET8(addr, val) do { \
+		if(dbgLowActive && (addr) < 0x4000) dbgLowSet8(addr, val); \
+	} while(0)
+#else
+#define DBG_LOW_GET8(addr, val) ((void)0)
+#define DBG_LOW_SET8(addr, val) ((void)0)
+#endif
+
+bool dbgAdd(uint8_t type, uint16_t addr, int16_t arg);
+bool dbgRemove(uint8_t num);
+void dbgClear();
+void dbgBreak();
+bool dbgPeek8(uint16_t addr, uint8_t *val);
+
+#endif
@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include "rominfo.h"
+#include "gamedb.h"
+
+static const gameDbEntry_t gameDbList[] = {
+#define GAMEDB(crc, mapper, submapper, region, prgRam) { crc, mapper, submapper, region, prgRam },
+#include "gamedb_list.h"
+#undef GAMEDB
+	{ 0, 0, 0, 0, 0 } //end marker, keeps the list valid when empty
+};
+static uint32_t gameDbNum;
+
+/*
+ * Hash and displace perfect hash over the list: every crc first
+ * picks a bucket, each bucket got a displacement that sends all
+ * of its crcs to distinct slots, so a lookup is always exactly
+ * one bucket read and one slot read.
+ */
+static uint16_t *gameDbDisp = NULL;
+static uint16_t *gameDbSlots = NULL;
+static uint32_t gameDbBuckets, gameDbSlotMask;
+static bool gameDbReady = false;
+
+static inline uint32_t gameDbMix(uint32_t v)
+{
+	v ^= v >> 16;
+	v *= 0x7FEB352D;
+	v ^= v >> 15;
+	v *= 0x846CA68B;
+	v ^= v >> 16;
+	return v;
+}
+
+static inline uint32_t gameDbSlot(uint32_t crc, uint32_t disp)
+{
+	return gameDbMix(crc ^ (disp * 0x9E3779B9)) & gameDbSlotMask;
+}
+
+static uint32_t *gameDbBucketStart;
+
+static int gameDbBucketCmp(const void *a, const void *b)
+{
+	uint32_t ba = *(const uint32_t*)a, bb = *(const uint32_t*)b;
+	uint32_t sa = gameDbBucketStart[ba+1] - gameDbBucketStart[ba];
+	uint32_t sb = gameDbBucketStart[bb+1] - gameDbBucketStart[bb];
+	//biggest buckets first, they are the hardest to place
+	if(sa != sb)
+		return (sa < sb) - (sa > sb);
+	return (ba > bb) - (ba < bb);
+}
+
+//call once before looking up from several threads
+void gameDbInit()
+{
+	uint32_t i, j;
+	if(gameDbReady)
+		return;
+	gameDbReady = true;
+	gameDbNum = sizeof(gameDbList)/sizeof(gameDbList[0]) - 1;
+	if(gameDbNum == 0)
+		return;
+	gameDbBuckets = gameDbNum/4 + 1;
+	uint32_t slots = 1;
+	while(slots < gameDbNum)
+		slots <<= 1;
+	gameDbSlotMask = slots-1;
+	gameDbDisp = calloc(gameDbBuckets, sizeof(uint16_t));
+	gameDbSlots = malloc(slots*sizeof(uint16_t));
+	//entries grouped by bucket, placed from the biggest bucket down
+	gameDbBucketStart = calloc(gameDbBuckets+1, sizeof(uint32_t));
+	uint32_t *members = malloc(gameDbNum*sizeof(uint32_t));
+	uint32_t *order = malloc(gameDbBuckets*sizeof(uint32_t));
+	uint32_t *placed = malloc(gameDbNum*sizeof(uint32_t));
+	if(!gameDbDisp || !gameDbSlots || !gameDbBucketStart || !members || !order || !placed)
+		goto fail;
+	memset(gameDbSlots, 0xFF, slots*sizeof(uint16_t));
+	for(i = 0; i < gameDbNum; i++)
+		gameDbBucketStart[gameDbMix(gameDbList[i].crc) % gameDbBuckets + 1]++;
+	for(i = 0; i < gameDbBuckets; i++)
+	{
+		gameDbBucketStart[i+1] += gameDbBucketStart[i];
+		order[i] = i;
+	}
+	memcpy(placed, gameDbBucketStart, gameDbBuckets*sizeof(uint32_t));
+	for(i = 0; i < gameDbNum; i++)
+		members[placed[gameDbMix(gameDbList[i].crc) % gameDbBuckets]++] = i;
+	qsort(order, gameDbBuckets, sizeof(uint32_t), gameDbBucketCmp);
+	for(i = 0; i < gameDbBuckets; i++)
+	{
+		uint32_t b = order[i];
+		uint32_t first = gameDbBucketStart[b], last = gameDbBucketStart[b+1];
+		if(first == last)
+			break;
+		uint32_t disp;
+		for(disp = 0; disp < 0x10000; disp++)
+		{
+			uint32_t num = 0;
+			for(j = first; j < last; j++)
+			{
+				uint32_t s = gameDbSlot(gameDbList[members[j]].crc, disp);
+				if(gameDbSlots[s] != 0xFFFF)
+					break;
+				gameDbSlots[s] = members[j];
+				placed[num++] = s;
+			}
+			if(j == last)
+				break;
+			//collided, undo this try
+			while(num)
+				gameDbSlots[placed[--num]] = 0xFFFF;
+		}
+		if(disp == 0x10000)
+		{
+			//only happens with the same crc listed twice
+			printf("GameDB: Could not place bucket %u, duplicate CRC?\n", b);
+			goto fail;
+		}
+		gameDbDisp[b] = disp;
+	}
+	//every listed crc has to come back out of the table
+	for(i = 0; i < gameDbNum; i++)
+	{
+		if(gameDbFind(gameDbList[i].crc) != &gameDbList[i])
+		{
+			printf("GameDB: CRC %08X of entry %u not found in the table\n", gameDbList[i].crc, i);
+			goto fail;
+		}
+	}
+	free(gameDbBucketStart);
+	free(members);
+	free(order);
+	free(placed);
+	gameDbBucketStart = NULL;
+	return;
+fail:
+	free(gameDbBucketStart);
+	free(members);
+	free(order);
+	free(placed);
+	free(gameDbDisp);
+	free(gameDbSlots);
+	gameDbBucketStart = NULL;
+	gameDbDisp = NULL;
+	gameDbSlots = NULL;
+}
+
+const gameDbEntry_t *gameDbFind(uint32_t crc)
+{
+	if(!gameDbReady)
+		gameDbInit();
+	if(!gameDbSlots)
+		return NULL;
+	uint32_t b = gameDbMix(crc) % gameDbBuckets;
+	uint16_t idx = gameDbSlots[gameDbSlot(crc, gameDbDisp[b])];
+	if(idx == 0xFFFF || gameDbList[idx].crc != crc)
+		return NULL;
+	return &gameDbList[idx];
+}
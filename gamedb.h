@@ -0,0 +1,23 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#ifndef _gamedb_h_
+#define _gamedb_h_
+
+typedef struct _gameDbEntry_t {
+	//crc32 of prg followed by chr
+	uint32_t crc;
+	uint16_t mapper;
+	uint8_t submapper;
+	uint8_t region;
+	uint32_t prgRamSize;
+} gameDbEntry_t;
+
+void gameDbInit();
+const gameDbEntry_t *gameDbFind(uint32_t crc);
+
+#endif
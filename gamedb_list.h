@@ -0,0 +1,19 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+/*
+ * Games whose header is wrong or too old to describe them,
+ * one line per game, only add entries checked against a dump:
+ * GAMEDB(crc32 of prg+chr, mapper, submapper, ROM_REGION_x, prg ram bytes)
+ * The crc is what --index-build prints into its index, or the
+ * PRG+CHR CRC32 from NES 2.0 header databases.
+ */
+
+//mapper 32 single screen board
+GAMEDB(0x243A8735, 32, 1, ROM_REGION_NTSC, 0) //Major League (J)
+//mapper 78 irem board with h/v mirroring
+GAMEDB(0xBA51AC6F, 78, 3, ROM_REGION_NTSC, 0) //Holy Diver (J)
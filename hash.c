@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include "apu.h"
+#include "state.h"
+#include "hash.h"
+
+/*
+ * A 64bit hash of every part of the machine plus the picture and
+ * sound it made, once per frame, so two builds or two machines can
+ * be shown to run a game the exact same way. The file is a small
+ * header followed by HASH_PARTS hashes for every frame, hashDiff
+ * names the first frame and parts that differ between two of them.
+ */
+
+#define HASH_VERSION 1
+#define HASH_VIDEO STATE_GROUPS
+#define HASH_AUDIO (STATE_GROUPS+1)
+#define HASH_PARTS (STATE_GROUPS+2)
+
+#define HASH_P1 0x9E3779B185EBCA87ULL
+#define HASH_P2 0xC2B2AE3D27D4EB4FULL
+#define HASH_P3 0x165667B19E3779F9ULL
+
+static const char *hashPartNames[HASH_PARTS] = {
+	"cart", "cpu", "ram", "ppu", "apu", "input", "video", "audio",
+};
+
+extern uint16_t textureImage[0xF000];
+
+static FILE *hashFile = NULL;
+static uint32_t hashFrames;
+static uint32_t hashAudioPos;
+static uint32_t hashAudioFlushes;
+
+static inline uint64_t hashRotl(uint64_t v, int r)
+{
+	return (v<<r) | (v>>(64-r));
+}
+
+static inline uint64_t hashRound(uint64_t acc, uint64_t in)
+{
+	acc += in*HASH_P2;
+	return hashRotl(acc, 31)*HASH_P1;
+}
+
+//4 independent lanes over 32 byte stripes so the multiplies
+//overlap, then the tail and a final mix of all bits
+uint64_t hashBuf(const void *buf, uint32_t size, uint64_t seed)
+{
+	const uint8_t *p = buf, *end = p + size;
+	uint64_t v0 = seed + HASH_P1 + HASH_P2, v1 = seed + HASH_P2;
+	uint64_t v2 = seed, v3 = seed - HASH_P1;
+	uint64_t h, in[4];
+	while(end - p >= 32)
+	{
+		memcpy(in, p, 32);
+		v0 = hashRound(v0, in[0]);
+		v1 = hashRound(v1, in[1]);
+		v2 = hashRound(v2, in[2]);
+		v3 = hashRound(v3, in[3]);
+		p += 32;
+	}
+	h = hashRotl(v0, 1) + hashRotl(v1, 7) + hashRotl(v2, 12) + hashRotl(v3, 18) + size;
+	while(end - p >= 8)
+	{
+		memcpy(in, p, 8);
+		h ^= hashRound(0, in[0]);
+		h = hashRotl(h, 27)*HASH_P1 + HASH_P3;
+		p += 8;
+	}
+	while(p < end)
+	{
+		h ^= (*p++)*HASH_P3;
+		h = hashRotl(h, 11)*HASH_P1;
+	}
+	h ^= h >> 33;
+	h *= HASH_P2;
+	h ^= h >> 29;
+	h *= HASH_P3;
+	h ^= h >> 32;
+	return h;
+}
+
+bool hashStart(const char *path)
+{
+	uint8_t hdr[8] = { 'F', 'X', 'S', 'H', HASH_VERSION, HASH_PARTS, 0, 0 };
+	hashStop();
+	hashFile = fopen(path, "wb");
+	if(hashFile == NULL)
+	{
+		printf("Hash: Could not write %s\n", path);
+		return false;
+	}
+	fwrite(hdr, 1, sizeof(hdr), hashFile);
+	hashFrames = 0;
+	hashAudioPos = 0;
+	hashAudioFlushes = apuGetBufFlushes();
+	printf("Hash: Writing frame hashes to %s\n", path);
+	return true;
+}
+
+void hashStop()
+{
+	if(hashFile == NULL)
+		return;
+	fclose(hashFile);
+	hashFile = NULL;
+	printf("Hash: %u frames hashed\n", hashFrames);
+}
+
+void hashFrame()
+{
+	uint64_t hashes[HASH_PARTS];
+	uint32_t audioSize;
+	if(hashFile == NULL)
+		return;
+	stateHash(hashes);
+	hashes[HASH_VIDEO] = hashBuf(textureImage, sizeof(textureImage), 0);
+	//the samples of this frame only, the buffer
+	//may hold more frames while fast-forwarding
+	audioSize = apuGetBufSize();
+	if(apuGetBufFlushes() != hashAudioFlushes || audioSize < hashAudioPos)
+	{
+		hashAudioFlushes = apuGetBufFlushes();
+		hashAudioPos = 0;
+	}
+	hashes[HASH_AUDIO] = hashBuf(apuGetBuf() + hashAudioPos, audioSize - hashAudioPos, 0);
+	hashAudioPos = audioSize;
+	fwrite(hashes, sizeof(hashes), 1, hashFile);
+	hashFrames++;
+}
+
+static FILE *hashOpen(const char *path)
+{
+	uint8_t hdr[8];
+	FILE *f = fopen(path, "rb");
+	if(f == NULL)
+	{
+		printf("Hash: Could not open %s\n", path);
+		return NULL;
+	}
+	if(fread(hdr, 1, sizeof(hdr), f) != sizeof(hdr) || memcmp(hdr, "FXSH", 4) != 0
+		|| hdr[4] != HASH_VERSION || hdr[5] != HASH_PARTS)
+	{
+		printf("Hash: %s is no fixNES hash file\n", path);
+		fclose(f);
+		return NULL;
+	}
+	return f;
+}
+
+//prints the first frame and which parts of it differ
+bool hashDiff(const char *pathA, const char *pathB)
+{
+	uint64_t ha[HASH_PARTS], hb[HASH_PARTS];
+	uint32_t n = 0;
+	uint8_t i;
+	bool gotA, gotB, same = true;
+	FILE *fa = hashOpen(pathA);
+	if(fa == NULL)
+		return false;
+	FILE *fb = hashOpen(pathB);
+	if(fb == NULL)
+	{
+		fclose(fa);
+		return false;
+	}
+	while(1)
+	{
+		gotA = (fread(ha, sizeof(ha), 1, fa) == 1);
+		gotB = (fread(hb, sizeof(hb), 1, fb) == 1);
+		if(!gotA || !gotB)
+		{
+			if(gotA != gotB)
+			{
+				printf("Hash: %s ends after %u frames\n", gotA ? pathB : pathA, n);
+				same = false;
+			}
+			else
+				printf("Hash: All %u frames match\n", n);
+			break;
+		}
+		if(memcmp(ha, hb, sizeof(ha)) != 0)
+		{
+			printf("Hash: First difference at frame %u in", n);
+			for(i = 0; i < HASH_PARTS; i++)
+			{
+				if(ha[i] != hb[i])
+					printf(" %s", hashPartNames[i]);
+			}
+			printf("\n");
+			same = false;
+			break;
+		}
+		n++;
+	}
+	fclose(fa);
+	fclose(fb);
+	return same;
+}
@@ -0,0 +1,17 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#ifndef _hash_h_
+#define _hash_h_
+
+uint64_t hashBuf(const void *buf, uint32_t size, uint64_t seed);
+bool hashStart(const char *path);
+void hashStop();
+void hashFrame();
+bool hashDiff(const char *pathA, const char *pathB);
+
+#endif
@@ -10,6 +10,7 @@
 #include <inttypes.h>
 #include <string.h>
 #include "input.h"
+#include "state.h"
 
 //used externally by main.c
 uint8_t inValReads[8];
@@ -18,13 +19,50 @@ uint8_t inPos = 0;
 
 #define DEBUG_INPUT 0
 
+//frontend pad read, deferred until the game actually strobes
+static void (*inPollCb)() = NULL;
+static bool inPollPending = false;
+
 void inputInit()
 {
 	memset(inValReads, 0, 8);
+	//button values get set fresh every frame, the shift position not
+	uint8_t group = stateSetGroup(STATE_GROUP_INPUT);
+	stateAddVar(inPollMode);
+	stateAddVar(inPos);
+	stateSetGroup(group);
+}
+
+void inputSetPollCallback(void (*cb)())
+{
+	inPollCb = cb;
+	inPollPending = false;
+}
+
+void inputStartFrame()
+{
+	inPollPending = (inPollCb != NULL);
+}
+
+static void inputPollLate()
+{
+	if(inPollPending)
+	{
+		inPollPending = false;
+		inPollCb();
+	}
+}
+
+//games that never read the pad still get polled once a frame
+void inputEndFrame()
+{
+	inputPollLate();
 }
 
 void inputSet(uint8_t in)
 {
+	if(in&1)
+		inputPollLate();
 	inPollMode = in;
 	#if DEBUG_INPUT
 	printf("Set %02x\n",in);
@@ -36,6 +74,8 @@ void inputSet(uint8_t in)
 uint8_t inputGet()
 {
 	uint8_t ret = 1;
+	//read without a strobe this frame, still give it fresh input
+	inputPollLate();
 	if(inPollMode&1)
 		ret = inValReads[BUTTON_A];
 	else if(inPos < 8)
@@ -20,5 +20,8 @@
 void inputInit();
 uint8_t inputGet();
 void inputSet(uint8_t in);
+void inputSetPollCallback(void (*cb)());
+void inputStartFrame();
+void inputEndFrame();
 
 #endif
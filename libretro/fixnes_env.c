@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include "ppu.h"
+#include "mem.h"
+#include "apu.h"
+#include "state.h"
+#include "fixnes_env.h"
+
+int nesEmuLoadGame(const char* filename);
+void nesEmuMainLoop(void);
+void nesEmuDeinit(void);
+extern uint16_t textureImage[0xF000];
+extern uint8_t inValReads[8];
+extern bool nesEmuNSFPlayback;
+
+static uint32_t envCount = 0;
+static uint32_t envStateSize;
+//one snapshot per console plus the one right after loading
+static uint8_t *envStates = NULL;
+static uint8_t *envStart = NULL;
+static uint16_t envRewardAddr;
+static uint8_t envRewardLen = 0;
+static uint8_t envRewardMode;
+
+int fixnes_env_create(const char *path, uint32_t count)
+{
+   uint32_t i;
+
+   fixnes_env_destroy();
+   if (!count || nesEmuLoadGame(path) != EXIT_SUCCESS)
+      return 0;
+   if (nesEmuNSFPlayback)
+   {
+      printf("Env: NSF files cannot be used\n");
+      nesEmuDeinit();
+      return 0;
+   }
+   envStateSize = stateSize();
+   envStart = malloc(envStateSize);
+   envStates = malloc((size_t)envStateSize * count);
+   if (!envStart || !envStates)
+   {
+      printf("Env: Could not allocate %u consoles\n", count);
+      fixnes_env_destroy();
+      nesEmuDeinit();
+      return 0;
+   }
+   stateSave(envStart);
+   for (i = 0; i < count; i++)
+      memcpy(envStates + (size_t)envStateSize * i, envStart, envStateSize);
+   envCount = count;
+   envRewardLen = 0;
+   //nobody listens to the audio
+   apuSkipOutput = true;
+   printf("Env: %u consoles, %u bytes each\n", count, envStateSize);
+   return 1;
+}
+
+void fixnes_env_destroy(void)
+{
+   if (envStates)
+      free(envStates);
+   if (envStart)
+      free(envStart);
+   envStates = NULL;
+   envStart = NULL;
+   if (envCount)
+   {
+      nesEmuDeinit();
+      apuSkipOutput = false;
+   }
+   envCount = 0;
+}
+
+uint32_t fixnes_env_count(void)
+{
+   return envCount;
+}
+
+void fixnes_env_reset(uint32_t idx)
+{
+   if (idx < envCount)
+      memcpy(envStates + (size_t)envStateSize * idx, envStart, envStateSize);
+}
+
+void fixnes_env_set_reward(uint16_t addr, uint8_t len, uint8_t mode)
+{
+   if (len > 4 || addr + len > FIXNES_ENV_RAM_SIZE)
+      len = 0;
+   envRewardAddr = addr;
+   envRewardLen = len;
+   envRewardMode = mode;
+}
+
+static uint32_t envRewardValue(const uint8_t *ram)
+{
+   uint32_t val = 0;
+   uint8_t i;
+   for (i = 0; i < envRewardLen; i++)
+   {
+      if (envRewardMode == FIXNES_ENV_REWARD_DIGITS)
+         val = val*10 + (ram[envRewardAddr+i] % 10);
+      else
+         val |= ram[envRewardAddr+i] << (i*8);
+   }
+   return val;
+}
+
+void fixnes_env_step(const uint8_t *actions, uint32_t frameSkip,
+   uint16_t *frames, uint8_t *ram, float *rewards)
+{
+   const uint8_t *mainMem = memGetMainMem();
+   uint32_t i, f;
+   uint8_t b;
+
+   if (!frameSkip)
+      frameSkip = 1;
+   for (i = 0; i < envCount; i++)
+   {
+      uint8_t *state = envStates + (size_t)envStateSize * i;
+      stateLoad(state);
+      uint32_t before = envRewardValue(mainMem);
+      for (b = 0; b < 8; b++)
+         inValReads[b] = (actions[i] >> b) & 1;
+      for (f = 0; f < frameSkip; f++)
+      {
+         //only the last frame ever gets looked at
+         ppuSkipRender = !frames || f+1 < frameSkip;
+         nesEmuMainLoop();
+      }
+      stateSave(state);
+      if (frames)
+         memcpy(frames + (size_t)FIXNES_ENV_WIDTH*FIXNES_ENV_HEIGHT*i, textureImage,
+            FIXNES_ENV_WIDTH*FIXNES_ENV_HEIGHT*sizeof(uint16_t));
+      if (ram)
+         memcpy(ram + (size_t)FIXNES_ENV_RAM_SIZE*i, mainMem, FIXNES_ENV_RAM_SIZE);
+      if (rewards)
+         rewards[i] = (float)envRewardValue(mainMem) - (float)before;
+   }
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#ifndef _fixnes_env_h_
+#define _fixnes_env_h_
+
+#include <stdint.h>
+
+/*
+ * Batched environment for training agents, exported from the
+ * libretro core next to the retro_* functions. All consoles run
+ * the same game, each one is a machine snapshot that gets swapped
+ * in, stepped and swapped out again, so one call steps them all.
+ * Do not mix this with the retro_* functions in one process.
+ */
+
+#define FIXNES_ENV_WIDTH 256
+#define FIXNES_ENV_HEIGHT 240
+#define FIXNES_ENV_RAM_SIZE 0x800
+
+//reward is the change of a counter in internal ram
+#define FIXNES_ENV_REWARD_BINARY 0 //little endian bytes
+#define FIXNES_ENV_REWARD_DIGITS 1 //one decimal digit per byte, highest first
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int fixnes_env_create(const char *path, uint32_t count);
+void fixnes_env_destroy(void);
+uint32_t fixnes_env_count(void);
+void fixnes_env_reset(uint32_t idx);
+void fixnes_env_set_reward(uint16_t addr, uint8_t len, uint8_t mode);
+/*
+ * actions holds one byte per console, bit n is inValReads[n]
+ * (A, B, Select, Start, Up, Down, Left, Right), each console runs
+ * frameSkip frames with it. Any output may be NULL, otherwise
+ * frames gets count RGB565 images of WIDTH*HEIGHT, ram gets count
+ * times RAM_SIZE bytes and rewards gets count floats.
+ */
+void fixnes_env_step(const uint8_t *actions, uint32_t frameSkip,
+   uint16_t *frames, uint8_t *ram, float *rewards);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
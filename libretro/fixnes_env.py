@@ -0,0 +1,66 @@
+#
+# Copyright (C) 2017 FIX94
+#
+# This software may be modified and distributed under the terms
+# of the MIT license.  See the LICENSE file for details.
+#
+
+# Thin ctypes binding for the batched environment in fixnes_env.h.
+# All outputs live in ctypes arrays allocated once, the core writes
+# straight into them on every step. To get numpy views without any
+# copy use numpy.ctypeslib.as_array(env.frames) and so on.
+
+import ctypes
+
+WIDTH = 256
+HEIGHT = 240
+RAM_SIZE = 0x800
+
+REWARD_BINARY = 0
+REWARD_DIGITS = 1
+
+# bits of an action byte
+A, B, SELECT, START, UP, DOWN, LEFT, RIGHT = [1 << i for i in range(8)]
+
+
+class FixNESEnv(object):
+    def __init__(self, core, rom, count, frame_skip=1):
+        self.lib = ctypes.CDLL(core)
+        lib = self.lib
+        lib.fixnes_env_create.argtypes = [ctypes.c_char_p, ctypes.c_uint32]
+        lib.fixnes_env_create.restype = ctypes.c_int
+        lib.fixnes_env_destroy.argtypes = []
+        lib.fixnes_env_reset.argtypes = [ctypes.c_uint32]
+        lib.fixnes_env_set_reward.argtypes = [ctypes.c_uint16, ctypes.c_uint8, ctypes.c_uint8]
+        lib.fixnes_env_step.argtypes = [ctypes.c_void_p, ctypes.c_uint32,
+                                        ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p]
+        if not lib.fixnes_env_create(rom.encode(), count):
+            raise RuntimeError("could not load %s" % rom)
+        self.count = count
+        self.frame_skip = frame_skip
+        self.actions = (ctypes.c_uint8 * count)()
+        self.frames = (ctypes.c_uint16 * (count * WIDTH * HEIGHT))()
+        self.ram = (ctypes.c_uint8 * (count * RAM_SIZE))()
+        self.rewards = (ctypes.c_float * count)()
+
+    def set_reward(self, addr, length, mode=REWARD_BINARY):
+        self.lib.fixnes_env_set_reward(addr, length, mode)
+
+    def reset(self, idx=None):
+        for i in range(self.count) if idx is None else [idx]:
+            self.lib.fixnes_env_reset(i)
+
+    def step(self, actions=None, frames=True, ram=True):
+        """Steps every console, actions is one byte per console or
+        None to reuse self.actions, frames/ram False skips that output."""
+        if actions is not None:
+            self.actions[:] = actions
+        self.lib.fixnes_env_step(self.actions, self.frame_skip,
+                                 self.frames if frames else None,
+                                 self.ram if ram else None, self.rewards)
+        return self.rewards
+
+    def close(self):
+        if self.lib is not None:
+            self.lib.fixnes_env_destroy()
+            self.lib = None
@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#ifndef _fixnes_mem_h_
+#define _fixnes_mem_h_
+
+#include <stddef.h>
+
+/*
+ * Direct pointers into the emulated memory, exported from the
+ * libretro core. They stay the same for as long as the game
+ * stays loaded, so tools can fetch them once and read them
+ * every frame without any copying.
+ */
+
+#define FIXNES_MEM_RAM     0 //2k internal ram
+#define FIXNES_MEM_VRAM    1 //4k nametable ram
+#define FIXNES_MEM_OAM     2 //256 bytes sprite ram
+#define FIXNES_MEM_PALETTE 3 //32 bytes palette ram
+#define FIXNES_MEM_PRG_RAM 4 //cartridge or fds ram
+#define FIXNES_MEM_PRG_ROM 5 //whole prg rom, .nes files only
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//NULL if there is no such memory, size can be NULL
+void *fixnes_mem_get(unsigned region, size_t *size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
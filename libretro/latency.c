@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "ppu.h"
+#include "libretro.h"
+
+/*
+ * Tiny frontend linked straight to the core that checks when the pad
+ * gets polled: retro_run should read it on the first $4016 strobe of
+ * the frame, not up front when the frame starts. Runs on input.nes
+ * from testroms/, which strobes right after its sprite 0 hit on
+ * scanline 80, and fails if polls come anywhere else.
+ */
+
+#ifndef RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE
+#define RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE (47 | RETRO_ENVIRONMENT_EXPERIMENTAL)
+#endif
+
+#define LATENCY_FRAMES 120
+//the rom needs a few frames to get to its main loop
+#define LATENCY_WARMUP 10
+#define LATENCY_STROBE_LINE 80
+#define LATENCY_NTSC_LINES 262
+#define LATENCY_NTSC_LINE_NS 63556
+
+static unsigned polls;
+static uint16_t pollLine, pollDot;
+
+static bool environment(unsigned cmd, void *data)
+{
+   switch (cmd)
+   {
+      case RETRO_ENVIRONMENT_SET_PIXEL_FORMAT:
+         return true;
+      case RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE:
+         *(int*)data = 3;
+         return true;
+      default:
+         return false;
+   }
+}
+
+static void video_refresh(const void *data, unsigned width, unsigned height, size_t pitch)
+{
+   (void)data; (void)width; (void)height; (void)pitch;
+}
+
+static void audio_sample(int16_t left, int16_t right)
+{
+   (void)left; (void)right;
+}
+
+static size_t audio_sample_batch(const int16_t *data, size_t frames)
+{
+   (void)data;
+   return frames;
+}
+
+static void input_poll()
+{
+   polls++;
+   pollLine = ppuGetCurLine();
+   pollDot = ppuGetCurDot();
+}
+
+static int16_t input_state(unsigned port, unsigned device, unsigned index, unsigned id)
+{
+   (void)port; (void)device; (void)index; (void)id;
+   return 0;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned frame, bad = 0;
+   uint16_t startLine = 0;
+   if (argc < 2)
+   {
+      printf("Usage: %s input.nes\n", argv[0]);
+      return EXIT_FAILURE;
+   }
+   retro_set_environment(environment);
+   retro_set_video_refresh(video_refresh);
+   retro_set_audio_sample(audio_sample);
+   retro_set_audio_sample_batch(audio_sample_batch);
+   retro_set_input_poll(input_poll);
+   retro_set_input_state(input_state);
+   retro_init();
+   struct retro_game_info info = { argv[1], NULL, 0, NULL };
+   if (!retro_load_game(&info))
+   {
+      printf("Latency: Could not load %s\n", argv[1]);
+      return EXIT_FAILURE;
+   }
+   for (frame = 0; frame < LATENCY_FRAMES; frame++)
+   {
+      startLine = ppuGetCurLine();
+      polls = 0;
+      retro_run();
+      if (frame < LATENCY_WARMUP)
+         continue;
+      if (polls != 1 || pollLine < LATENCY_STROBE_LINE || pollLine > LATENCY_STROBE_LINE+1)
+      {
+         printf("Latency: Frame %u polled %u times, last on scanline %u\n", frame, polls, pollLine);
+         bad++;
+      }
+   }
+   unsigned later = (pollLine + LATENCY_NTSC_LINES - startLine) % LATENCY_NTSC_LINES;
+   printf("Latency: Frames start on scanline %u, the pad got polled on scanline %u dot %u\n",
+      startLine, pollLine, pollDot);
+   printf("Latency: That is %u scanlines (%.1fms) later than polling at the start of the frame\n",
+      later, later * LATENCY_NTSC_LINE_NS / 1000000.0);
+   retro_unload_game();
+   retro_deinit();
+   if (bad)
+   {
+      printf("Latency: %u of %u frames did not poll on the strobe\n", bad, LATENCY_FRAMES - LATENCY_WARMUP);
+      return EXIT_FAILURE;
+   }
+   return EXIT_SUCCESS;
+}
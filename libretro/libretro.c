@@ -20,13 +20,25 @@
 #include "ppu.h"
 #include "mem.h"
 #include "input.h"
-#include "fm2play.h"
 #include "apu.h"
 #include "audio.h"
 #include "audio_fds.h"
 #include "audio_vrc7.h"
 #include "mapper_h/nsf.h"
+#include "state.h"
+#include "cheat.h"
 #include "libretro.h"
+#include "fixnes_mem.h"
+
+#ifndef RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE
+#define RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE (47 | RETRO_ENVIRONMENT_EXPERIMENTAL)
+#endif
+#ifndef RETRO_ENVIRONMENT_SET_SERIALIZATION_QUIRKS
+#define RETRO_ENVIRONMENT_SET_SERIALIZATION_QUIRKS 44
+#define RETRO_SERIALIZATION_QUIRK_SINGLE_SESSION (1 << 4)
+#define RETRO_SERIALIZATION_QUIRK_ENDIAN_DEPENDENT (1 << 5)
+#define RETRO_SERIALIZATION_QUIRK_PLATFORM_DEPENDENT (1 << 6)
+#endif
 
 static retro_log_printf_t log_cb;
 static retro_video_refresh_t video_cb;
@@ -38,6 +50,9 @@ static retro_environment_t environ_cb;
 int nesEmuLoadGame(const char* filename);
 void nesEmuMainLoop(void);
 void nesEmuDeinit(void);
+bool nesEmuSetRunAhead(uint8_t frames);
+bool nesEmuRunAheadFrames(bool draw);
+static bool runAheadActive = false;
 extern uint16_t textureImage[0xF000];
 extern uint8_t inValReads[8];
 static bool inDiskSwitch = false;
@@ -68,12 +83,16 @@ void retro_get_system_av_info(struct retro_system_av_info *info)
    info->timing.sample_rate     = apuGetFrequency();
 }
 
+static void retro_poll_input();
+static void set_memory_maps();
+
 void retro_init(void)
 {
    struct retro_log_callback log;
 
    if (environ_cb(RETRO_ENVIRONMENT_GET_LOG_INTERFACE, &log))
       log_cb = log.log;
+   inputSetPollCallback(retro_poll_input);
 }
 
 void retro_deinit()
@@ -82,7 +101,24 @@ void retro_deinit()
 
 void retro_set_environment(retro_environment_t cb)
 {
+   static const struct retro_variable vars[] =
+   {
+      { "fixnes_runahead", "Run-ahead frames; 0|1|2|3|4" },
+      { NULL, NULL },
+   };
+
    environ_cb = cb;
+   cb(RETRO_ENVIRONMENT_SET_VARIABLES, (void*)vars);
+}
+
+static void check_variables()
+{
+   struct retro_variable var = { "fixnes_runahead", NULL };
+   uint8_t frames = 0;
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+      frames = atoi(var.value);
+   runAheadActive = nesEmuSetRunAhead(frames);
 }
 
 void retro_set_video_refresh(retro_video_refresh_t cb)
@@ -112,29 +148,73 @@ void retro_reset()
       cpuSoftReset();
 }
 
+//states are raw copies with pointers in them, they are only
+//good for rewind and run-ahead while the game stays loaded
+static bool serializeSupported = false;
+
 size_t retro_serialize_size(void)
 {
-   return 0;
+   return serializeSupported ? stateSize() : 0;
 }
 
 bool retro_serialize(void *data, size_t size)
 {
-   return false;
+   if (!serializeSupported || size < stateSize())
+      return false;
+   stateSave(data);
+   return true;
 }
 
 bool retro_unserialize(const void *data, size_t size)
 {
-   return false;
+   if (!serializeSupported || size < stateSize())
+      return false;
+   stateLoad(data);
+   return true;
 }
 void retro_cheat_reset()
 {
+   cheatClear();
 }
 
 void retro_cheat_set(unsigned index, bool enabled, const char *code)
 {
+   char buf[256];
+   char *cur, *next;
+
+   if (!enabled || !code)
+      return;
+   //several codes can come joined with +
+   snprintf(buf, sizeof(buf), "%s", code);
+   for (cur = buf; cur; cur = next)
+   {
+      next = strchr(cur, '+');
+      if (next)
+         *next++ = '\0';
+      if (*cur)
+         cheatAdd(cur);
+   }
 }
 
 
+static int retroAudioUpdate(const uint8_t *data, uint32_t size)
+{
+   const int16_t* buffer_in = (const int16_t*)data;
+   int samples = size / (2 * sizeof(int16_t));
+   while (samples > 512)
+   {
+     audio_batch_cb(buffer_in, 512);
+     buffer_in += 1024;
+     samples -= 512;
+   }
+   if(samples > 0)
+      audio_batch_cb(buffer_in, samples);
+
+   return 1;
+}
+
+static const audioSink_t retroAudioSink = { "libretro", NULL, retroAudioUpdate, NULL };
+
 bool retro_load_game(const struct retro_game_info *info)
 {
    struct retro_input_descriptor desc[] =
@@ -154,6 +234,9 @@ bool retro_load_game(const struct retro_game_info *info)
    if (nesEmuLoadGame(info->path) != EXIT_SUCCESS)
       return false;
 
+   audioSetSink(&retroAudioSink, NULL);
+   audioInit();
+
    environ_cb(RETRO_ENVIRONMENT_SET_INPUT_DESCRIPTORS, desc);
 
    enum retro_pixel_format fmt = RETRO_PIXEL_FORMAT_RGB565;
@@ -165,6 +248,15 @@ bool retro_load_game(const struct retro_game_info *info)
    }
 
    inDiskSwitch = false;
+   check_variables();
+   set_memory_maps();
+
+   //only when the frontend knows to keep them in this session
+   uint64_t quirks = RETRO_SERIALIZATION_QUIRK_SINGLE_SESSION |
+      RETRO_SERIALIZATION_QUIRK_ENDIAN_DEPENDENT | RETRO_SERIALIZATION_QUIRK_PLATFORM_DEPENDENT;
+   serializeSupported = !nesEmuNSFPlayback &&
+      environ_cb(RETRO_ENVIRONMENT_SET_SERIALIZATION_QUIRKS, &quirks) &&
+      (quirks & RETRO_SERIALIZATION_QUIRK_SINGLE_SESSION);
 
    return true;
 }
@@ -179,7 +271,10 @@ bool retro_load_game_special(unsigned game_type, const struct retro_game_info *i
 
 void retro_unload_game()
 {
+   audioDeinit();
    nesEmuDeinit();
+   runAheadActive = false;
+   serializeSupported = false;
 }
 
 unsigned retro_get_region()
@@ -209,6 +304,10 @@ void *retro_get_memory_data(unsigned id)
 			return emuPrgRAM;
       }
 	  break;
+   case RETRO_MEMORY_SYSTEM_RAM:
+      return memGetMainMem();
+   case RETRO_MEMORY_VIDEO_RAM:
+      return ppuGetVRAM();
    default:
       break;
    }
@@ -235,30 +334,129 @@ size_t retro_get_memory_size(unsigned id)
          if(emuSaveEnabled)
             return emuPrgRAMsize;
       }
+      break;
+   case RETRO_MEMORY_SYSTEM_RAM:
+      return 0x800;
+   case RETRO_MEMORY_VIDEO_RAM:
+      return PPU_VRAM_SIZE;
    }
    return 0;
 }
 
-int audioUpdate()
+extern uint8_t *emuPrgROM;
+extern uint32_t emuPrgROMsize;
+static void add_memory_desc(struct retro_memory_descriptor *d, void *ptr, size_t offset,
+      size_t start, size_t select, size_t len, const char *addrspace)
 {
-   uint16_t* buffer_in = (uint16_t*)apuGetBuf();
-   int samples = apuGetBufSize() / (2 * sizeof(uint16_t));
-   while (samples > 512)
+   d->ptr       = ptr;
+   d->offset    = offset;
+   d->start     = start;
+   d->select    = select;
+   d->len       = len;
+   d->addrspace = addrspace;
+}
+
+static void set_memory_maps()
+{
+   static struct retro_memory_descriptor desc[16];
+   struct retro_memory_map map = { desc, 0 };
+   bool isFDS = !nesEmuNSFPlayback && (audioExpansion&EXP_FDS);
+
+   memset(desc, 0, sizeof(desc));
+   //2k mirrored up to $1FFF
+   desc[map.num_descriptors].ptr        = memGetMainMem();
+   desc[map.num_descriptors].start      = 0x0000;
+   desc[map.num_descriptors].select     = 0xE000;
+   desc[map.num_descriptors].disconnect = 0x1800;
+   desc[map.num_descriptors].len        = 0x800;
+   map.num_descriptors++;
+   if(emuPrgRAM != NULL && isFDS)
    {
-     audio_batch_cb(buffer_in, 512);
-     buffer_in += 1024;
-     samples -= 512;
+      //the fds has ram all the way up to $DFFF, in aligned pieces
+      add_memory_desc(&desc[map.num_descriptors++], emuPrgRAM, 0x0000, 0x6000, 0xE000, 0x2000, NULL);
+      add_memory_desc(&desc[map.num_descriptors++], emuPrgRAM, 0x2000, 0x8000, 0xC000, 0x4000, NULL);
+      add_memory_desc(&desc[map.num_descriptors++], emuPrgRAM, 0x6000, 0xC000, 0xE000, 0x2000, NULL);
    }
-   if(samples > 0)
-      audio_batch_cb(buffer_in, samples);
+   else if(emuPrgRAM != NULL)
+   {
+      //first 8k sit at $6000, bigger chips get banked in by the mapper
+      add_memory_desc(&desc[map.num_descriptors++], emuPrgRAM, 0, 0x6000, 0xE000, 0x2000, NULL);
+      //so all of it also goes into its own space, in power of two pieces
+      size_t total = 1, pos = (emuPrgRAMsize > 0x2000) ? 0 : emuPrgRAMsize;
+      while(total < emuPrgRAMsize)
+         total <<= 1;
+      while(pos < emuPrgRAMsize && map.num_descriptors < 14)
+      {
+         size_t chunk = total;
+         while(chunk > emuPrgRAMsize - pos)
+            chunk >>= 1;
+         add_memory_desc(&desc[map.num_descriptors++], emuPrgRAM, pos, pos, (total-1) & ~(chunk-1), chunk, "PRGRAM");
+         pos += chunk;
+      }
+   }
+   //only small roms sit at a fixed place, for all others
+   //the bank switching is up to each mapper
+   if(emuPrgROM != NULL && (emuPrgROMsize == 0x4000 || emuPrgROMsize == 0x8000))
+   {
+      desc[map.num_descriptors].flags      = RETRO_MEMDESC_CONST;
+      desc[map.num_descriptors].ptr        = emuPrgROM;
+      desc[map.num_descriptors].start      = 0x8000;
+      desc[map.num_descriptors].select     = 0x8000;
+      desc[map.num_descriptors].disconnect = 0x8000 - emuPrgROMsize;
+      desc[map.num_descriptors].len        = emuPrgROMsize;
+      map.num_descriptors++;
+   }
+   environ_cb(RETRO_ENVIRONMENT_SET_MEMORY_MAPS, &map);
+}
 
-   return 1;
+void *fixnes_mem_get(unsigned region, size_t *size)
+{
+   void *ptr = NULL;
+   size_t len = 0;
+
+   switch(region)
+   {
+   case FIXNES_MEM_RAM:
+      ptr = memGetMainMem();
+      len = 0x800;
+      break;
+   case FIXNES_MEM_VRAM:
+      ptr = ppuGetVRAM();
+      len = PPU_VRAM_SIZE;
+      break;
+   case FIXNES_MEM_OAM:
+      ptr = ppuGetOAM();
+      len = PPU_OAM_SIZE;
+      break;
+   case FIXNES_MEM_PALETTE:
+      ptr = ppuGetPALRAM();
+      len = PPU_PALRAM_SIZE;
+      break;
+   case FIXNES_MEM_PRG_RAM:
+      ptr = emuPrgRAM;
+      len = emuPrgRAMsize;
+      break;
+   case FIXNES_MEM_PRG_ROM:
+      ptr = emuPrgROM;
+      len = emuPrgROMsize;
+      break;
+   default:
+      break;
+   }
+   if(ptr == NULL)
+      len = 0;
+   if(size)
+      *size = len;
+   return ptr;
 }
 
 static char disksysPath[4096];
 FILE *doOpenFDSBIOS()
 {
    const char *dir = NULL;
+   //no frontend when used through fixnes_env
+   if(!environ_cb)
+      return NULL;
    if(!environ_cb(RETRO_ENVIRONMENT_GET_SYSTEM_DIRECTORY, &dir) || !dir)
       return NULL;
    snprintf(disksysPath, sizeof(disksysPath), "%s/disksys.rom", dir);
@@ -267,7 +465,8 @@ FILE *doOpenFDSBIOS()
 }
 
 extern bool fdsSwitch;
-void retro_run()
+//runs from inside the frame on the first controller strobe
+static void retro_poll_input()
 {
    input_poll_cb();
 
@@ -290,8 +489,27 @@ void retro_run()
    }
    else
       inDiskSwitch = false;
+}
 
+void retro_run()
+{
+   //frontend may run frames it never shows (run-ahead, fast-forward)
+   int avEnable = 3;
+   if(!environ_cb(RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE, &avEnable))
+      avEnable = 3;
+   bool updated = false;
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE, &updated) && updated)
+      check_variables();
+
+   //with run-ahead the real frame never gets shown
+   ppuSkipRender = !(avEnable & 1) || runAheadActive;
+
+   //input gets read as late as possible, see retro_poll_input
+   inputStartFrame();
    nesEmuMainLoop();
+   inputEndFrame();
+
+   nesEmuRunAheadFrames(avEnable & 1);
 
    video_cb(textureImage, VISIBLE_DOTS, VISIBLE_LINES, VISIBLE_DOTS * 2);
    apuUpdate();
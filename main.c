@@ -23,15 +23,37 @@
 #include "ppu.h"
 #include "mem.h"
 #include "input.h"
-#include "fm2play.h"
+#include "movie.h"
 #include "apu.h"
+#include "state.h"
+#include "cheat.h"
+#include "dbg.h"
+#include "trace.h"
+#include "prof.h"
+#include "stats.h"
+#include "hash.h"
 #include "audio.h"
+#include "pacer.h"
+#include "capture.h"
+#include "telemetry.h"
+#include "testrom.h"
+#include "bench.h"
+#include "rominfo.h"
+#ifndef __LIBRETRO__
+#include "romindex.h"
+#include "rewind.h"
+#endif
 #include "audio_fds.h"
 #include "audio_vrc7.h"
 #include "mapper_h/nsf.h"
 #if ZIPSUPPORT
 #include "unzip/unzip.h"
 #endif
+#if !defined(_WIN32) && (defined(__unix__) || defined(__APPLE__))
+#define ROM_MMAP 1
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 #define DEBUG_HZ 0
 #define DEBUG_MAIN_CALLS 0
 #define DEBUG_KEY 0
@@ -55,6 +77,8 @@ enum {
 static void nesEmuFileOpen(const char *name);
 static bool nesEmuFileRead();
 static void nesEmuFileClose();
+static void nesEmuSetROMBase(uint8_t *base, size_t size, bool mapped);
+static void nesEmuFreeROM();
 
 static void nesEmuDisplayFrame(void);
 void nesEmuMainLoop(void);
@@ -72,11 +96,18 @@ static int emuFileType = FTYPE_UNK;
 static char emuFileName[1024];
 uint8_t *emuNesROM = NULL;
 uint32_t emuNesROMsize = 0;
+//heap block or private file mapping emuNesROM points into
+static uint8_t *emuROMBase = NULL;
+static size_t emuROMBaseSize = 0;
+static bool emuROMMapped = false;
 #ifndef __LIBRETRO__
 static char emuSaveName[1024];
 #endif
 uint8_t *emuPrgRAM = NULL;
 uint32_t emuPrgRAMsize = 0;
+//points into emuNesROM, only set for .nes files
+uint8_t *emuPrgROM = NULL;
+uint32_t emuPrgROMsize = 0;
 //used externally
 uint16_t textureImage[0xF000];
 bool nesPause = false;
@@ -84,6 +115,20 @@ bool ppuDebugPauseFrame = false;
 bool doOverscan = true;
 bool nesPAL = false;
 bool nesEmuNSFPlayback = false;
+#if ZIPSUPPORT
+//name or index of the file to load from a zip,
+//NULL picks the first usable one
+static const char *emuZipEntry = NULL;
+//set from the rom index, skips searching the zip
+static unz_file_pos emuZipPos;
+static bool emuZipUsePos = false;
+#endif
+//region forced by the rom index, -1 if unknown
+static int emuRegion = -1;
+//frames emulated ahead of the displayed one to hide input lag
+uint8_t emuRunAhead = 0;
+static uint8_t *emuRunAheadState = NULL;
+bool nesEmuSetRunAhead(uint8_t frames);
 
 #ifndef __LIBRETRO__
 static bool inPause = false;
@@ -91,6 +136,54 @@ static bool inOverscanToggle = false;
 static bool inResize = false;
 static bool inDiskSwitch = false;
 static bool inReset = false;
+static bool inTurbo = false;
+static bool inRewind = false;
+
+//fast-forward speeds cycled through with T, 0 is uncapped
+static const uint8_t emuTurboSpeeds[] = { 1, 2, 4, 8, 0 };
+#define EMU_TURBO_SPEEDS (sizeof(emuTurboSpeeds)/sizeof(emuTurboSpeeds[0]))
+//frames emulated per displayed frame when uncapped
+#define EMU_TURBO_UNCAPPED_FRAMES 16
+//more than that costs too much per frame
+#define EMU_RUNAHEAD_MAX 4
+//rewind ring in kb, keeps the byte size well inside 32 bits
+#define EMU_REWIND_MAX_KB (1024*1024)
+static uint8_t emuTurboSel = 0;
+static uint8_t emuTurboFrame = 0;
+static bool emuTurboMute = false;
+static int emuAudioBuffers = NUM_BUFFERS;
+static int emuAudioPeriod = 0;
+static const char *emuCapturePath = NULL;
+static const char *emuCaptureAudioPath = NULL;
+static int emuCaptureFormat = -1;
+static const char *emuIndexPath = NULL;
+static const char *emuMoviePath = NULL;
+static bool emuMovieRecord = false;
+#define EMU_MAX_CHEATS 16
+static const char *emuCheats[EMU_MAX_CHEATS];
+static int emuCheatNum = 0;
+static bool emuDebug = false;
+static const char *emuTracePath = NULL;
+static uint32_t emuTraceRing = 0;
+static const char *emuProfPath = NULL;
+static bool emuStats = false;
+static const char *emuTelemetry = NULL;
+static const char *emuHashPath = NULL;
+static uint32_t emuTestFrames = 0;
+static const char *emuTestHash = NULL;
+//rewind ring size in KB, 0 is off
+static uint32_t emuRewindSize = 0;
+static uint8_t emuRewindInterval = 1;
+//prg+chr crc32 of the loaded game, 0 if not a .nes
+static uint32_t emuRomCrc = 0;
+static void nesEmuSetTurbo(uint8_t sel);
+static bool nesEmuRunFrame();
+#ifndef __LIBRETRO__
+static bool nesEmuTestFrame();
+#endif
+static bool nesEmuParseArgs(int argc, char** argv);
+static void nesEmuStartCapture();
+static void nesEmuIndexOpen(const char *key);
 
 #if WINDOWS_BUILD
 #include <windows.h>
@@ -141,6 +234,10 @@ int main(int argc, char** argv)
 {
 #endif
 	puts(VERSION_STRING);
+	//all modules register their state again on init
+	stateClear();
+	cheatClear();
+	dbgClear();
 	strcpy(window_title, VERSION_STRING);
 	memset(textureImage,0,visibleImg);
 	emuFileType = FTYPE_UNK;
@@ -153,9 +250,97 @@ int main(int argc, char** argv)
 	doOverscan = true;
 	nesPAL = false;
 	nesEmuNSFPlayback = false;
+	ppuSkipRender = false;
 	memset(emuFileName,0,1024);
 #ifndef __LIBRETRO__
 	memset(emuSaveName,0,1024);
+#endif
+#if ZIPSUPPORT
+	emuZipEntry = NULL;
+	emuZipUsePos = false;
+#endif
+	emuRegion = -1;
+#ifndef __LIBRETRO__
+	emuTurboSel = 0;
+	emuTurboFrame = 0;
+	emuTurboMute = false;
+	emuAudioBuffers = NUM_BUFFERS;
+	emuAudioPeriod = 0;
+	emuCapturePath = NULL;
+	emuCaptureAudioPath = NULL;
+	emuCaptureFormat = -1;
+	emuIndexPath = NULL;
+	emuMoviePath = NULL;
+	emuMovieRecord = false;
+	emuRomCrc = 0;
+	if(argc >= 2 && strcmp(argv[1],"--movie-convert") == 0)
+	{
+		if(argc != 4)
+		{
+			printf("Usage: %s --movie-convert <in.fm2|in.fxm> <out.fxm|out.fm2>\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+		return movieConvert(argv[2], argv[3]) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	if(argc >= 2 && strcmp(argv[1],"--trace-print") == 0)
+	{
+		if(argc != 3)
+		{
+			printf("Usage: %s --trace-print <file>\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+		return tracePrint(argv[2]) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	if(argc >= 2 && strcmp(argv[1],"--trace-diff") == 0)
+	{
+		if(argc != 4)
+		{
+			printf("Usage: %s --trace-diff <file a> <file b>\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+		return traceDiff(argv[2], argv[3]) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	if(argc >= 2 && strcmp(argv[1],"--hash-diff") == 0)
+	{
+		if(argc != 4)
+		{
+			printf("Usage: %s --hash-diff <file a> <file b>\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+		return hashDiff(argv[2], argv[3]) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	if(argc >= 2 && strcmp(argv[1],"--test-suite") == 0)
+	{
+		if(argc != 3 && argc != 4)
+		{
+			printf("Usage: %s --test-suite <list> [jobs]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+		return testRomSuite(argv[0], argv[2], argc == 4 ? atoi(argv[3]) : 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	if(argc >= 2 && strcmp(argv[1],"--bench") == 0)
+	{
+		if(argc != 3 && argc != 4)
+		{
+			printf("Usage: %s --bench <cpu|ppu|apu|all> [runs]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+		return benchRun(argv[2], argc == 4 ? atoi(argv[3]) : 10) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	if(argc >= 2 && strcmp(argv[1],"--index-build") == 0)
+	{
+		if(argc != 4)
+		{
+			printf("Usage: %s --index-build <rom folder> <index file>\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+		return romIndexBuild(argv[2], argv[3]) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	if(!nesEmuParseArgs(argc, argv))
+		return EXIT_FAILURE;
+	if(argc >= 2 && emuIndexPath)
+		nesEmuIndexOpen(argv[1]);
+	else
 #endif
 	if(argc >= 2)
 		nesEmuFileOpen(argv[1]);
@@ -170,28 +355,55 @@ int main(int argc, char** argv)
 			return EXIT_FAILURE;
 		}
 		nesEmuFileClose();
-		nesPAL = (strstr(emuFileName,"(E)") != NULL) || (strstr(emuFileName,"(Europe)") != NULL) || (strstr(emuFileName,"(Australia)") != NULL)
-			|| (strstr(emuFileName,"(France)") != NULL) || (strstr(emuFileName,"(Germany)") != NULL) || (strstr(emuFileName,"(Italy)") != NULL)
-			|| (strstr(emuFileName,"(Spain)") != NULL) || (strstr(emuFileName,"(Sweden)") != NULL);
-		uint8_t mapper = ((emuNesROM[6] & 0xF0) >> 4) | ((emuNesROM[7] & 0xF0));
+		romInfo_t romInfo;
+		if(!romInfoParseNES(emuNesROM, emuNesROMsize, emuFileName, &romInfo))
+		{
+			printf("Main: %s has no iNES header!\n", emuFileName);
+			nesEmuFreeROM();
+			puts("Press enter to exit");
+			getc(stdin);
+			return EXIT_FAILURE;
+		}
+		if(romInfo.dbMatch)
+			printf("GameDB: Found CRC %08X\n", romInfo.crc);
+#ifndef __LIBRETRO__
+		emuRomCrc = romInfo.crc;
+#endif
+		//the index may know better than the file name
+		if(!romInfo.exact && emuRegion >= 0)
+			romInfo.region = emuRegion;
+		nesPAL = (romInfo.region == ROM_REGION_PAL);
+		if(romInfo.mapper > 0xFF)
+		{
+			printf("Unsupported Mapper %i!\n", romInfo.mapper);
+			nesEmuFreeROM();
+			puts("Press enter to exit");
+			getc(stdin);
+			return EXIT_FAILURE;
+		}
+		uint8_t mapper = romInfo.mapper;
 		emuSaveEnabled = (emuNesROM[6] & (1<<1)) != 0;
 		bool trainer = (emuNesROM[6] & (1<<2)) != 0;
-		uint32_t prgROMsize = emuNesROM[4] * 0x4000;
-		uint32_t chrROMsize = emuNesROM[5] * 0x2000;
+		uint32_t prgROMsize = romInfo.prgSize;
+		uint32_t chrROMsize = romInfo.chrSize;
 		if(mapper == 5) //just to be on the safe side
 			emuPrgRAMsize = 0x10000;
 		else
 		{
-			emuPrgRAMsize = emuNesROM[8] * 0x2000;
-			if(emuPrgRAMsize == 0) emuPrgRAMsize = 0x2000;
+			emuPrgRAMsize = romInfo.prgRamSize;
+			//mappers expect at least the usual 8k
+			if(emuPrgRAMsize < 0x2000) emuPrgRAMsize = 0x2000;
 		}
 		emuPrgRAM = malloc(emuPrgRAMsize);
+		stateAdd(emuPrgRAM, emuPrgRAMsize);
 		uint8_t *prgROM = emuNesROM+16;
 		if(trainer)
 		{
 			memcpy(emuPrgRAM+0x1000,prgROM,0x200);
 			prgROM += 512;
 		}
+		emuPrgROM = prgROM;
+		emuPrgROMsize = prgROMsize;
 		uint8_t *chrROM = NULL;
 		if(chrROMsize)
 		{
@@ -214,24 +426,26 @@ int main(int argc, char** argv)
 		printf("Used Mapper: %i\n", mapper);
 		printf("PRG: 0x%x bytes PRG RAM: 0x%x bytes CHR: 0x%x bytes\n", prgROMsize, emuPrgRAMsize, chrROMsize);
 		#endif
+		//submapper 32.1 and 78.3, old headers without a game database
+		//match can only go by name
 		if(mapper == 32)
 		{
-			if(strstr(emuFileName,"Major League") != NULL)
-				m32_singlescreen = true;
+			if(romInfo.exact)
+				m32_singlescreen = (romInfo.submapper == 1);
 			else
-				m32_singlescreen = false;
+				m32_singlescreen = (strstr(emuFileName,"Major League") != NULL);
 		}
 		if(mapper == 78)
 		{
-			if(strstr(emuFileName,"Holy Diver") != NULL)
-				mapperUse78A = true;
+			if(romInfo.exact)
+				mapperUse78A = (romInfo.submapper == 3);
 			else
-				mapperUse78A = false;
+				mapperUse78A = (strstr(emuFileName,"Holy Diver") != NULL);
 		}
 		if(!mapperInit(mapper, prgROM, prgROMsize, emuPrgRAM, emuPrgRAMsize, chrROM, chrROMsize))
 		{
 			printf("Mapper init failed!\n");
-			free(emuNesROM);
+			nesEmuFreeROM();
 			puts("Press enter to exit");
 			getc(stdin);
 			return EXIT_FAILURE;
@@ -255,10 +469,6 @@ int main(int argc, char** argv)
 			}
 		}
 #endif
-		#if 0
-		if(argc == 5 && (strstr(argv[2],".fm2") != NULL || strstr(argv[2],".FM2") != NULL))
-			fm2playInit(argv[2], atoi(argv[3]), !!atoi(argv[4]));
-		#endif
 	}
 	else if(emuFileType == FTYPE_NSF)
 	{
@@ -273,10 +483,11 @@ int main(int argc, char** argv)
 		nesEmuFileClose();
 		emuPrgRAMsize = 0x2000;
 		emuPrgRAM = malloc(emuPrgRAMsize);
+		stateAdd(emuPrgRAM, emuPrgRAMsize);
 		if(!mapperInitNSF(emuNesROM, emuNesROMsize, emuPrgRAM, emuPrgRAMsize))
 		{
 			printf("NSF init failed!\n");
-			free(emuNesROM);
+			nesEmuFreeROM();
 			puts("Press enter to exit");
 			getc(stdin);
 			return EXIT_FAILURE;
@@ -304,7 +515,9 @@ int main(int argc, char** argv)
 			size_t saveSize = ftell(save);
 			if(saveSize == 0x10000 || saveSize == 0x20000)
 			{
+				//read, not mapped, since this file gets rewritten on exit
 				emuNesROM = malloc(saveSize);
+				nesEmuSetROMBase(emuNesROM, saveSize, false);
 				rewind(save);
 				fread(emuNesROM,1,saveSize,save);
 				saveValid = true;
@@ -349,51 +562,64 @@ int main(int argc, char** argv)
 							&& fds_src[0x3A] != 0x02 && fds_src[0x3E] != 0x03);
 			if(fds_no_crc)
 			{
+				uint8_t *fdsDisk = NULL;
 				if(fds_src_len == 0x1FFB8)
 				{
 					emuFdsHasSideB = true;
 					emuNesROMsize = 0x20000;
-					emuNesROM = malloc(emuNesROMsize);
-					memset(emuNesROM, 0, emuNesROMsize);
-					nesEmuFdsSetup(fds_src, emuNesROM); //setup individually
-					nesEmuFdsSetup(fds_src+0xFFDC, emuNesROM+0x10000);
+					fdsDisk = malloc(emuNesROMsize);
+					memset(fdsDisk, 0, emuNesROMsize);
+					nesEmuFdsSetup(fds_src, fdsDisk); //setup individually
+					nesEmuFdsSetup(fds_src+0xFFDC, fdsDisk+0x10000);
 				}
 				else if(fds_src_len == 0xFFDC)
 				{
 					emuFdsHasSideB = false;
 					emuNesROMsize = 0x10000;
-					emuNesROM = malloc(emuNesROMsize);
-					memset(emuNesROM, 0, emuNesROMsize);
-					nesEmuFdsSetup(fds_src, emuNesROM);
+					fdsDisk = malloc(emuNesROMsize);
+					memset(fdsDisk, 0, emuNesROMsize);
+					nesEmuFdsSetup(fds_src, fdsDisk);
 				}
 				else
 					printf("Unknown FDS Length: %x\n", fds_src_len);
+				//rebuilt disk replaces the file data
+				nesEmuFreeROM();
+				if(fdsDisk)
+				{
+					emuNesROM = fdsDisk;
+					nesEmuSetROMBase(fdsDisk, emuNesROMsize, false);
+				}
 			}
 			else
 			{
+				//disk writes go straight into the file data, if that
+				//is mapped they stay private to this process
 				if(fds_src_len == 0x20000)
 				{
 					emuFdsHasSideB = true;
 					emuNesROMsize = 0x20000;
-					emuNesROM = malloc(emuNesROMsize);
-					memcpy(emuNesROM, fds_src, emuNesROMsize);
+					emuNesROM = fds_src;
 				}
 				else if(fds_src_len == 0x10000)
 				{
 					emuFdsHasSideB = false;
 					emuNesROMsize = 0x10000;
-					emuNesROM = malloc(emuNesROMsize);
-					memcpy(emuNesROM, fds_src, emuNesROMsize);
+					emuNesROM = fds_src;
 				}
 				else
+				{
 					printf("Unknown FDS Length: %x\n", fds_src_len);
+					nesEmuFreeROM();
+				}
 			}
-			free(nesFread);
 		}
 		if(emuNesROM != NULL)
 		{
 			emuPrgRAMsize = 0x8000;
 			emuPrgRAM = malloc(emuPrgRAMsize);
+			stateAdd(emuPrgRAM, emuPrgRAMsize);
+			//disk writes are machine state too
+			stateAdd(emuNesROM, emuNesROMsize);
 			apuInitBufs();
 			cpuInit();
 			ppuInit();
@@ -403,7 +629,7 @@ int main(int argc, char** argv)
 			if(!mapperInitFDS(emuNesROM, emuFdsHasSideB, emuPrgRAM, emuPrgRAMsize))
 			{
 				printf("FDS init failed!\n");
-				free(emuNesROM);
+				nesEmuFreeROM();
 				puts("Press enter to exit");
 				getc(stdin);
 				return EXIT_FAILURE;
@@ -431,6 +657,7 @@ int main(int argc, char** argv)
 	emuMainFrameStart = GetTickCount();
 	#endif
 	#endif
+	nesEmuSetRunAhead(emuRunAhead);
 	cpuCycleTimer = nesPAL ? 16 : 12;
 	vrc7CycleTimer = 432 / cpuCycleTimer;
 	//do one scanline per idle loop
@@ -438,11 +665,60 @@ int main(int argc, char** argv)
 	//mainLoopRuns = nesPAL ? DOTS*ppuCycleTimer : DOTS*ppuCycleTimer;
 	//mainLoopPos = mainLoopRuns;
 #ifndef __LIBRETRO__
+	int i;
+	for(i = 0; i < emuCheatNum; i++)
+		cheatAdd(emuCheats[i]);
+	//frames run ahead would show up twice in the trace
+	if(emuTracePath && traceStart(emuTracePath, emuTraceRing))
+		nesEmuSetRunAhead(0);
+	if(emuProfPath && profStart(emuProfPath))
+		nesEmuSetRunAhead(0);
+	//frames run ahead would not get hashed
+	if(emuHashPath && hashStart(emuHashPath))
+		nesEmuSetRunAhead(0);
+	if(emuMoviePath)
+	{
+		if(emuMovieRecord)
+			movieRecord(emuMoviePath, emuRomCrc);
+		else
+			moviePlay(emuMoviePath, emuRomCrc);
+	}
+	//no window or audio, just a result for the test suite
+	if(emuTestFrames)
+	{
+		if(emuCapturePath || emuDebug)
+			printf("Main: --capture and --debug need a window, not used with --test\n");
+		//nothing plays the audio, so do not even mix it
+		apuSkipOutput = true;
+		int ret = testRomRun(nesEmuTestFrame, emuTestFrames, emuTestHash);
+		movieStop();
+		traceStop();
+		profStop();
+		hashStop();
+		return ret;
+	}
 	glutInit(&argc, argv);
 	glutInitWindowSize(VISIBLE_DOTS*scaleFactor, linesToDraw*scaleFactor);
 	glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGBA);
 	glutCreateWindow(nesPause ? window_title_pause : window_title);
 	audioInit();
+	pacerInit(nesPAL ? 50.0070 : 60.0988);
+	nesEmuSetTurbo(emuTurboSel);
+	if(emuCapturePath)
+		nesEmuStartCapture();
+	if(emuDebug)
+	{
+		//traps would also hit in the frames run ahead
+		nesEmuSetRunAhead(0);
+		dbgBreak();
+	}
+	if(emuStats)
+		statsStart();
+	if(emuTelemetry)
+		telemetryStart(emuTelemetry);
+	//going back would break the movie timeline
+	if(emuRewindSize && !emuMoviePath && !nesEmuNSFPlayback)
+		rewindInit(emuRewindSize*1024, emuRewindInterval);
 	atexit(&nesEmuDeinit);
 	glutKeyboardFunc(&nesEmuHandleKeyDown);
 	glutKeyboardUpFunc(&nesEmuHandleKeyUp);
@@ -451,9 +727,9 @@ int main(int argc, char** argv)
 	glutDisplayFunc(&nesEmuDisplayFrame);
 	glutIdleFunc(&nesEmuMainLoop);
 	#if WINDOWS_BUILD
-	/* Enable OpenGL VSync */
+	/* Disable OpenGL VSync, frame pacer handles timing */
 	wglSwapIntervalEXT = (PFNWGLSWAPINTERVALEXTPROC)wglGetProcAddress("wglSwapIntervalEXT");
-	nesEmuSetWindowsVSync(1);
+	nesEmuSetWindowsVSync(0);
 	#endif
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, VISIBLE_DOTS, linesToDraw, 0, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, textureImage);
@@ -472,8 +748,6 @@ int main(int argc, char** argv)
 static FILE *nesEmuFilePointer = NULL;
 #if ZIPSUPPORT
 static bool nesEmuFileIsZip = false;
-static uint8_t *nesEmuZipBuf = NULL;
-static uint32_t nesEmuZipLen = 0;
 static unzFile nesEmuZipObj;
 static unz_file_info nesEmuZipObjInfo;
 #endif
@@ -501,6 +775,66 @@ static int nesEmuGetFileType(const char *name)
 	return FTYPE_UNK;
 }
 
+#if ZIPSUPPORT
+//moves to the requested entry, or the first one fixNES can load
+static bool nesEmuZipSelect(const char *entry, char *zName, uLong zNameSize)
+{
+	int err;
+	if(emuZipUsePos)
+	{
+		err = unzGoToFilePos(nesEmuZipObj, &emuZipPos);
+		if(err == UNZ_OK)
+			err = unzGetCurrentFileInfo(nesEmuZipObj,&nesEmuZipObjInfo,zName,zNameSize,NULL,0,NULL,0);
+		if(err == UNZ_OK)
+			return true;
+		printf("Main: Indexed ZIP entry not found, rebuild the index\n");
+		return false;
+	}
+	if(entry && *entry)
+	{
+		const char *c = entry;
+		while(*c >= '0' && *c <= '9')
+			c++;
+		if(*c == '\0') //all digits, index into the archive
+		{
+			long idx = atol(entry);
+			err = unzGoToFirstFile(nesEmuZipObj);
+			while(err == UNZ_OK && idx--)
+				err = unzGoToNextFile(nesEmuZipObj);
+		}
+		else
+			err = unzLocateFile(nesEmuZipObj, entry, 0);
+		if(err == UNZ_OK)
+			err = unzGetCurrentFileInfo(nesEmuZipObj,&nesEmuZipObjInfo,zName,zNameSize,NULL,0,NULL,0);
+		if(err != UNZ_OK)
+		{
+			printf("Main: No entry %s in ZIP\n", entry);
+			return false;
+		}
+		if(nesEmuGetFileType(zName) == FTYPE_ZIP || nesEmuGetFileType(zName) == FTYPE_UNK)
+		{
+			printf("Main: ZIP entry %s is no .nes/.nsf/.fds/.qd File\n", zName);
+			return false;
+		}
+		return true;
+	}
+	//only walks the central directory, no entry data gets read
+	err = unzGoToFirstFile(nesEmuZipObj);
+	while(err == UNZ_OK)
+	{
+		err = unzGetCurrentFileInfo(nesEmuZipObj,&nesEmuZipObjInfo,zName,zNameSize,NULL,0,NULL,0);
+		if(err != UNZ_OK)
+			break;
+		int curInZipType = nesEmuGetFileType(zName);
+		if(curInZipType != FTYPE_ZIP && curInZipType != FTYPE_UNK)
+			return true;
+		err = unzGoToNextFile(nesEmuZipObj);
+	}
+	printf("Found no usable file in ZIP\n");
+	return false;
+}
+#endif
+
 static void nesEmuFileOpen(const char *name)
 {
 	emuFileType = FTYPE_UNK;
@@ -510,74 +844,55 @@ static void nesEmuFileOpen(const char *name)
 #endif
 	int baseType = nesEmuGetFileType(name);
 #if ZIPSUPPORT
+	//game.zip#entry picks a file in the archive by name or index
+	char zipPath[1024];
+	const char *zipEntry = emuZipEntry;
+	const char *entrySep = strrchr(name, '#');
+	if(entrySep && (size_t)(entrySep-name) < sizeof(zipPath))
+	{
+		memcpy(zipPath, name, entrySep-name);
+		zipPath[entrySep-name] = '\0';
+		if(nesEmuGetFileType(zipPath) == FTYPE_ZIP)
+		{
+			baseType = FTYPE_ZIP;
+			zipEntry = entrySep+1;
+			name = zipPath;
+		}
+	}
 	if(baseType == FTYPE_ZIP)
 	{
 		printf("Base ZIP File: %s\n", name);
-		FILE *tmp = fopen(name,"rb");
-		if(!tmp)
+		nesEmuZipObj = unzOpen(name);
+		if(!nesEmuZipObj)
 		{
 			printf("Main: Could not open %s!\n", name);
 			return;
 		}
-		fseek(tmp,0,SEEK_END);
-		nesEmuZipLen = ftell(tmp);
-		rewind(tmp);
-		nesEmuZipBuf = malloc(nesEmuZipLen);
-		if(!nesEmuZipBuf)
-		{
-			printf("Main: Could not allocate ZIP buffer!\n");
-			fclose(tmp);
-			return;
-		}
-		fread(nesEmuZipBuf,1,nesEmuZipLen,tmp);
-		fclose(tmp);
-		char filepath[20];
-		snprintf(filepath,20,"%x+%x",(unsigned int)nesEmuZipBuf,nesEmuZipLen);
-		nesEmuZipObj = unzOpen(filepath);
-		int err = unzGoToFirstFile(nesEmuZipObj);
-		while (err == UNZ_OK)
+		char tmpName[256];
+		if(nesEmuZipSelect(zipEntry, tmpName, sizeof(tmpName)))
 		{
-			char tmpName[256];
-			err = unzGetCurrentFileInfo(nesEmuZipObj,&nesEmuZipObjInfo,tmpName,256,NULL,0,NULL,0);
-			if(err == UNZ_OK)
+			emuFileType = nesEmuGetFileType(tmpName);
+			nesEmuFileIsZip = true;
+			if(strchr(name,'/') != NULL || strchr(name,'\\') != NULL)
 			{
-				int curInZipType = nesEmuGetFileType(tmpName);
-				if(curInZipType != FTYPE_ZIP && curInZipType != FTYPE_UNK)
-				{
-					emuFileType = curInZipType;
-					nesEmuFileIsZip = true;
-					if(strchr(name,'/') != NULL || strchr(name,'\\') != NULL)
-					{
-						const char *nPath = name;
-						if(strchr(nPath,'/') != NULL)
-							nPath = (strrchr(nPath,'/')+1);
-						if(strchr(nPath,'\\') != NULL)
-							nPath = (strrchr(nPath,'\\')+1);
-						strncpy(emuFileName, name, nPath-name);
-					}
-					const char *zName = tmpName;
-					if(strchr(zName,'/') != NULL)
-						zName = (strrchr(zName,'/')+1);
-					if(strchr(zName,'\\') != NULL)
-						zName = (strrchr(zName,'\\')+1);
-					strcat(emuFileName, zName);
-					printf("File in ZIP Type: %s\n", emuFileType == FTYPE_NES ? "NES" : (emuFileType == FTYPE_NSF ? "NSF" : "FDS"));
-					printf("Full Path from ZIP: %s\n", emuFileName);
-					break;
-				}
-				else
-					err = unzGoToNextFile(nesEmuZipObj);
+				const char *nPath = name;
+				if(strchr(nPath,'/') != NULL)
+					nPath = (strrchr(nPath,'/')+1);
+				if(strchr(nPath,'\\') != NULL)
+					nPath = (strrchr(nPath,'\\')+1);
+				strncpy(emuFileName, name, nPath-name);
 			}
+			const char *zName = tmpName;
+			if(strchr(zName,'/') != NULL)
+				zName = (strrchr(zName,'/')+1);
+			if(strchr(zName,'\\') != NULL)
+				zName = (strrchr(zName,'\\')+1);
+			strcat(emuFileName, zName);
+			printf("File in ZIP Type: %s\n", emuFileType == FTYPE_NES ? "NES" : (emuFileType == FTYPE_NSF ? "NSF" : "FDS"));
+			printf("Full Path from ZIP: %s\n", emuFileName);
 		}
-		if(emuFileType == FTYPE_UNK)
-		{
-			printf("Found no usable file in ZIP\n");
+		else
 			unzClose(nesEmuZipObj);
-			if(nesEmuZipBuf)
-				free(nesEmuZipBuf);
-			nesEmuZipBuf = NULL;
-			nesEmuZipLen = 0;
-		}
 	}
 	else if(baseType != FTYPE_UNK)
 #else
@@ -602,22 +917,63 @@ static bool nesEmuFileRead()
 #if ZIPSUPPORT
 	if(nesEmuFileIsZip)
 	{
-		unzOpenCurrentFile(nesEmuZipObj);
+		//zip64 entries can be past 4GB, no rom comes close
+		if(nesEmuZipObjInfo.uncompressed_size > UINT32_MAX)
+		{
+			printf("Main: ZIP entry is too big!\n");
+			return false;
+		}
+		if(unzOpenCurrentFile(nesEmuZipObj) != UNZ_OK)
+			return false;
+		//inflates straight into the final rom buffer
 		emuNesROMsize = nesEmuZipObjInfo.uncompressed_size;
 		emuNesROM = malloc(emuNesROMsize);
 		if(emuNesROM)
-			unzReadCurrentFile(nesEmuZipObj,emuNesROM,emuNesROMsize);
+		{
+			nesEmuSetROMBase(emuNesROM, emuNesROMsize, false);
+			int zRead = unzReadCurrentFile(nesEmuZipObj,emuNesROM,emuNesROMsize);
+			//also checks the crc once all got read
+			if(unzCloseCurrentFile(nesEmuZipObj) != UNZ_OK || zRead != (int)emuNesROMsize)
+			{
+				printf("Main: ZIP entry is damaged!\n");
+				nesEmuFreeROM();
+				emuNesROM = NULL;
+				return false;
+			}
+			return true;
+		}
 		unzCloseCurrentFile(nesEmuZipObj);
 	}
 	else
 #endif
 	{
+#if ROM_MMAP
+		//a private mapping shares the page cache copy of the file,
+		//only FDS disks get written to and those writes stay local
+		struct stat st;
+		int fd = fileno(nesEmuFilePointer);
+		if(fstat(fd, &st) == 0 && st.st_size > 0)
+		{
+			bool isFDS = (emuFileType == FTYPE_FDS || emuFileType == FTYPE_QD);
+			void *map = mmap(NULL, st.st_size, isFDS ? (PROT_READ|PROT_WRITE) : PROT_READ, MAP_PRIVATE, fd, 0);
+			if(map != MAP_FAILED)
+			{
+				emuNesROM = map;
+				emuNesROMsize = st.st_size;
+				nesEmuSetROMBase(emuNesROM, emuNesROMsize, true);
+				return true;
+			}
+		}
+#endif
 		fseek(nesEmuFilePointer,0,SEEK_END);
 		emuNesROMsize = ftell(nesEmuFilePointer);
 		rewind(nesEmuFilePointer);
 		emuNesROM = malloc(emuNesROMsize);
 		if(emuNesROM)
+		{
+			nesEmuSetROMBase(emuNesROM, emuNesROMsize, false);
 			fread(emuNesROM,1,emuNesROMsize,nesEmuFilePointer);
+		}
 	}
 	if(emuNesROM)
 		return true;
@@ -626,6 +982,30 @@ static bool nesEmuFileRead()
 	return false;
 }
 
+static void nesEmuSetROMBase(uint8_t *base, size_t size, bool mapped)
+{
+	emuROMBase = base;
+	emuROMBaseSize = size;
+	emuROMMapped = mapped;
+}
+
+//releases whatever emuNesROM points into
+static void nesEmuFreeROM()
+{
+	if(emuROMBase)
+	{
+#if ROM_MMAP
+		if(emuROMMapped)
+			munmap(emuROMBase, emuROMBaseSize);
+		else
+#endif
+			free(emuROMBase);
+	}
+	emuROMBase = NULL;
+	emuROMBaseSize = 0;
+	emuROMMapped = false;
+}
+
 //cleans up vars from read
 static void nesEmuFileClose()
 {
@@ -633,10 +1013,6 @@ static void nesEmuFileClose()
 	if(nesEmuFileIsZip)
 		unzClose(nesEmuZipObj);
 	nesEmuFileIsZip = false;
-	if(nesEmuZipBuf)
-		free(nesEmuZipBuf);
-	nesEmuZipBuf = NULL;
-	nesEmuZipLen = 0;
 #endif
 	if(nesEmuFilePointer)
 		fclose(nesEmuFilePointer);
@@ -645,6 +1021,7 @@ static void nesEmuFileClose()
 
 #ifndef __LIBRETRO__
 static volatile bool emuRenderFrame = false;
+static volatile bool emuRenderSkipped = false;
 #endif
 extern uint8_t audioExpansion;
 void nesEmuDeinit(void)
@@ -652,7 +1029,16 @@ void nesEmuDeinit(void)
 	//printf("\n");
 	#ifndef __LIBRETRO__
 	emuRenderFrame = false;
+	movieStop();
+	traceStop();
+	profStop();
+	statsStop();
+	hashStop();
+	telemetryStop();
+	rewindDeinit();
+	captureStop();
 	audioDeinit();
+	pacerDeinit();
 	#endif
 	apuDeinitBufs();
 	if(emuNesROM != NULL)
@@ -671,12 +1057,14 @@ void nesEmuDeinit(void)
 			}
 		}
 #endif
-		free(emuNesROM);
+		nesEmuFreeROM();
 	}
 	audioExpansion = 0;
 	nesEmuNSFPlayback = false;
 	emuNesROM = NULL;
 	emuNesROMsize = 0;
+	emuPrgROM = NULL;
+	emuPrgROMsize = 0;
 	if(emuPrgRAM != NULL)
 	{
 #ifndef __LIBRETRO__
@@ -695,15 +1083,84 @@ void nesEmuDeinit(void)
 	emuSaveEnabled = false;
 	emuPrgRAM = NULL;
 	emuPrgRAMsize = 0;
+	if(emuRunAheadState != NULL)
+		free(emuRunAheadState);
+	emuRunAheadState = NULL;
 	//printf("Bye!\n");
 }
 
-//used externally
+//returns if run-ahead is in use for the loaded game
+bool nesEmuSetRunAhead(uint8_t frames)
+{
+	emuRunAhead = frames;
+	//nsf playback has nothing to show early
+	if(!emuRunAhead || emuNesROM == NULL || nesEmuNSFPlayback)
+	{
+		if(emuRunAheadState != NULL)
+			free(emuRunAheadState);
+		emuRunAheadState = NULL;
+		return false;
+	}
+	if(emuRunAheadState == NULL)
+	{
+		emuRunAheadState = malloc(stateSize());
+		printf("Main: Run-ahead of %i frames, %u bytes per snapshot\n", emuRunAhead, stateSize());
+	}
+	return (emuRunAheadState != NULL);
+}
+
+static bool nesEmuRunFrame()
+{
+	while(1)
+	{
+		if(!cpuCycle())
+			return false;
+		ppuCycle();
+		apuCycle();
+		mapperCycle();
+		if(ppuDrawDone())
+		{
+			cheatFrame();
+			return true;
+		}
+	}
+}
+
 #ifndef __LIBRETRO__
-bool emuSkipVsync = false;
-bool emuSkipFrame = false;
+//the frame hooks of the main loop minus the display ones,
+//so hashes, movies and traces also work in --test runs
+static bool nesEmuTestFrame()
+{
+	if(!nesEmuRunFrame())
+		return false;
+	profFrame();
+	hashFrame();
+	movieFrameDone();
+	return true;
+}
 #endif
 
+//right after a real frame, emulates the next frames with
+//the same input for display only and then goes back, so
+//new input shows up on screen emuRunAhead frames earlier
+bool nesEmuRunAheadFrames(bool draw)
+{
+	if(emuRunAheadState == NULL)
+		return false;
+	stateSave(emuRunAheadState);
+	apuSkipOutput = true;
+	uint8_t i;
+	for(i = 0; i < emuRunAhead; i++)
+	{
+		ppuSkipRender = !(draw && i+1 == emuRunAhead);
+		if(!nesEmuRunFrame())
+			break;
+	}
+	apuSkipOutput = false;
+	stateLoad(emuRunAheadState);
+	return true;
+}
+
 //static uint32_t mCycles = 0;
 void nesEmuMainLoop(void)
 {
@@ -713,32 +1170,61 @@ void nesEmuMainLoop(void)
 		#if (WINDOWS_BUILD && DEBUG_MAIN_CALLS)
 		emuMainTimesSkipped++;
 		#endif
-		audioSleep();
+		//keep the pacer ticking while paused
+		if(nesPause)
+			pacerWait();
 		return;
 	}
+	uint8_t turboSpeed = emuTurboSpeeds[emuTurboSel];
+	uint8_t turboFrames = turboSpeed ? turboSpeed : EMU_TURBO_UNCAPPED_FRAMES;
+	if(telemetryActive)
+		telemetryEmuStart();
 #endif
 	while(1)
 	{
+		bool cpuOk;
+		STATS_LOOP();
 		//main CPU clock
-		if(!cpuCycle())
+		STATS_TIME(STATS_TIME_CPU, cpuOk = cpuCycle());
+		if(!cpuOk)
 			exit(EXIT_SUCCESS);
 		//run graphics
-		ppuCycle();
+		STATS_TIME(STATS_TIME_PPU, ppuCycle());
 		//run audio
-		apuCycle();
+		STATS_TIME(STATS_TIME_APU, apuCycle());
 		//mapper related irqs
-		mapperCycle();
+		STATS_TIME(STATS_TIME_MAPPER, mapperCycle());
 		//mCycles++;
 		if(ppuDrawDone())
 		{
+			//ram freezes for the next frame
+			cheatFrame();
+			profFrame();
+			statsFrame();
+			hashFrame();
+			//log this frames input or load the next ones
+			movieFrameDone();
+		#ifndef __LIBRETRO__
+			//while held every shown frame steps back instead
+			if(inRewind)
+				rewindStep();
+			else
+				rewindFrameDone();
+		#endif
 			//printf("%i\n",mCycles);
 			//mCycles = 0;
 		#ifndef __LIBRETRO__
+			//in fast-forward only the last of
+			//turboFrames frames gets displayed
+			if(++emuTurboFrame < turboFrames)
+			{
+				ppuSkipRender = (emuTurboFrame+1 < turboFrames) || emuRunAheadState != NULL;
+				if(nesEmuNSFPlayback)
+					nsfVsync();
+				continue;
+			}
+			emuTurboFrame = 0;
 			emuRenderFrame = true;
-			#if 0
-			if(fm2playRunning())
-				fm2playUpdate();
-			#endif
 			#if (WINDOWS_BUILD && DEBUG_HZ)
 			emuTimesCalled++;
 			DWORD end = GetTickCount();
@@ -751,8 +1237,26 @@ void nesEmuMainLoop(void)
 			}
 			emuFrameStart = end;
 			#endif
-			//update audio before drawing
-			while(!apuUpdate()) audioSleep();
+			//what gets shown comes from the frames ahead,
+			//the real one only ran in the background
+			bool aheadDrawn = nesEmuRunAheadFrames(true);
+			//hand the finished frame and its audio to the capture thread
+			if(captureRunning())
+				captureFrame(textureImage, apuGetBuf(), apuGetBufSize());
+			if(telemetryActive)
+				telemetryEmuDone(turboFrames);
+			//update audio and wait for the frame deadline
+			//before drawing, uncapped never waits at all
+			if(turboSpeed)
+			{
+				apuUpdate();
+				pacerWait();
+			}
+			//remember if this frame got composed at all
+			emuRenderSkipped = aheadDrawn ? false : ppuSkipRender;
+			if(telemetryActive)
+				telemetryFrameShown(emuRenderSkipped);
+			ppuSkipRender = (turboFrames > 1) || emuRunAheadState != NULL;
 			glutPostRedisplay();
 			#if 0
 			if(ppuDebugPauseFrame)
@@ -794,7 +1298,7 @@ static void nesEmuHandleKeyDown(unsigned char key, int x, int y)
 		case 'z':
 		case 'Y':
 		case 'Z':
-			if(fm2playRunning())
+			if(moviePlaying())
 				break;
 			#if DEBUG_KEY
 			if(inValReads[BUTTON_A]==0)
@@ -804,7 +1308,7 @@ static void nesEmuHandleKeyDown(unsigned char key, int x, int y)
 			break;
 		case 'x':
 		case 'X':
-			if(fm2playRunning())
+			if(moviePlaying())
 				break;
 			#if DEBUG_KEY
 			if(inValReads[BUTTON_B]==0)
@@ -814,7 +1318,7 @@ static void nesEmuHandleKeyDown(unsigned char key, int x, int y)
 			break;
 		case 's':
 		case 'S':
-			if(fm2playRunning())
+			if(moviePlaying())
 				break;
 			#if DEBUG_KEY
 			if(inValReads[BUTTON_SELECT]==0)
@@ -824,7 +1328,7 @@ static void nesEmuHandleKeyDown(unsigned char key, int x, int y)
 			break;
 		case 'a':
 		case 'A':
-			if(fm2playRunning())
+			if(moviePlaying())
 				break;
 			#if DEBUG_KEY
 			if(inValReads[BUTTON_START]==0)
@@ -838,10 +1342,13 @@ static void nesEmuHandleKeyDown(unsigned char key, int x, int y)
 			break;
 		case 'b':
 		case 'B':
+			if(moviePlaying())
+				break;
 			if(!inDiskSwitch)
 			{
 				fdsSwitch = true;
 				inDiskSwitch = true;
+				movieEvent(MOVIE_EV_DISK);
 			}
 			break;
 		case 'p':
@@ -928,13 +1435,40 @@ static void nesEmuHandleKeyDown(unsigned char key, int x, int y)
 			}
 			break;
 		case '\x12': //ctrl-R
+			if(moviePlaying())
+				break;
 			if(!inReset)
 			{
 				inReset = true;
 				if(!nesEmuNSFPlayback)
+				{
 					cpuSoftReset();
+					movieEvent(MOVIE_EV_RESET);
+				}
 			}
 			break;
+		case 't':
+		case 'T':
+			if(!inTurbo)
+			{
+				inTurbo = true;
+				nesEmuSetTurbo((emuTurboSel+1)%EMU_TURBO_SPEEDS);
+			}
+			break;
+		case 'r':
+		case 'R':
+			if(!inRewind)
+			{
+				inRewind = true;
+				rewindPrintStats();
+			}
+			break;
+		case 'd':
+		case 'D':
+			//same as --debug, no traps in the frames run ahead
+			nesEmuSetRunAhead(0);
+			dbgBreak();
+			break;
 		default:
 			break;
 	}
@@ -950,7 +1484,7 @@ static void nesEmuHandleKeyUp(unsigned char key, int x, int y)
 		case 'z':
 		case 'Y':
 		case 'Z':
-			if(fm2playRunning())
+			if(moviePlaying())
 				break;
 			#if DEBUG_KEY
 			printf("a up\n");
@@ -959,7 +1493,7 @@ static void nesEmuHandleKeyUp(unsigned char key, int x, int y)
 			break;
 		case 'x':
 		case 'X':
-			if(fm2playRunning())
+			if(moviePlaying())
 				break;
 			#if DEBUG_KEY
 			printf("b up\n");
@@ -968,7 +1502,7 @@ static void nesEmuHandleKeyUp(unsigned char key, int x, int y)
 			break;
 		case 's':
 		case 'S':
-			if(fm2playRunning())
+			if(moviePlaying())
 				break;
 			#if DEBUG_KEY
 			printf("sel up\n");
@@ -977,7 +1511,7 @@ static void nesEmuHandleKeyUp(unsigned char key, int x, int y)
 			break;
 		case 'a':
 		case 'A':
-			if(fm2playRunning())
+			if(moviePlaying())
 				break;
 			#if DEBUG_KEY
 			printf("start up\n");
@@ -1007,6 +1541,14 @@ static void nesEmuHandleKeyUp(unsigned char key, int x, int y)
 		case '\x12': //ctrl-R
 			inReset = false;
 			break;
+		case 't':
+		case 'T':
+			inTurbo = false;
+			break;
+		case 'r':
+		case 'R':
+			inRewind = false;
+			break;
 		default:
 			break;
 	}
@@ -1019,7 +1561,7 @@ static void nesEmuHandleSpecialDown(int key, int x, int y)
 	switch(key)
 	{
 		case GLUT_KEY_UP:
-			if(fm2playRunning())
+			if(moviePlaying())
 				break;
 			#if DEBUG_KEY
 			if(inValReads[BUTTON_UP]==0)
@@ -1028,7 +1570,7 @@ static void nesEmuHandleSpecialDown(int key, int x, int y)
 			inValReads[BUTTON_UP]=1;
 			break;	
 		case GLUT_KEY_DOWN:
-			if(fm2playRunning())
+			if(moviePlaying())
 				break;
 			#if DEBUG_KEY
 			if(inValReads[BUTTON_DOWN]==0)
@@ -1037,7 +1579,7 @@ static void nesEmuHandleSpecialDown(int key, int x, int y)
 			inValReads[BUTTON_DOWN]=1;
 			break;
 		case GLUT_KEY_LEFT:
-			if(fm2playRunning())
+			if(moviePlaying())
 				break;
 			#if DEBUG_KEY
 			if(inValReads[BUTTON_LEFT]==0)
@@ -1046,7 +1588,7 @@ static void nesEmuHandleSpecialDown(int key, int x, int y)
 			inValReads[BUTTON_LEFT]=1;
 			break;
 		case GLUT_KEY_RIGHT:
-			if(fm2playRunning())
+			if(moviePlaying())
 				break;
 			#if DEBUG_KEY
 			if(inValReads[BUTTON_RIGHT]==0)
@@ -1066,7 +1608,7 @@ static void nesEmuHandleSpecialUp(int key, int x, int y)
 	switch(key)
 	{
 		case GLUT_KEY_UP:
-			if(fm2playRunning())
+			if(moviePlaying())
 				break;
 			#if DEBUG_KEY
 			printf("up up\n");
@@ -1074,7 +1616,7 @@ static void nesEmuHandleSpecialUp(int key, int x, int y)
 			inValReads[BUTTON_UP]=0;
 			break;	
 		case GLUT_KEY_DOWN:
-			if(fm2playRunning())
+			if(moviePlaying())
 				break;
 			#if DEBUG_KEY
 			printf("down up\n");
@@ -1082,7 +1624,7 @@ static void nesEmuHandleSpecialUp(int key, int x, int y)
 			inValReads[BUTTON_DOWN]=0;
 			break;
 		case GLUT_KEY_LEFT:
-			if(fm2playRunning())
+			if(moviePlaying())
 				break;
 			#if DEBUG_KEY
 			printf("left up\n");
@@ -1090,7 +1632,7 @@ static void nesEmuHandleSpecialUp(int key, int x, int y)
 			inValReads[BUTTON_LEFT]=0;
 			break;
 		case GLUT_KEY_RIGHT:
-			if(fm2playRunning())
+			if(moviePlaying())
 				break;
 			#if DEBUG_KEY
 			printf("right up\n");
@@ -1106,23 +1648,13 @@ static void nesEmuDisplayFrame()
 {
 	if(emuRenderFrame)
 	{
-		#if WINDOWS_BUILD
-		//temporarily disable vsync to resync
-		//with audio output
-		if(emuSkipFrame)
-			nesEmuSetWindowsVSync(0);
-		else
-			nesEmuSetWindowsVSync(1);
-		#else
-		//vsync on other systems not in our control,
-		//so if it wants to skip frames to resync
-		//with audio output let it do so
-		if(emuSkipFrame)
+		//nothing got composed for this frame
+		if(emuRenderSkipped)
 		{
 			emuRenderFrame = false;
 			return;
 		}
-		#endif
+		uint64_t renderStart = telemetryActive ? pacerNow() : 0;
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, VISIBLE_DOTS, linesToDraw, 0, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, textureImage);
 		emuRenderFrame = false;
 
@@ -1147,7 +1679,274 @@ static void nesEmuDisplayFrame()
 		glEnd();
 
 		glutSwapBuffers();
+		if(telemetryActive)
+			telemetryRender(pacerNow() - renderStart);
+	}
+}
+#endif
+
+#ifndef __LIBRETRO__
+static void nesEmuSetTurbo(uint8_t sel)
+{
+	emuTurboSel = sel;
+	emuTurboFrame = 0;
+	uint8_t speed = emuTurboSpeeds[sel];
+	//decimate audio along with the frames so it
+	//keeps pacing the emulation at the new speed
+	apuSetTurbo(speed, emuTurboMute);
+	if(speed == 1)
+		printf("Turbo: Off\n");
+	else if(speed)
+		printf("Turbo: %ix\n", speed);
+	else
+		printf("Turbo: Uncapped\n");
+}
+
+static void nesEmuPrintUsage(const char *name)
+{
+	printf("Usage: %s file [options]\n", name);
+	printf("       %s --bench <cpu|ppu|apu|all> [runs] times each part alone\n", name);
+	printf("  --turbo <2|4|8|max>     start in fast-forward\n");
+	printf("  --turbo-audio <compress|mute>\n");
+	printf("                          fast-forward audio handling\n");
+	printf("  --audio <out[:arg]>     audio output, one of: ");
+	audioListSinks();
+	printf("                          wav:file and raw:file record to a file\n");
+	printf("  --audio-buffers <n>     number of queued audio buffers\n");
+	printf("  --audio-period <ms>     audio buffer length, 0 for one frame\n");
+	printf("  --capture <file|\"|cmd\">\n");
+	printf("                          record video, audio goes to file.wav\n");
+	printf("  --capture-format <y4m|rgb>\n");
+	printf("                          YUV4MPEG2 or raw 24bit RGB frames\n");
+	printf("  --capture-audio <file>  wav file for the captured audio\n");
+	printf("  --record <file.fxm>     record an input movie\n");
+	printf("  --play <file.fxm>       play back an input movie, convert fm2 files\n");
+	printf("                          with %s --movie-convert <in> <out>\n", name);
+	printf("  --cheat <code>          game genie or addr:val[:cmp] hex code, repeatable\n");
+	printf("  --rewind <kb>           memory for rewinding with R, 0 is off\n");
+	printf("  --rewind-interval <n>   frames between rewind states, 1 by default\n");
+	printf("  --runahead <0-%i>        frames to run ahead, hides that much input lag\n", EMU_RUNAHEAD_MAX);
+	printf("  --trace <file>          log every instruction, read it with\n");
+	printf("                          %s --trace-print <file> or --trace-diff <a> <b>\n", name);
+	printf("  --trace-ring <n>        only keep the last n instructions in the trace\n");
+	printf("  --profile <file>        count where cpu cycles go, also writes\n");
+	printf("                          file.folded for flamegraphs\n");
+	printf("  --stats                 print what the emulated hardware did and\n");
+	printf("                          where host time went on exit, needs EMU_STATS\n");
+	printf("  --hash <file>           hash machine state, picture and sound every\n");
+	printf("                          frame, compare with %s --hash-diff <a> <b>\n", name);
+	printf("  --test <frames>         run without a window until a test rom reports\n");
+	printf("                          its result at $6000, run a list of them with\n");
+	printf("                          %s --test-suite <list> [jobs]\n", name);
+	printf("  --test-hash <hash>      pass if the last frame has this video hash\n");
+	printf("  --telemetry <file|unix:path>\n");
+	printf("                          write fps, timing and audio queue of every\n");
+	printf("                          shown frame as json lines\n");
+	printf("  --debug                 start in the debugger, D breaks into it later\n");
+	printf("  --index <file>          look up the file name or crc32 in a rom index,\n");
+	printf("                          made with %s --index-build <folder> <file>\n", name);
+#if ZIPSUPPORT
+	printf("  --zip-entry <name|n>    file to load from a zip, same as file.zip#name\n");
+#endif
+}
+
+static void nesEmuStartCapture()
+{
+	static char audioPath[1024];
+	const char *aPath = emuCaptureAudioPath;
+	int format = emuCaptureFormat;
+	//guess from the name unless told
+	if(format < 0)
+	{
+		const char *ext = strrchr(emuCapturePath, '.');
+		format = (ext && strcasecmp(ext, ".y4m") == 0) ? CAPTURE_Y4M : CAPTURE_RGB;
+		if(emuCapturePath[0] == '|')
+			format = CAPTURE_Y4M;
+	}
+	//audio next to the video unless going into a pipe
+	if(!aPath && emuCapturePath[0] != '|')
+	{
+		snprintf(audioPath, sizeof(audioPath), "%s.wav", emuCapturePath);
+		aPath = audioPath;
+	}
+	captureStart(emuCapturePath, aPath, format, nesPAL);
+}
+
+//opens whatever the index has under that name or crc,
+//anything not in there is used as a plain path
+static void nesEmuIndexOpen(const char *key)
+{
+	romIndexEntry_t entry;
+	if(!romIndexOpen(emuIndexPath) || !romIndexFind(key, &entry))
+	{
+		romIndexClose();
+		nesEmuFileOpen(key);
+		return;
+	}
+	printf("Index: %s is %s", key, entry.path);
+	if(entry.zipNum != ROM_INDEX_NO_ZIP)
+	{
+		printf(" entry %u", entry.zipNum);
+#if ZIPSUPPORT
+		emuZipPos.pos_in_zip_directory = entry.zipPos;
+		emuZipPos.num_of_file = entry.zipNum;
+		emuZipUsePos = true;
+#endif
+	}
+	printf(" (CRC %08X, mapper %u)\n", entry.info.crc, entry.info.mapper);
+	emuRegion = entry.info.region;
+	nesEmuFileOpen(entry.path);
+	romIndexClose();
+}
+
+static bool nesEmuParseArgs(int argc, char** argv)
+{
+	int i;
+	for(i = 2; i < argc; i++)
+	{
+		if(strcmp(argv[i],"--turbo") == 0 && i+1 < argc)
+		{
+			const char *val = argv[++i];
+			uint8_t sel;
+			for(sel = 0; sel < EMU_TURBO_SPEEDS; sel++)
+			{
+				if(emuTurboSpeeds[sel] == 0 ? (strcmp(val,"max") == 0) : (atoi(val) == emuTurboSpeeds[sel]))
+					break;
+			}
+			if(sel == EMU_TURBO_SPEEDS)
+			{
+				printf("Main: Unsupported turbo speed %s\n", val);
+				return false;
+			}
+			emuTurboSel = sel;
+		}
+		else if(strcmp(argv[i],"--turbo-audio") == 0 && i+1 < argc)
+		{
+			const char *val = argv[++i];
+			if(strcmp(val,"compress") == 0)
+				emuTurboMute = false;
+			else if(strcmp(val,"mute") == 0)
+				emuTurboMute = true;
+			else
+			{
+				printf("Main: Unsupported turbo audio mode %s\n", val);
+				return false;
+			}
+		}
+		else if(strcmp(argv[i],"--audio") == 0 && i+1 < argc)
+		{
+			if(!audioSelectSink(argv[++i]))
+			{
+				nesEmuPrintUsage(argv[0]);
+				return false;
+			}
+		}
+		else if(strcmp(argv[i],"--audio-buffers") == 0 && i+1 < argc)
+			emuAudioBuffers = atoi(argv[++i]);
+		else if(strcmp(argv[i],"--audio-period") == 0 && i+1 < argc)
+			emuAudioPeriod = atoi(argv[++i]);
+		else if(strcmp(argv[i],"--capture") == 0 && i+1 < argc)
+			emuCapturePath = argv[++i];
+		else if(strcmp(argv[i],"--capture-audio") == 0 && i+1 < argc)
+			emuCaptureAudioPath = argv[++i];
+#if ZIPSUPPORT
+		else if(strcmp(argv[i],"--zip-entry") == 0 && i+1 < argc)
+			emuZipEntry = argv[++i];
+#endif
+		else if((strcmp(argv[i],"--record") == 0 || strcmp(argv[i],"--play") == 0) && i+1 < argc)
+		{
+			emuMovieRecord = (strcmp(argv[i],"--record") == 0);
+			emuMoviePath = argv[++i];
+		}
+		else if(strcmp(argv[i],"--index") == 0 && i+1 < argc)
+			emuIndexPath = argv[++i];
+		else if(strcmp(argv[i],"--cheat") == 0 && i+1 < argc)
+		{
+			if(emuCheatNum == EMU_MAX_CHEATS)
+			{
+				printf("Main: At most %i cheats can be given\n", EMU_MAX_CHEATS);
+				return false;
+			}
+			emuCheats[emuCheatNum++] = argv[++i];
+		}
+		else if(strcmp(argv[i],"--trace") == 0 && i+1 < argc)
+			emuTracePath = argv[++i];
+		else if(strcmp(argv[i],"--trace-ring") == 0 && i+1 < argc)
+			emuTraceRing = strtoul(argv[++i], NULL, 10);
+		else if(strcmp(argv[i],"--profile") == 0 && i+1 < argc)
+			emuProfPath = argv[++i];
+		else if(strcmp(argv[i],"--stats") == 0)
+			emuStats = true;
+		else if(strcmp(argv[i],"--hash") == 0 && i+1 < argc)
+			emuHashPath = argv[++i];
+		else if(strcmp(argv[i],"--test") == 0 && i+1 < argc)
+			emuTestFrames = strtoul(argv[++i], NULL, 10);
+		else if(strcmp(argv[i],"--test-hash") == 0 && i+1 < argc)
+			emuTestHash = argv[++i];
+		else if(strcmp(argv[i],"--telemetry") == 0 && i+1 < argc)
+			emuTelemetry = argv[++i];
+		else if(strcmp(argv[i],"--debug") == 0)
+			emuDebug = true;
+		else if(strcmp(argv[i],"--rewind") == 0 && i+1 < argc)
+		{
+			const char *val = argv[++i];
+			char *end = NULL;
+			unsigned long kb = strtoul(val, &end, 10);
+			//strtoul takes a sign, so check for plain digits first
+			if(*val < '0' || *val > '9' || *end != 0 || kb > EMU_REWIND_MAX_KB)
+			{
+				printf("Main: Rewind memory has to be 0 to %u kb\n", EMU_REWIND_MAX_KB);
+				return false;
+			}
+			emuRewindSize = kb;
+		}
+		else if(strcmp(argv[i],"--rewind-interval") == 0 && i+1 < argc)
+		{
+			int frames = atoi(argv[++i]);
+			if(frames < 1 || frames > 255)
+			{
+				printf("Main: Rewind interval has to be 1 to 255 frames\n");
+				return false;
+			}
+			emuRewindInterval = frames;
+		}
+		else if(strcmp(argv[i],"--runahead") == 0 && i+1 < argc)
+		{
+			int frames = atoi(argv[++i]);
+			if(frames < 0 || frames > EMU_RUNAHEAD_MAX)
+			{
+				printf("Main: Run-ahead has to be 0 to %i frames\n", EMU_RUNAHEAD_MAX);
+				return false;
+			}
+			emuRunAhead = frames;
+		}
+		else if(strcmp(argv[i],"--capture-format") == 0 && i+1 < argc)
+		{
+			const char *val = argv[++i];
+			if(strcmp(val,"y4m") == 0)
+				emuCaptureFormat = CAPTURE_Y4M;
+			else if(strcmp(val,"rgb") == 0)
+				emuCaptureFormat = CAPTURE_RGB;
+			else
+			{
+				printf("Main: Unsupported capture format %s\n", val);
+				return false;
+			}
+		}
+		else
+		{
+			printf("Main: Unknown option %s\n", argv[i]);
+			nesEmuPrintUsage(argv[0]);
+			return false;
+		}
+	}
+	if(emuAudioBuffers < 2 || emuAudioPeriod < 0 || (emuAudioPeriod && emuAudioPeriod < 5))
+	{
+		printf("Main: Audio needs at least 2 buffers and a period of at least 5ms\n");
+		return false;
 	}
+	audioSetLatency(emuAudioBuffers, emuAudioPeriod);
+	return true;
 }
 #endif
 
@@ -15,6 +15,7 @@
 #include "mapper_h/m32.h"
 #include "mapper_h/p16c8.h"
 #include "ppu.h"
+#include "state.h"
 
 get8FuncT mapperGet8;
 set8FuncT mapperSet8;
@@ -23,6 +24,7 @@ chrSet8FuncT mapperChrSet8;
 vramGet8FuncT mapperVramGet8;
 vramSet8FuncT mapperVramSet8;
 cycleFuncT mapperCycle;
+prgBankFuncT mapperPrgBank;
 uint8_t mapperChrMode;
 bool mapperUse78A = false;
 
@@ -45,6 +47,7 @@ bool mapperInit(uint8_t mapper, uint8_t *prgROM, uint32_t prgROMsize, uint8_t *p
 		mapperCycle = mapperNone;
 	else
 		mapperCycle = mapperList[mapper].cycleFuncF;
+	mapperPrgBank = mapperList[mapper].prgBankF;
 	//some mappers re-route VRAM
 	if(mapperList[mapper].vramGet8F == NULL)
 		mapperVramGet8 = ppuVRAMGet8;
@@ -61,6 +64,7 @@ bool mapperInit(uint8_t mapper, uint8_t *prgROM, uint32_t prgROMsize, uint8_t *p
 		mapperSet8 = m78a_set8;
 	}
 	mapperChrMode = 0;
+	stateAddVar(mapperChrMode);
 	return true;
 }
 
@@ -72,9 +76,11 @@ bool mapperInitNSF(uint8_t *nsfBIN, uint32_t nsfBINsize, uint8_t *prgRAM, uint32
 	mapperChrGet8 = nsfchrGet8;
 	mapperChrSet8 = nsfchrSet8;
 	mapperCycle = nsfcycle;
+	mapperPrgBank = NULL;
 	mapperVramGet8 = ppuVRAMGet8;
 	mapperVramSet8 = ppuVRAMSet8;
 	mapperChrMode = 0;
+	stateAddVar(mapperChrMode);
 	return true;
 }
 
@@ -119,7 +125,9 @@ bool mapperInitFDS(uint8_t *fdsFile, bool fdsSideB, uint8_t *prgRAM, uint32_t pr
 	mapperVramGet8 = ppuVRAMGet8;
 	mapperVramSet8 = ppuVRAMSet8;
 	mapperCycle = fdscycle;
+	mapperPrgBank = NULL;
 	mapperChrMode = 0;
+	stateAddVar(mapperChrMode);
 	return true;
 }
 
@@ -133,3 +141,10 @@ uint32_t mapperGetAndValue(uint32_t v)
 	v |= v >> 16;
 	return v;
 }
+
+uint16_t mapperGetPrgBank(uint16_t addr)
+{
+	if(mapperPrgBank == NULL || addr < 0x8000)
+		return 0;
+	return mapperPrgBank(addr);
+}
@@ -16,11 +16,13 @@ typedef void (*chrSet8FuncT)(uint16_t, uint8_t);
 typedef uint8_t (*vramGet8FuncT)(uint16_t);
 typedef void (*vramSet8FuncT)(uint16_t, uint8_t);
 typedef void (*cycleFuncT)();
+typedef uint16_t (*prgBankFuncT)(uint16_t);
 
 bool mapperInit(uint8_t mapper, uint8_t *prgROM, uint32_t prgROMsize, uint8_t *prgRAM, uint32_t prgRAMsize, uint8_t *chrROM, uint32_t chrROMsize);
 bool mapperInitNSF(uint8_t *nsfBIN, uint32_t nsfBINsize, uint8_t *prgRAM, uint32_t prgRAMsize);
 bool mapperInitFDS(uint8_t *fdsFile, bool fdsSideB, uint8_t *prgRAM, uint32_t prgRAMsize);
 uint32_t mapperGetAndValue(uint32_t v);
+uint16_t mapperGetPrgBank(uint16_t addr);
 
 extern get8FuncT mapperGet8;
 extern set8FuncT mapperSet8;
@@ -29,6 +31,9 @@ extern chrSet8FuncT mapperChrSet8;
 extern vramGet8FuncT mapperVramGet8;
 extern vramSet8FuncT mapperVramSet8;
 extern cycleFuncT mapperCycle;
+//8k prg rom bank the cpu sees at an address from $8000 on,
+//NULL for mappers without banking or not telling
+extern prgBankFuncT mapperPrgBank;
 extern uint8_t mapperChrMode;
 
 #endif
@@ -14,6 +14,7 @@
 #include "../input.h"
 #include "../mem.h"
 #include "../audio_fds.h"
+#include "../state.h"
 
 bool fdsSwitch;
 
@@ -87,6 +88,25 @@ void fdsinit(uint8_t *fdsBIOS, uint32_t fdsBIOSsize, uint8_t *fdsFile, bool fdsS
 	fds_disk_position = 0;
 	fdsAudioInit();
 	memset(fds_chrRAM, 0, 0x2000);
+	stateAddVar(fdsSwitch);
+	stateAddVar(fds_FileLoc);
+	stateAddVar(fds_chrRAM);
+	stateAddVar(fds_irq_enable);
+	stateAddVar(fds_transfer_irq_enable);
+	stateAddVar(fds_disk_ready);
+	stateAddVar(fds_transfer_done);
+	stateAddVar(fds_data_read);
+	stateAddVar(fds_disk_sideB);
+	stateAddVar(fds_crc_check);
+	stateAddVar(fds_disk_start);
+	stateAddVar(fds_disk_active);
+	stateAddVar(fds_transfer_val);
+	stateAddVar(fds_switch_delay);
+	stateAddVar(fds_irq_timer);
+	stateAddVar(fds_cur_irq_timer);
+	stateAddVar(fds_transfer_timer);
+	stateAddVar(fds_disk_position);
+	stateAddVar(fds_disk_ready_timer);
 	printf("FDS Inited\n");
 }
 
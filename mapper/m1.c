@@ -11,6 +11,7 @@
 #include <stdbool.h>
 #include "../ppu.h"
 #include "../mapper.h"
+#include "../state.h"
 
 static uint8_t *m1_prgROM;
 static uint8_t *m1_prgRAM;
@@ -64,6 +65,17 @@ void m1init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	m1_single_prg_bank = false;
 	m1_last_bank_fixed = true;
 	m1_single_chr_bank = false;
+	stateAddVar(m1_prgROMand);
+	stateAddVar(m1_chrROMand);
+	stateAddVar(m1_chrRAM);
+	stateAddVar(m1_256KPRGBank);
+	stateAddVar(m1_curPRGBank);
+	stateAddVar(m1_curCHRBank0);
+	stateAddVar(m1_curCHRBank1);
+	stateAddVar(m1_sr);
+	stateAddVar(m1_single_prg_bank);
+	stateAddVar(m1_last_bank_fixed);
+	stateAddVar(m1_single_chr_bank);
 	printf("Mapper 1 inited, last bank=%04x sr=%02x\n", m1_lastPRGBank, m1_sr);
 }
 
@@ -94,6 +106,18 @@ uint8_t m1get8(uint16_t addr, uint8_t val)
 }
 
 extern bool cpuWriteTMP;
+uint16_t m1prgBank(uint16_t addr)
+{
+	uint32_t offset;
+	if(m1_single_prg_bank)
+		offset = (m1_curPRGBank&~0x7FFF)+(addr&0x7FFF);
+	else if(addr < 0xC000)
+		offset = (m1_last_bank_fixed ? (m1_curPRGBank&~0x3FFF) : m1_firstPRGBank)+(addr&0x3FFF);
+	else
+		offset = (m1_last_bank_fixed ? m1_lastPRGBank : (m1_curPRGBank&~0x3FFF))+(addr&0x3FFF);
+	return (offset+m1_256KPRGBank)>>13;
+}
+
 void m1set8(uint16_t addr, uint8_t val)
 {
 	if(addr >= 0x6000 && addr < 0x8000)
@@ -10,6 +10,7 @@
 #include <stdbool.h>
 #include "../ppu.h"
 #include "../mapper.h"
+#include "../state.h"
 
 static uint8_t *m10_prgROM;
 static uint8_t *m10_prgRAM;
@@ -48,6 +49,15 @@ void m10init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	m10_curCHRBank11 = 0;
 	m10_CHRSelect0 = 0;
 	m10_CHRSelect1 = 0;
+	stateAddVar(m10_prgROMand);
+	stateAddVar(m10_chrROMand);
+	stateAddVar(m10_curPRGBank);
+	stateAddVar(m10_curCHRBank00);
+	stateAddVar(m10_curCHRBank01);
+	stateAddVar(m10_curCHRBank10);
+	stateAddVar(m10_curCHRBank11);
+	stateAddVar(m10_CHRSelect0);
+	stateAddVar(m10_CHRSelect1);
 	printf("Mapper 10 inited, last bank=%04x\n", m10_lastPRGBank);
 }
 
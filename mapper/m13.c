@@ -8,6 +8,7 @@
 #include <stdio.h>
 #include <inttypes.h>
 #include <string.h>
+#include "../state.h"
 
 static uint8_t *m13_prgROM;
 static uint32_t m13_prgROMsize;
@@ -27,6 +28,8 @@ void m13init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	(void)chrROMin;
 	m13_curCHRBank = 0;
 	memset(m13_chrRAM,0,0x4000);
+	stateAddVar(m13_curCHRBank);
+	stateAddVar(m13_chrRAM);
 	printf("Mapper 13 inited\n");
 }
 
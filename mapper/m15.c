@@ -11,6 +11,7 @@
 #include <string.h>
 #include "../ppu.h"
 #include "../mapper.h"
+#include "../state.h"
 
 static uint8_t *m15_prgROM;
 static uint8_t *m15_prgRAM;
@@ -46,6 +47,11 @@ void m15init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 		printf("m15 ???\n");
 	}
 	memset(m15_chrRAM,0,0x2000);
+	stateAddVar(m15_prgROMand);
+	stateAddVar(m15_curPRGBank);
+	stateAddVar(m15_bankMode);
+	stateAddVar(m15_upperPRGBank);
+	stateAddVar(m15_chrRAM);
 	printf("Mapper 15 inited\n");
 }
 
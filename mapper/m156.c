@@ -11,6 +11,7 @@
 #include <string.h>
 #include "../ppu.h"
 #include "../mapper.h"
+#include "../state.h"
 
 static uint8_t *m156_prgROM;
 static uint8_t *m156_prgRAM;
@@ -47,6 +48,10 @@ void m156init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 		printf("m156???\n");
 	memset(m156_CHRBank,0,8*sizeof(uint32_t));
 	ppuSetNameTblSingleLower(); //seems to be default state?
+	stateAddVar(m156_prgROMand);
+	stateAddVar(m156_chrROMand);
+	stateAddVar(m156_curPRGBank);
+	stateAddVar(m156_CHRBank);
 	printf("Mapper 156 inited\n");
 }
 
@@ -11,6 +11,7 @@
 #include <string.h>
 #include "../ppu.h"
 #include "../mapper.h"
+#include "../state.h"
 
 static uint8_t *m206prgROM;
 static uint8_t *m206prgRAM;
@@ -52,6 +53,14 @@ void m206init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	m206BankSelect = 0;
 	m95nt0 = 0;
 	m95nt1 = 0;
+	stateAddVar(m206curPRGBank0);
+	stateAddVar(m206curPRGBank1);
+	stateAddVar(m206BankSelect);
+	stateAddVar(m206CHRBank);
+	stateAddVar(m206prgROMand);
+	stateAddVar(m206chrROMand);
+	stateAddVar(m95nt0);
+	stateAddVar(m95nt1);
 	printf("Mapper 206 (and Variants) inited\n");
 }
 
@@ -11,6 +11,7 @@
 #include <string.h>
 #include "../ppu.h"
 #include "../mapper.h"
+#include "../state.h"
 
 static uint8_t *m225_prgROM;
 static uint8_t *m225_chrROM;
@@ -50,6 +51,13 @@ void m225init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	memset(m225_regRAM,0,4);
 	m225_CHRBank = 0;
 	m225_prgFull = true;
+	stateAddVar(m225_chrRAM);
+	stateAddVar(m225_regRAM);
+	stateAddVar(m225_PRGBank);
+	stateAddVar(m225_CHRBank);
+	stateAddVar(m225_prgROMand);
+	stateAddVar(m225_chrROMand);
+	stateAddVar(m225_prgFull);
 	printf("Mapper 225 inited\n");
 }
 
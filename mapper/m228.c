@@ -11,6 +11,7 @@
 #include <string.h>
 #include "../ppu.h"
 #include "../mapper.h"
+#include "../state.h"
 
 static uint8_t *m228_prgROM;
 static uint8_t *m228_chrROM;
@@ -55,6 +56,14 @@ void m228init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	m228_CHRBank = 0;
 	m228_prgROMadd = 0;
 	m228_prgFull = true;
+	stateAddVar(m228_chrRAM);
+	stateAddVar(m228_regRAM);
+	stateAddVar(m228_PRGBank);
+	stateAddVar(m228_CHRBank);
+	stateAddVar(m228_prgROMadd);
+	stateAddVar(m228_prgROMand);
+	stateAddVar(m228_chrROMand);
+	stateAddVar(m228_prgFull);
 	printf("Mapper 228 inited\n");
 }
 
@@ -11,6 +11,7 @@
 #include <string.h>
 #include "../ppu.h"
 #include "../mapper.h"
+#include "../state.h"
 
 static uint8_t *m32_prgROM;
 static uint8_t *m32_prgRAM;
@@ -54,6 +55,11 @@ void m32init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	m32_prgMode = 0;
 	if(m32_singlescreen)
 		ppuSetNameTblSingleLower();
+	stateAddVar(m32_prgROMand);
+	stateAddVar(m32_chrROMand);
+	stateAddVar(m32_PRGBank);
+	stateAddVar(m32_CHRBank);
+	stateAddVar(m32_prgMode);
 	printf("Mapper 32 inited\n");
 }
 
@@ -12,6 +12,7 @@
 #include "../cpu.h"
 #include "../ppu.h"
 #include "../mapper.h"
+#include "../state.h"
 
 static uint8_t *m4_prgROM;
 static uint8_t *m4_prgRAM;
@@ -84,6 +85,23 @@ void m4init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	m4_prevAddr = 0;
 	m4_prgROMadd = 0;
 	m4_chrROMadd = 0;
+	stateAddVar(m4_chrRAM);
+	stateAddVar(m4_curPRGBank0);
+	stateAddVar(m4_curPRGBank1);
+	stateAddVar(m4_CHRBank);
+	stateAddVar(m4_writeAddr);
+	stateAddVar(m4_chr_bank_flip);
+	stateAddVar(m4_prg_bank_flip);
+	stateAddVar(m4_irqCtr);
+	stateAddVar(m4_irqEnable);
+	stateAddVar(m4_clear);
+	stateAddVar(m4_irqReloadVal);
+	stateAddVar(m4_irqStart);
+	stateAddVar(m4_prevAddr);
+	stateAddVar(m4_prgROMadd);
+	stateAddVar(m4_chrROMadd);
+	stateAddVar(m4_prgROMand);
+	stateAddVar(m4_chrROMand);
 	printf("Mapper 4 inited\n");
 }
 
@@ -98,6 +116,8 @@ void m12init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	m4_chrROMand = 0x3FFFF; //forced CHR size
 	m12_chrROMadd0 = 0;
 	m12_chrROMadd1 = 0;
+	stateAddVar(m12_chrROMadd0);
+	stateAddVar(m12_chrROMadd1);
 	printf("Mapper 12 (Pirate Mapper 4) inited\n");
 }
 
@@ -108,6 +128,7 @@ void m118init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 {
 	m4init(prgROMin, prgROMsizeIn, prgRAMin, prgRAMsizeIn, chrROMin, chrROMsizeIn);
 	memset(m118nt,0,6*sizeof(uint16_t));
+	stateAddVar(m118nt);
 	printf("Mapper 118 (Mapper 4 Variant) inited\n");
 }
 
@@ -146,6 +167,20 @@ uint8_t m4get8(uint16_t addr, uint8_t val)
 	return val;
 }
 
+uint16_t m4prgBank(uint16_t addr)
+{
+	uint32_t bank;
+	if(addr < 0xA000)
+		bank = m4_prg_bank_flip ? m4_lastM1PRGBank : (m4_curPRGBank0<<13);
+	else if(addr < 0xC000)
+		bank = m4_curPRGBank1<<13;
+	else if(addr < 0xE000)
+		bank = m4_prg_bank_flip ? (m4_curPRGBank0<<13) : m4_lastM1PRGBank;
+	else
+		bank = m4_lastPRGBank;
+	return ((bank&m4_prgROMand)|m4_prgROMadd)>>13;
+}
+
 void m4set8(uint16_t addr, uint8_t val)
 {
 	if(addr >= 0x6000 && addr < 0x8000)
@@ -12,6 +12,7 @@
 #include "../cpu.h"
 #include "../ppu.h"
 #include "../mapper.h"
+#include "../state.h"
 
 static uint8_t *m48_prgROM;
 static uint8_t *m48_prgRAM;
@@ -77,6 +78,20 @@ void m48init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	m48_prevAddr = 0;
 	m48_prgROMadd = 0;
 	m48_chrROMadd = 0;
+	stateAddVar(m48_chrRAM);
+	stateAddVar(m48_curPRGBank0);
+	stateAddVar(m48_curPRGBank1);
+	stateAddVar(m48_CHRBank);
+	stateAddVar(m48_irqCtr);
+	stateAddVar(m48_irqEnable);
+	stateAddVar(m48_irqReloadVal);
+	stateAddVar(m48_irqCooldown);
+	stateAddVar(m48_irqStart);
+	stateAddVar(m48_prevAddr);
+	stateAddVar(m48_prgROMadd);
+	stateAddVar(m48_chrROMadd);
+	stateAddVar(m48_prgROMand);
+	stateAddVar(m48_chrROMand);
 	printf("Mapper 33/48 inited\n");
 }
 
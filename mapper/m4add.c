@@ -10,6 +10,7 @@
 #include <stdbool.h>
 #include "../ppu.h"
 #include "../mapper_h/m4.h"
+#include "../state.h"
 
 extern uint32_t m4_prgROMadd;
 extern uint32_t m4_chrROMadd;
@@ -28,6 +29,7 @@ void m37_init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	m4_chrROMadd = 0;
 	m4_chrROMand = 0x1FFFF;
 	m4add_regLock = false;
+	stateAddVar(m4add_regLock);
 	printf("Mapper 37 (Mapper 4 Game Select) inited\n");
 }
 
@@ -42,6 +44,7 @@ void m44_init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	m4_chrROMadd = 0;
 	m4_chrROMand = 0x1FFFF;
 	m4add_regLock = false;
+	stateAddVar(m4add_regLock);
 	printf("Mapper 44 (Mapper 4 Game Select) inited\n");
 }
 
@@ -59,6 +62,8 @@ void m45_init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	m4_chrROMand = 0x1FFFF;
 	m4add_regLock = false;
 	m45_curReg = 0;
+	stateAddVar(m4add_regLock);
+	stateAddVar(m45_curReg);
 	printf("Mapper 45 (Mapper 4 Game Select) inited\n");
 }
 
@@ -73,6 +78,7 @@ void m47_init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	m4_chrROMadd = 0;
 	m4_chrROMand = 0x1FFFF;
 	m4add_regLock = false;
+	stateAddVar(m4add_regLock);
 	printf("Mapper 47 (Mapper 4 Game Select) inited\n");
 }
 
@@ -95,6 +101,9 @@ void m49_init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	m49_prgreg = 0;
 	//for prg mode
 	m49_prgROM = prgROMin;
+	stateAddVar(m4add_regLock);
+	stateAddVar(m49_prgmode);
+	stateAddVar(m49_prgreg);
 	printf("Mapper 49 (Mapper 4 Game Select) inited\n");
 }
 
@@ -109,6 +118,7 @@ void m52_init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	m4_chrROMadd = 0;
 	m4_chrROMand = 0x3FFFF;
 	m4add_regLock = false;
+	stateAddVar(m4add_regLock);
 	printf("Mapper 52 (Mapper 4 Game Select) inited\n");
 }
 
@@ -123,6 +133,7 @@ void m205_init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	m4_chrROMadd = 0;
 	m4_chrROMand = 0x3FFFF;
 	m4add_regLock = false;
+	stateAddVar(m4add_regLock);
 	printf("Mapper 205 (Mapper 4 Game Select) inited\n");
 }
 
@@ -13,6 +13,7 @@
 #include "../ppu.h"
 #include "../mapper.h"
 #include "../audio_mmc5.h"
+#include "../state.h"
 
 static uint8_t *m5_prgROM;
 static uint8_t *m5_prgRAM;
@@ -104,6 +105,36 @@ void m5init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	m5_prgRAMBank0add = 0;
 	memset(m5_prgRAMadd,0,4*sizeof(uint32_t));
 	mmc5AudioInit();
+	stateAddVar(m5_chrRAM);
+	stateAddVar(m5_VRAM);
+	stateAddVar(m5_exRAM);
+	stateAddVar(m5_PRGRAMBank0);
+	stateAddVar(m5_PRGBank);
+	stateAddVar(m5_PRGBankType);
+	stateAddVar(m5_CHRBank);
+	stateAddVar(m5_prg_bank_mode);
+	stateAddVar(m5_chr_bank_mode);
+	stateAddVar(m5_irqCtr);
+	stateAddVar(m5_irqVal);
+	stateAddVar(m5_fillTile);
+	stateAddVar(m5_fillAttr);
+	stateAddVar(m5_irqEnable);
+	stateAddVar(m5_inFrame);
+	stateAddVar(m5_irqPending);
+	stateAddVar(m5_chrSet);
+	stateAddVar(m5_split);
+	stateAddVar(m5_splitRight);
+	stateAddVar(m5_splitTile);
+	stateAddVar(m5_splitBank);
+	stateAddVar(m5_mulA);
+	stateAddVar(m5_mulB);
+	stateAddVar(m5_mulRes);
+	stateAddVar(m5_prgROMand);
+	stateAddVar(m5_prgRAMand);
+	stateAddVar(m5_chrROMand);
+	stateAddVar(m5_prgRAMBank0add);
+	stateAddVar(m5_prgRAMadd);
+	stateAddVar(m5_exMode);
 	printf("Mapper 5 inited\n");
 }
 
@@ -12,6 +12,7 @@
 #include "../cpu.h"
 #include "../ppu.h"
 #include "../mapper.h"
+#include "../state.h"
 
 static uint8_t *m65_prgROM;
 static uint8_t *m65_prgRAM;
@@ -56,6 +57,13 @@ void m65init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	m65_irqCtr = 0;
 	m65_irqReloadCtr = 0;
 	m65_irqEnable = false;
+	stateAddVar(m65_prgROMand);
+	stateAddVar(m65_chrROMand);
+	stateAddVar(m65_PRGBank);
+	stateAddVar(m65_CHRBank);
+	stateAddVar(m65_irqCtr);
+	stateAddVar(m65_irqReloadCtr);
+	stateAddVar(m65_irqEnable);
 	printf("Mapper 65 inited\n");
 }
 
@@ -11,6 +11,7 @@
 #include <string.h>
 #include "../ppu.h"
 #include "../mapper.h"
+#include "../state.h"
 
 static uint8_t *m7_prgROM;
 static uint8_t *m7_chrROM;
@@ -39,6 +40,9 @@ void m7init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	}
 	memset(m7_chrRAM,0,0x2000);
 	ppuSetNameTblSingleLower();
+	stateAddVar(m7_prgROMand);
+	stateAddVar(m7_curPRGBank);
+	stateAddVar(m7_chrRAM);
 	printf("Mapper 7 inited\n");
 }
 
@@ -49,6 +53,11 @@ uint8_t m7get8(uint16_t addr, uint8_t val)
 	return m7_prgROM[(m7_curPRGBank&~0x7FFF)+(addr&0x7FFF)];
 }
 
+uint16_t m7prgBank(uint16_t addr)
+{
+	return ((m7_curPRGBank&~0x7FFF)+(addr&0x7FFF))>>13;
+}
+
 void m7set8(uint16_t addr, uint8_t val)
 {
 	//printf("m7set8 %04x %02x\n", addr, val);
@@ -10,6 +10,7 @@
 #include <stdbool.h>
 #include "../ppu.h"
 #include "../mapper.h"
+#include "../state.h"
 
 static uint8_t *m9_prgROM;
 static uint8_t *m9_prgRAM;
@@ -48,6 +49,15 @@ void m9init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	m9_curCHRBank11 = 0;
 	m9_CHRSelect0 = 0;
 	m9_CHRSelect1 = 0;
+	stateAddVar(m9_prgROMand);
+	stateAddVar(m9_chrROMand);
+	stateAddVar(m9_curPRGBank);
+	stateAddVar(m9_curCHRBank00);
+	stateAddVar(m9_curCHRBank01);
+	stateAddVar(m9_curCHRBank10);
+	stateAddVar(m9_curCHRBank11);
+	stateAddVar(m9_CHRSelect0);
+	stateAddVar(m9_CHRSelect1);
 	printf("Mapper 9 inited, last bank=%04x\n", m9_lastPRGBank);
 }
 
@@ -14,6 +14,7 @@
 #include "../ppu.h"
 #include "../mapper.h"
 #include "../audio_n163.h"
+#include "../state.h"
 
 enum {
 	T_N163 = 0,
@@ -70,6 +71,19 @@ void namco_init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	namco_irqEnable = false;
 	namco_type = T_UNK;
 	ppuBackUpTbl();
+	stateAddVar(namco_curPRGBank0);
+	stateAddVar(namco_curPRGBank1);
+	stateAddVar(namco_curPRGBank2);
+	stateAddVar(namco_CHRBank);
+	stateAddVar(namco_VRAM);
+	stateAddVar(namco_CHRBankIsNT0);
+	stateAddVar(namco_CHRBankIsNT1);
+	stateAddVar(namco_NTAddr);
+	stateAddVar(namco_irqCtr);
+	stateAddVar(namco_irqEnable);
+	stateAddVar(namco_type);
+	stateAddVar(namco_prgROMand);
+	stateAddVar(namco_chrROMand);
 	printf("Namco Mapper inited\n");
 }
 
@@ -21,6 +21,7 @@
 #include "../audio_mmc5.h"
 #include "../audio_n163.h"
 #include "../audio_s5b.h"
+#include "../state.h"
 
 static uint8_t *nsf_prgROM;
 static uint8_t *nsf_prgRAM;
@@ -43,6 +44,8 @@ static uint8_t nsf_vrc7_audioReg;
 static uint8_t nsf_init_timeout;
 static uint8_t nsf_chrRAM[0x2000];
 static uint8_t nsf_MMC5ExRAM[0x400];
+static uint8_t nsf_mmc5_mul1 = 0, nsf_mmc5_mul2 = 0;
+static uint16_t nsf_mmc5_mulRes = 0;
 extern bool nesPAL;
 extern uint8_t audioExpansion;
 static uint8_t nsf_prevValReads[8];
@@ -127,6 +130,24 @@ void nsfinit(uint8_t *nsfBIN, uint32_t nsfBINsize, uint8_t *prgRAMin, uint32_t p
 	ppuDrawNSFTrackNum(nsf_curTrack, nsf_trackTotal);
 	inputInit();
 	nsfInitPlayback();
+	stateAddVar(nsf_FillRAM);
+	stateAddVar(nsf_InitPRGBank);
+	stateAddVar(nsf_InitRAMBank);
+	stateAddVar(nsf_PRGBank);
+	stateAddVar(nsf_RAMBank);
+	stateAddVar(nsf_curTrack);
+	stateAddVar(nsf_playing);
+	stateAddVar(nsf_init);
+	stateAddVar(nsf_vrc7_audioReg);
+	stateAddVar(nsf_init_timeout);
+	stateAddVar(nsf_chrRAM);
+	stateAddVar(nsf_MMC5ExRAM);
+	stateAddVar(nsf_prevValReads);
+	stateAddVar(nsf_startPlayback);
+	stateAddVar(nsf_endPlayback);
+	stateAddVar(nsf_mmc5_mul1);
+	stateAddVar(nsf_mmc5_mul2);
+	stateAddVar(nsf_mmc5_mulRes);
 }
 
 static uint32_t nsfgetromAddr(uint16_t addr)
@@ -173,9 +194,6 @@ static uint32_t nsfgetromAddr(uint16_t addr)
 	return romAddr;
 }
 
-static uint8_t nsf_mmc5_mul1 = 0, nsf_mmc5_mul2 = 0;
-static uint16_t nsf_mmc5_mulRes = 0;
-
 uint8_t nsfget8(uint16_t addr, uint8_t val)
 {
 	uint8_t aExp = audioExpansion;
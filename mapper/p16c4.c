@@ -11,6 +11,7 @@
 #include <string.h>
 #include "../ppu.h"
 #include "../mapper.h"
+#include "../state.h"
 
 static uint8_t *p16c4_prgROM;
 static uint8_t *p16c4_chrROM;
@@ -53,6 +54,12 @@ void p16c4init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	}
 	p16c4_curCHRBank0 = 0;
 	p16c4_curCHRBank1 = 0;
+	stateAddVar(p16c4_prgROMand);
+	stateAddVar(p16c4_chrROMand);
+	stateAddVar(p16c4_curPRGBank);
+	stateAddVar(p16c4_curCHRBank0);
+	stateAddVar(p16c4_curCHRBank1);
+	stateAddVar(p16c4_chrRAM);
 	printf("16k PRG 4k CHR Mapper inited\n");
 }
 
@@ -11,6 +11,7 @@
 #include <string.h>
 #include "../ppu.h"
 #include "../mapper.h"
+#include "../state.h"
 
 static uint8_t *p16c8_prgROM;
 static uint8_t *p16c8_chrROM;
@@ -55,6 +56,14 @@ void p16c8init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	p16c8_curCHRBank = 0;
 	p1632_p16 = false;
 	m57_regA = 0, m57_regB = 0;
+	stateAddVar(p16c8_prgROMand);
+	stateAddVar(p16c8_chrROMand);
+	stateAddVar(p16c8_curPRGBank);
+	stateAddVar(p16c8_curCHRBank);
+	stateAddVar(p1632_p16);
+	stateAddVar(p16c8_chrRAM);
+	stateAddVar(m57_regA);
+	stateAddVar(m57_regB);
 	printf("16k PRG 8k CHR Mapper inited\n");
 }
 
@@ -72,6 +81,10 @@ void m60_init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	m60_state = 0;
 	m60_prgROMadd = 0;
 	m60_chrROMadd = 0;
+	stateAddVar(m60_ready);
+	stateAddVar(m60_state);
+	stateAddVar(m60_prgROMadd);
+	stateAddVar(m60_chrROMadd);
 }
 
 
@@ -102,6 +115,20 @@ uint8_t p1632c8get8(uint16_t addr, uint8_t val)
 	return p16c8_prgROM[((p16c8_curPRGBank&~0x7FFF)+(addr&0x7FFF))&p16c8_prgROMand];
 }
 
+uint16_t p16c8prgBank(uint16_t addr)
+{
+	if(addr < 0xC000)
+		return (((p16c8_curPRGBank&~0x3FFF)+(addr&0x3FFF))&p16c8_prgROMand)>>13;
+	return (((p16c8_lastPRGBank&~0x3FFF)+(addr&0x3FFF))&p16c8_prgROMand)>>13;
+}
+
+uint16_t p1632c8prgBank(uint16_t addr)
+{
+	if(p1632_p16)
+		return (((p16c8_curPRGBank&~0x3FFF)+(addr&0x3FFF))&p16c8_prgROMand)>>13;
+	return (((p16c8_curPRGBank&~0x7FFF)+(addr&0x7FFF))&p16c8_prgROMand)>>13;
+}
+
 uint8_t m60_get8(uint16_t addr, uint8_t val)
 {
 	if(addr < 0x8000)
@@ -11,6 +11,7 @@
 #include <string.h>
 #include "../ppu.h"
 #include "../mapper.h"
+#include "../state.h"
 
 static uint8_t *p32c4_prgROM;
 static uint8_t *p32c4_prgRAM;
@@ -50,6 +51,12 @@ void p32c4init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	}
 	p32c4_curCHRBank0 = 0;
 	p32c4_curCHRBank1 = 0;
+	stateAddVar(p32c4_chrRAM);
+	stateAddVar(p32c4_prgROMand);
+	stateAddVar(p32c4_chrROMand);
+	stateAddVar(p32c4_curPRGBank);
+	stateAddVar(p32c4_curCHRBank0);
+	stateAddVar(p32c4_curCHRBank1);
 	printf("32k PRG 4k CHR Mapper inited\n");
 }
 
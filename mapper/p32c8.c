@@ -11,6 +11,7 @@
 #include <string.h>
 #include "../ppu.h"
 #include "../mapper.h"
+#include "../state.h"
 
 static uint8_t *p32c8_prgROM;
 static uint8_t *p32c8_prgRAM;
@@ -54,6 +55,14 @@ void p32c8init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	m36_regstat = 0;
 	m36_mode = 0;
 	m41_inner = false;
+	stateAddVar(p32c8_chrRAM);
+	stateAddVar(p32c8_prgROMand);
+	stateAddVar(p32c8_chrROMand);
+	stateAddVar(p32c8_curPRGBank);
+	stateAddVar(p32c8_curCHRBank);
+	stateAddVar(m36_regstat);
+	stateAddVar(m36_mode);
+	stateAddVar(m41_inner);
 	printf("32k PRG 8k CHR Mapper inited\n");
 }
 
@@ -10,6 +10,7 @@
 #include <inttypes.h>
 #include "../ppu.h"
 #include "../mapper.h"
+#include "../state.h"
 
 static uint8_t *p8c8_prgROM;
 static uint8_t *p8c8_prgRAM;
@@ -38,6 +39,11 @@ void p8c8init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	p8c8_curPRGBank = 0;
 	p8c8_curCHRBank = 0;
 	m185_CHRDisable = false;
+	stateAddVar(p8c8_prgROMand);
+	stateAddVar(p8c8_chrROMand);
+	stateAddVar(p8c8_curPRGBank);
+	stateAddVar(p8c8_curCHRBank);
+	stateAddVar(m185_CHRDisable);
 	printf("8k PRG 8k CHR Mapper inited\n");
 }
 
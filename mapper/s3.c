@@ -12,6 +12,7 @@
 #include "../cpu.h"
 #include "../ppu.h"
 #include "../mapper.h"
+#include "../state.h"
 
 static uint8_t *s3_prgROM;
 static uint8_t *s3_prgRAM;
@@ -54,6 +55,13 @@ void s3init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	s3_TmpWrite = false;
 	s3_enableRAM = false;
 	s3_irqCtrEnable = false;
+	stateAddVar(s3_prgROMand);
+	stateAddVar(s3_chrROMand);
+	stateAddVar(s3_curPRGBank);
+	stateAddVar(s3_CHRBank);
+	stateAddVar(s3_irqCtr);
+	stateAddVar(s3_TmpWrite);
+	stateAddVar(s3_irqCtrEnable);
 	printf("Sunsoft 3 Mapper inited\n");
 }
 
@@ -11,6 +11,7 @@
 #include <string.h>
 #include "../ppu.h"
 #include "../mapper.h"
+#include "../state.h"
 
 static uint8_t *s4_prgROM;
 static uint8_t *s4_prgRAM;
@@ -51,6 +52,14 @@ void s4init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	memset(s4_CHRVRAMBank,0,2*sizeof(uint32_t));
 	s4_enableRAM = false;
 	s4_chrVRAM = false;
+	stateAddVar(s4_prgROMand);
+	stateAddVar(s4_chrROMand);
+	stateAddVar(s4_VRAM);
+	stateAddVar(s4_curPRGBank);
+	stateAddVar(s4_CHRBank);
+	stateAddVar(s4_CHRVRAMBank);
+	stateAddVar(s4_enableRAM);
+	stateAddVar(s4_chrVRAM);
 	printf("Sunsoft 4 Mapper inited\n");
 }
 
@@ -13,6 +13,7 @@
 #include "../ppu.h"
 #include "../mapper.h"
 #include "../audio_s5b.h"
+#include "../state.h"
 
 static uint8_t *s5B_prgROM;
 static uint8_t *s5B_prgRAM;
@@ -62,6 +63,17 @@ void s5Binit(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	s5B_irqEnable = false;
 	s5B_irqCtrEnable = false;
 	s5BAudioInit();
+	stateAddVar(s5B_prgROMand);
+	stateAddVar(s5B_prgRAMand);
+	stateAddVar(s5B_chrROMand);
+	stateAddVar(s5B_PRGBank);
+	stateAddVar(s5B_CHRBank);
+	stateAddVar(s5B_irqCtr);
+	stateAddVar(s5B_CurReg);
+	stateAddVar(s5B_lowRAM);
+	stateAddVar(s5B_enableRAM);
+	stateAddVar(s5B_irqEnable);
+	stateAddVar(s5B_irqCtrEnable);
 	printf("Sunsoft 5B Mapper inited\n");
 }
 
@@ -10,6 +10,7 @@
 #include <inttypes.h>
 #include "../ppu.h"
 #include "../mapper.h"
+#include "../state.h"
 
 static uint8_t *vrc1_prgROM;
 static uint8_t *vrc1_prgRAM;
@@ -46,6 +47,13 @@ void vrc1init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	vrc1_curCHRBank0 = 0;
 	vrc1_curCHRBank1 = 0;
 	vrc1_prg_bank_flip = false;
+	stateAddVar(vrc1_curPRGBank0);
+	stateAddVar(vrc1_curPRGBank1);
+	stateAddVar(vrc1_curPRGBank2);
+	stateAddVar(vrc1_curCHRBank0);
+	stateAddVar(vrc1_curCHRBank1);
+	stateAddVar(vrc1_prgROMand);
+	stateAddVar(vrc1_chrROMand);
 	printf("vrc1 Mapper inited\n");
 }
 
@@ -12,6 +12,7 @@
 #include "../ppu.h"
 #include "../mapper.h"
 #include "../vrc_irq.h"
+#include "../state.h"
 
 static uint8_t *vrc2_4_prgROM;
 static uint8_t *vrc2_4_prgRAM;
@@ -47,6 +48,12 @@ void vrc2_4_init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	memset(vrc2_4_CHRBank, 0, 8*sizeof(uint32_t));
 	vrc2_4_prg_bank_flip = false;
 	vrc_irq_init();
+	stateAddVar(vrc2_4_curPRGBank0);
+	stateAddVar(vrc2_4_curPRGBank1);
+	stateAddVar(vrc2_4_CHRBank);
+	stateAddVar(vrc2_4_prgROMand);
+	stateAddVar(vrc2_4_chrROMand);
+	stateAddVar(vrc2_4_prg_bank_flip);
 	printf("vrc2/4 Mapper inited\n");
 }
 
@@ -12,6 +12,7 @@
 #include "../cpu.h"
 #include "../ppu.h"
 #include "../mapper.h"
+#include "../state.h"
 
 static uint8_t *vrc3_prgROM;
 static uint8_t *vrc3_prgRAM;
@@ -60,6 +61,14 @@ void vrc3init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	vrc3_irqEnable = false;
 	vrc3_irqEnable_after_ack = false;
 	vrc3_irq8Bit = false;
+	stateAddVar(vrc3_chrRAM);
+	stateAddVar(vrc3_curPRGBank);
+	stateAddVar(vrc3_prgROMand);
+	stateAddVar(vrc3_irqCtr);
+	stateAddVar(vrc3_irqReloadCtr);
+	stateAddVar(vrc3_irqEnable);
+	stateAddVar(vrc3_irqEnable_after_ack);
+	stateAddVar(vrc3_irq8Bit);
 	printf("vrc3 Mapper inited\n");
 }
 
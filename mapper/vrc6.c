@@ -13,6 +13,7 @@
 #include "../mapper.h"
 #include "../audio_vrc6.h"
 #include "../vrc_irq.h"
+#include "../state.h"
 
 static uint8_t *vrc6_prgROM;
 static uint8_t *vrc6_prgRAM;
@@ -47,6 +48,12 @@ void vrc6init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	vrc6_CHRMode = 0;
 	vrc_irq_init();
 	vrc6AudioInit();
+	stateAddVar(vrc6_curPRGBank0);
+	stateAddVar(vrc6_curPRGBank1);
+	stateAddVar(vrc6_CHRBank);
+	stateAddVar(vrc6_CHRMode);
+	stateAddVar(vrc6_prgROMand);
+	stateAddVar(vrc6_chrROMand);
 	printf("VRC6 Mapper inited\n");
 }
 
@@ -13,6 +13,7 @@
 #include "../mapper.h"
 #include "../audio_vrc7.h"
 #include "../vrc_irq.h"
+#include "../state.h"
 
 static uint8_t *vrc7_prgROM;
 static uint8_t *vrc7_prgRAM;
@@ -59,6 +60,14 @@ void vrc7init(uint8_t *prgROMin, uint32_t prgROMsizeIn,
 	vrc7AudioInit();
 	vrc7_audioReg = 0;
 	vrc_irq_init();
+	stateAddVar(vrc7_chrRAM);
+	stateAddVar(vrc7_curPRGBank0);
+	stateAddVar(vrc7_curPRGBank1);
+	stateAddVar(vrc7_curPRGBank2);
+	stateAddVar(vrc7_CHRBank);
+	stateAddVar(vrc7_prgROMand);
+	stateAddVar(vrc7_chrROMand);
+	stateAddVar(vrc7_audioReg);
 	printf("vrc7 Mapper inited\n");
 }
 
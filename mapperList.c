@@ -43,18 +43,18 @@
 
 mapperList_t mapperList[256] = {
 	{ p32c8init,	p32c8get8,		m0_set8,		p32c8chrGet8,	p32c8chrSet8,	NULL,	NULL,	NULL },
-	{ m1init,		m1get8,			m1set8,			m1chrGet8,		m1chrSet8,		NULL,	NULL,	NULL },
-	{ p16c8init,	p16c8get8,		m2_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL },
+	{ m1init,		m1get8,			m1set8,			m1chrGet8,		m1chrSet8,		NULL,	NULL,	NULL,	m1prgBank },
+	{ p16c8init,	p16c8get8,		m2_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL,	p16c8prgBank },
 	{ p8c8init,		p8c8get8,		m3_set8,		p8c8chrGet8,	p8c8chrSet8,	NULL,	NULL,	NULL },
-	{ m4init,		m4get8,			m4set8,			m4chrGet8,		m4chrSet8,		NULL,	NULL,	m4cycle },
+	{ m4init,		m4get8,			m4set8,			m4chrGet8,		m4chrSet8,		NULL,	NULL,	m4cycle,	m4prgBank },
 	{ m5init,		m5get8,			m5set8,			m5chrGet8,		m5chrSet8,		m5vramGet8, m5vramSet8, m5cycle },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
-	{ m7init,		m7get8,			m7set8,			m7chrGet8,		m7chrSet8,		NULL,	NULL,	NULL },
+	{ m7init,		m7get8,			m7set8,			m7chrGet8,		m7chrSet8,		NULL,	NULL,	NULL,	m7prgBank },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ m9init,		m9get8,			m9set8,			m9chrGet8,		m9chrSet8,		NULL,	NULL,	NULL },
 	{ m10init,		m10get8,		m10set8,		m10chrGet8,		m10chrSet8,		NULL,	NULL,	NULL },
 	{ p32c8init,	p32c8get8,		m11_set8,		p32c8chrGet8,	p32c8chrSet8,	NULL,	NULL,	NULL },
-	{ m12init,		m4get8,			m12set8,		m12chrGet8,		m4chrSet8,		NULL,	NULL,	m4cycle },
+	{ m12init,		m4get8,			m12set8,		m12chrGet8,		m4chrSet8,		NULL,	NULL,	m4cycle,	m4prgBank },
 	{ m13init,		m13get8,		m13set8,		m13chrGet8,		m13chrSet8,		NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ m15init,		m15get8,		m15set8,		m15chrGet8,		m15chrSet8,		NULL,	NULL,	NULL },
@@ -79,32 +79,32 @@ mapperList_t mapperList[256] = {
 	{ p32c4init,	p32c4get8,		p32c4set8,		p32c4chrGet8,	p32c4chrSet8,	NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ p32c8init,	m36_p32c8get8,	m36_set8,		p32c8chrGet8,	p32c8chrSet8,	NULL,	NULL,	NULL },
-	{ m37_init,		m4get8,			m37_set8,		m4chrGet8,		m4chrSet8,		NULL,	NULL,	m4cycle },
+	{ m37_init,		m4get8,			m37_set8,		m4chrGet8,		m4chrSet8,		NULL,	NULL,	m4cycle,	m4prgBank },
 	{ p32c8init,	p32c8get8,		m38_set8,		p32c8chrGet8,	p32c8chrSet8,	NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ p32c8init,	p32c8get8,		m41_set8,		p32c8chrGet8,	p32c8chrSet8,	NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
-	{ m44_init,		m4get8,			m44_set8,		m4chrGet8,		m4chrSet8,		NULL,	NULL,	m4cycle },
-	{ m45_init,		m4get8,			m45_set8,		m4chrGet8,		m4chrSet8,		NULL,	NULL,	m4cycle },
+	{ m44_init,		m4get8,			m44_set8,		m4chrGet8,		m4chrSet8,		NULL,	NULL,	m4cycle,	m4prgBank },
+	{ m45_init,		m4get8,			m45_set8,		m4chrGet8,		m4chrSet8,		NULL,	NULL,	m4cycle,	m4prgBank },
 	{ p32c8init,	p32c8get8,		m46_set8,		p32c8chrGet8,	p32c8chrSet8,	NULL,	NULL,	NULL },
-	{ m47_init,		m4get8,			m47_set8,		m4chrGet8,		m4chrSet8,		NULL,	NULL,	m4cycle },
+	{ m47_init,		m4get8,			m47_set8,		m4chrGet8,		m4chrSet8,		NULL,	NULL,	m4cycle,	m4prgBank },
 	{ m48init,		m48get8,		m48set8,		m48chrGet8,		m48chrSet8,		NULL,	NULL,	m48cycle },
 	{ m49_init,		m49_get8,		m49_set8,		m4chrGet8,		m4chrSet8,		NULL,	NULL,	m4cycle },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
-	{ m52_init,		m4get8,			m52_set8,		m4chrGet8,		m4chrSet8,		NULL,	NULL,	m4cycle },
+	{ m52_init,		m4get8,			m52_set8,		m4chrGet8,		m4chrSet8,		NULL,	NULL,	m4cycle,	m4prgBank },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
-	{ m174_init,	p1632c8get8,	m57_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL },
-	{ p16c8init,	p1632c8get8,	m58_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL },
+	{ m174_init,	p1632c8get8,	m57_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL,	p1632c8prgBank },
+	{ p16c8init,	p1632c8get8,	m58_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL,	p1632c8prgBank },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ m60_init,		m60_get8,		m60_set8,		m60_chrGet8,	m60_chrSet8,	NULL,	NULL,	NULL },
-	{ p16c8init,	p1632c8get8,	m61_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL },
-	{ p16c8init,	p1632c8get8,	m62_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL },
+	{ p16c8init,	p1632c8get8,	m61_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL,	p1632c8prgBank },
+	{ p16c8init,	p1632c8get8,	m62_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL,	p1632c8prgBank },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ m65init,		m65get8,		m65set8,		m65chrGet8,		m65chrSet8,		NULL,	NULL,	m65cycle },
@@ -112,15 +112,15 @@ mapperList_t mapperList[256] = {
 	{ s3init,		s3get8,			s3set8,			s3chrGet8,		s3chrSet8,		NULL,	NULL,	s3cycle },
 	{ s4init,		s4get8,			s4set8,			s4chrGet8,		s4chrSet8,		s4vramGet8, s4vramSet8,	NULL },
 	{ s5Binit,		s5Bget8,		s5Bset8,		s5BchrGet8,		s5BchrSet8,		NULL,	NULL,	s5Bcycle },
-	{ p16c8init,	p16c8get8,		m70_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL },
-	{ p16c8init,	p16c8get8,		m71_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL },
+	{ p16c8init,	p16c8get8,		m70_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL,	p16c8prgBank },
+	{ p16c8init,	p16c8get8,		m71_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL,	p16c8prgBank },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ vrc3init,		vrc3get8,		vrc3set8,		vrc3chrGet8,	vrc3chrSet8,	NULL,	NULL,	vrc3cycle },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ vrc1init,		vrc1get8,		vrc1set8,		vrc1chrGet8,	vrc1chrSet8,	NULL,	NULL,	NULL },
 	{ m206init,		m206get8,		m206set8,		m76chrGet8,		m206chrSet8,	NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
-	{ p16c8init,	p16c8get8,		m78b_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL },
+	{ p16c8init,	p16c8get8,		m78b_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL,	p16c8prgBank },
 	{ p32c8init,	p32c8get8,		m79_set8,		p32c8chrGet8,	p32c8chrSet8,	NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
@@ -131,12 +131,12 @@ mapperList_t mapperList[256] = {
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ p8c8init,		p8c8get8,		m87_set8,		p8c8chrGet8,	p8c8chrSet8,	NULL,	NULL,	NULL },
 	{ m206init,		m206get8,		m206set8,		m88chrGet8,		m206chrSet8,	NULL,	NULL,	NULL },
-	{ p16c8init,	p16c8get8,		m89_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL },
+	{ p16c8init,	p16c8get8,		m89_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL,	p16c8prgBank },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
-	{ p16c8init,	p16c8get8,		m93_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL },
-	{ p16c8init,	p16c8get8,		m94_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL },
+	{ p16c8init,	p16c8get8,		m93_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL,	p16c8prgBank },
+	{ p16c8init,	p16c8get8,		m94_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL,	p16c8prgBank },
 	{ m206init,		m206get8,		m95set8,		m206chrGet8,	m206chrSet8,	NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ p16c8init,	m97_get8,		m97_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL },
@@ -160,8 +160,8 @@ mapperList_t mapperList[256] = {
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
-	{ m118init,		m4get8,			m118set8,		m4chrGet8,		m4chrSet8,		NULL,	NULL,	m4cycle },
-	{ m119init,		m4get8,			m4set8,			m119chrGet8,	m119chrSet8,	NULL,	NULL,	m4cycle },
+	{ m118init,		m4get8,			m118set8,		m4chrGet8,		m4chrSet8,		NULL,	NULL,	m4cycle,	m4prgBank },
+	{ m119init,		m4get8,			m4set8,			m119chrGet8,	m119chrSet8,	NULL,	NULL,	m4cycle,	m4prgBank },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
@@ -194,10 +194,10 @@ mapperList_t mapperList[256] = {
 	{ p8c8init,		p8c8get8,		m149_set8,		p8c8chrGet8,	p8c8chrSet8,	NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
-	{ p16c8init,	p16c8get8,		m152_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL },
+	{ p16c8init,	p16c8get8,		m152_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL,	p16c8prgBank },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ m206init,		m206get8,		m154set8,		m88chrGet8,		m206chrSet8,	NULL,	NULL,	NULL },
-	{ m1init,		m1get8,			m1set8,			m1chrGet8,		m1chrSet8,		NULL,	NULL,	NULL },
+	{ m1init,		m1get8,			m1set8,			m1chrGet8,		m1chrSet8,		NULL,	NULL,	NULL,	m1prgBank },
 	{ m156init,		m156get8,		m156set8,		m156chrGet8,	m156chrSet8,	NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
@@ -216,7 +216,7 @@ mapperList_t mapperList[256] = {
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
-	{ m174_init,	p1632c8get8,	m174_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL },
+	{ m174_init,	p1632c8get8,	m174_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL,	p1632c8prgBank },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
@@ -244,17 +244,17 @@ mapperList_t mapperList[256] = {
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ p16c8init,	m200_get8,		m200_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL },
 	{ p32c8init,	p32c8get8,		m201_set8,		p32c8chrGet8,	p32c8chrSet8,	NULL,	NULL,	NULL },
-	{ m174_init,	p1632c8get8,	m202_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL },
+	{ m174_init,	p1632c8get8,	m202_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL,	p1632c8prgBank },
 	{ p16c8init,	m200_get8,		m203_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
-	{ m205_init,	m4get8,			m205_set8,		m4chrGet8,		m4chrSet8,		NULL,	NULL,	m4cycle },
+	{ m205_init,	m4get8,			m205_set8,		m4chrGet8,		m4chrSet8,		NULL,	NULL,	m4cycle,	m4prgBank },
 	{ m206init,		m206get8,		m206set8,		m206chrGet8,	m206chrSet8,	NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ namco_init,	namco_get8,		namco_set8,		namco_chrGet8,	namco_chrSet8,	namco_vramGet8,	namco_vramSet8,	namco_cycle },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
-	{ m174_init,	p1632c8get8,	m212_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL },
+	{ m174_init,	p1632c8get8,	m212_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL,	p1632c8prgBank },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
@@ -268,7 +268,7 @@ mapperList_t mapperList[256] = {
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ m225init,		m225get8,		m225set8,		m225chrGet8,	m225chrSet8,	NULL,	NULL,	NULL },
-	{ p16c8init,	p1632c8get8,	m226_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL },
+	{ p16c8init,	p1632c8get8,	m226_set8,		p16c8chrGet8,	p16c8chrSet8,	NULL,	NULL,	NULL,	p1632c8prgBank },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
 	{ m228init,		m228get8,		m228set8,		m228chrGet8,	m228chrSet8,	NULL,	NULL,	NULL },
 	{ NULL,			NULL,			NULL,			NULL,			NULL,			NULL,	NULL,	NULL },
@@ -17,6 +17,7 @@ typedef struct _mapperList_t {
 	vramGet8FuncT vramGet8F;
 	vramSet8FuncT vramSet8F;
 	cycleFuncT cycleFuncF;
+	prgBankFuncT prgBankF;
 } mapperList_t;
 
 extern mapperList_t mapperList[256];
@@ -21,6 +21,7 @@ void m119init(uint8_t *prgROM, uint32_t prgROMsize,
 			uint8_t *prgRAM, uint32_t prgRAMsize,
 			uint8_t *chrROM, uint32_t chrROMsize);
 uint8_t m4get8(uint16_t addr, uint8_t val);
+uint16_t m4prgBank(uint16_t addr);
 void m4set8(uint16_t addr, uint8_t val);
 void m12set8(uint16_t addr, uint8_t val);
 void m118set8(uint16_t addr, uint8_t val);
@@ -19,6 +19,8 @@ void m174_init(uint8_t *prgROM, uint32_t prgROMsize,
 			uint8_t *chrROM, uint32_t chrROMsize);
 uint8_t p16c8get8(uint16_t addr, uint8_t val);
 uint8_t p1632c8get8(uint16_t addr, uint8_t val);
+uint16_t p16c8prgBank(uint16_t addr);
+uint16_t p1632c8prgBank(uint16_t addr);
 uint8_t m60_get8(uint16_t addr, uint8_t val);
 uint8_t m97_get8(uint16_t addr, uint8_t val);
 uint8_t m180_get8(uint16_t addr, uint8_t val);
@@ -13,8 +13,10 @@
 #include "ppu.h"
 #include "cpu.h"
 #include "input.h"
-#include "fm2play.h"
 #include "apu.h"
+#include "state.h"
+#include "dbg.h"
+#include "stats.h"
 
 static uint8_t Main_Mem[0x800];
 static uint8_t memLastVal;
@@ -23,6 +25,10 @@ void memInit()
 {
 	memset(Main_Mem,0,0x800);
 	memLastVal = 0;
+	uint8_t group = stateSetGroup(STATE_GROUP_RAM);
+	stateAddVar(Main_Mem);
+	stateAddVar(memLastVal);
+	stateSetGroup(group);
 }
 
 uint8_t memGet8(uint16_t addr)
@@ -30,9 +36,13 @@ uint8_t memGet8(uint16_t addr)
 	uint8_t val = memLastVal;
 	//printf("memGet8 %04x\n", addr);
 	if(addr >= 0x4020)
+	{
+		STATS_INC(STATS_MEM_GET_CART);
 		val = mapperGet8(addr, memLastVal);
+	}
 	else if(addr >= 0x4000)
 	{
+		STATS_INC(STATS_MEM_GET_IO);
 		if(addr == 0x4015)
 			val = apuGet8(0x15);
 		else if(addr == 0x4016)
@@ -44,9 +54,17 @@ uint8_t memGet8(uint16_t addr)
 			val &= ~0x1F; //player 2
 	}
 	else if(addr >= 0x2000)
+	{
+		STATS_INC(STATS_MEM_GET_PPU);
 		val = ppuGet8(addr&7);
+	}
 	else
+	{
+		STATS_INC(STATS_MEM_GET_RAM);
 		val = Main_Mem[addr&0x7FF];
+	}
+	//debugger traps, the ones from $4020 on wrap the mapper
+	DBG_LOW_GET8(addr, val);
 
 	memLastVal = val;
 	return val;
@@ -60,6 +78,7 @@ void memSet8(uint16_t addr, uint8_t val)
 	//printf("memSet8 %04x %02x\n", addr, val);
 	if(addr >= 0x4000)
 	{
+		STATS_INC(addr >= 0x4020 ? STATS_MEM_SET_CART : STATS_MEM_SET_IO);
 		//everything starting from 0x4000 has to
 		//go to mapper, even if used later on
 		mapperSet8(addr, val);
@@ -76,9 +95,16 @@ void memSet8(uint16_t addr, uint8_t val)
 			apuSet8(addr&0x1F, val);
 	}
 	else if(addr >= 0x2000)
+	{
+		STATS_INC(STATS_MEM_SET_PPU);
 		ppuSet8(addr&7, val);
+	}
 	else
+	{
+		STATS_INC(STATS_MEM_SET_RAM);
 		Main_Mem[addr&0x7FF] = val;
+	}
+	DBG_LOW_SET8(addr, val);
 	memLastVal = val;
 }
 
@@ -97,3 +123,9 @@ void memDumpMainMem()
 	#endif
 }
 
+//the 2k of internal ram, for frontends looking at it
+uint8_t *memGetMainMem()
+{
+	return Main_Mem;
+}
+
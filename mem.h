@@ -13,5 +13,6 @@ uint8_t memGet8(uint16_t addr);
 void memSet8(uint16_t addr, uint8_t val);
 void memSet16(uint16_t addr, uint16_t val);
 void memDumpMainMem();
+uint8_t *memGetMainMem();
 
 #endif
\ No newline at end of file
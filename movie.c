@@ -0,0 +1,370 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include "cpu.h"
+#include "movie.h"
+#if !defined(_WIN32) && (defined(__unix__) || defined(__APPLE__))
+#define MOVIE_MMAP 1
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/*
+ * Movie file layout:
+ * 32 byte header, magic, number of controller ports at 8,
+ * frame count at 12 and the prg+chr crc32 of the game at 16,
+ * then every frame is an event byte followed by one byte per
+ * port, bit n set means inValReads[n] held during that frame.
+ */
+#define MOVIE_MAGIC "FXNMOV01"
+#define MOVIE_HDR_SIZE 32
+#define MOVIE_MAX_PORTS 4
+
+//from input.c
+extern uint8_t inValReads[8];
+//from mapper/fds.c
+extern bool fdsSwitch;
+
+static const uint8_t *moviePlayData = NULL;
+static uint8_t *moviePlayBase = NULL;
+static size_t moviePlayBaseSize;
+static bool moviePlayMapped;
+static uint32_t moviePlayFrames, moviePlayPos;
+static uint32_t movieRecSize;
+
+static FILE *movieRecFile = NULL;
+static uint32_t movieRecFrames;
+static uint8_t movieRecEvents;
+
+static void moviePut32(uint8_t *p, uint32_t v)
+{
+	p[0] = v; p[1] = v>>8; p[2] = v>>16; p[3] = v>>24;
+}
+
+static uint32_t movieGet32(const uint8_t *p)
+{
+	return p[0] | (p[1]<<8) | (p[2]<<16) | ((uint32_t)p[3]<<24);
+}
+
+static void movieWriteHeader(FILE *f, uint8_t ports, uint32_t frames, uint32_t romCrc)
+{
+	uint8_t hdr[MOVIE_HDR_SIZE];
+	memset(hdr, 0, MOVIE_HDR_SIZE);
+	memcpy(hdr, MOVIE_MAGIC, 8);
+	hdr[8] = ports;
+	moviePut32(hdr+12, frames);
+	moviePut32(hdr+16, romCrc);
+	fwrite(hdr, 1, MOVIE_HDR_SIZE, f);
+}
+
+static void moviePlayFree()
+{
+	if(moviePlayBase)
+	{
+#if MOVIE_MMAP
+		if(moviePlayMapped)
+			munmap(moviePlayBase, moviePlayBaseSize);
+		else
+#endif
+			free(moviePlayBase);
+	}
+	moviePlayBase = NULL;
+	moviePlayData = NULL;
+}
+
+//whole file, mapped where possible
+static bool movieLoad(const char *path)
+{
+	FILE *f = fopen(path, "rb");
+	if(!f)
+	{
+		printf("Movie: Could not open %s\n", path);
+		return false;
+	}
+	moviePlayBase = NULL;
+#if MOVIE_MMAP
+	struct stat st;
+	if(fstat(fileno(f), &st) == 0 && st.st_size > 0)
+	{
+		void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+		if(map != MAP_FAILED)
+		{
+			moviePlayBase = map;
+			moviePlayBaseSize = st.st_size;
+			moviePlayMapped = true;
+		}
+	}
+#endif
+	if(!moviePlayBase)
+	{
+		fseek(f, 0, SEEK_END);
+		moviePlayBaseSize = ftell(f);
+		rewind(f);
+		moviePlayBase = malloc(moviePlayBaseSize);
+		moviePlayMapped = false;
+		if(moviePlayBase && fread(moviePlayBase, 1, moviePlayBaseSize, f) != moviePlayBaseSize)
+		{
+			free(moviePlayBase);
+			moviePlayBase = NULL;
+		}
+	}
+	fclose(f);
+	if(!moviePlayBase)
+	{
+		printf("Movie: Could not read %s\n", path);
+		return false;
+	}
+	if(moviePlayBaseSize < MOVIE_HDR_SIZE || memcmp(moviePlayBase, MOVIE_MAGIC, 8) != 0
+		|| moviePlayBase[8] == 0 || moviePlayBase[8] > MOVIE_MAX_PORTS)
+	{
+		printf("Movie: %s is no fixNES movie\n", path);
+		moviePlayFree();
+		return false;
+	}
+	movieRecSize = 1 + moviePlayBase[8];
+	//a recording cut short still plays what got written
+	moviePlayFrames = (moviePlayBaseSize - MOVIE_HDR_SIZE) / movieRecSize;
+	moviePlayData = moviePlayBase + MOVIE_HDR_SIZE;
+	moviePlayPos = 0;
+	return true;
+}
+
+//sets up events and input for the coming frame
+static void moviePlayNext()
+{
+	if(moviePlayPos >= moviePlayFrames)
+	{
+		printf("Movie: Playback finished after %u frames\n", moviePlayFrames);
+		moviePlayFree();
+		memset(inValReads, 0, 8);
+		return;
+	}
+	const uint8_t *rec = moviePlayData + moviePlayPos*movieRecSize;
+	moviePlayPos++;
+	if(rec[0] & MOVIE_EV_RESET)
+		cpuSoftReset();
+	if(rec[0] & MOVIE_EV_DISK)
+		fdsSwitch = true;
+	int i;
+	for(i = 0; i < 8; i++)
+		inValReads[i] = (rec[1] >> i) & 1;
+}
+
+bool moviePlay(const char *path, uint32_t romCrc)
+{
+	movieStop();
+	if(!movieLoad(path))
+		return false;
+	uint32_t movieCrc = movieGet32(moviePlayBase+16);
+	if(movieCrc && romCrc && movieCrc != romCrc)
+		printf("Movie: Recorded on CRC %08X, this is %08X, it may desync\n", movieCrc, romCrc);
+	printf("Movie: Playing %u frames from %s\n", moviePlayFrames, path);
+	moviePlayNext();
+	return true;
+}
+
+bool movieRecord(const char *path, uint32_t romCrc)
+{
+	movieStop();
+	movieRecFile = fopen(path, "wb");
+	if(!movieRecFile)
+	{
+		printf("Movie: Could not write %s\n", path);
+		return false;
+	}
+	//frame count filled in on stop
+	movieWriteHeader(movieRecFile, 1, 0, romCrc);
+	movieRecFrames = 0;
+	movieRecEvents = 0;
+	printf("Movie: Recording to %s\n", path);
+	return true;
+}
+
+//called at the end of every emulated frame
+void movieFrameDone()
+{
+	if(moviePlayData)
+		moviePlayNext();
+	else if(movieRecFile)
+	{
+		uint8_t rec[2];
+		int i;
+		rec[0] = movieRecEvents;
+		rec[1] = 0;
+		for(i = 0; i < 8; i++)
+			rec[1] |= (inValReads[i]&1) << i;
+		fwrite(rec, 1, 2, movieRecFile);
+		movieRecFrames++;
+		movieRecEvents = 0;
+	}
+}
+
+//the event already happened, it gets tied to the coming frame
+void movieEvent(uint8_t ev)
+{
+	if(movieRecFile)
+		movieRecEvents |= ev;
+}
+
+bool moviePlaying()
+{
+	return (moviePlayData != NULL);
+}
+
+void movieStop()
+{
+	moviePlayFree();
+	if(movieRecFile)
+	{
+		uint8_t cnt[4];
+		moviePut32(cnt, movieRecFrames);
+		fseek(movieRecFile, 12, SEEK_SET);
+		fwrite(cnt, 1, 4, movieRecFile);
+		fclose(movieRecFile);
+		movieRecFile = NULL;
+		printf("Movie: Recorded %u frames\n", movieRecFrames);
+	}
+}
+
+static bool movieConvertToFM2(const char *outPath)
+{
+	FILE *f = fopen(outPath, "w");
+	if(!f)
+	{
+		printf("Movie: Could not write %s\n", outPath);
+		return false;
+	}
+	uint8_t ports = movieRecSize-1;
+	fprintf(f, "version 3\nemuVersion 22020\nrerecordCount 0\npalFlag 0\nromFilename fixNES\n"
+		"romChecksum base64:AAAAAAAAAAAAAAAAAAAAAA==\nguid 00000000-0000-0000-0000-000000000000\n"
+		"fourscore 0\nport0 1\nport1 %i\nport2 0\n", ports > 1 ? 1 : 0);
+	static const char btns[] = "RLDUTSBA";
+	uint32_t i;
+	for(i = 0; i < moviePlayFrames; i++)
+	{
+		const uint8_t *rec = moviePlayData + i*movieRecSize;
+		int cmd = ((rec[0] & MOVIE_EV_RESET) ? 1 : 0) | ((rec[0] & MOVIE_EV_DISK) ? 8 : 0);
+		fprintf(f, "|%i|", cmd);
+		uint8_t p;
+		for(p = 0; p < 2; p++)
+		{
+			if(p < ports)
+			{
+				int b;
+				for(b = 0; b < 8; b++)
+					fputc(((rec[1+p] >> (7-b)) & 1) ? btns[b] : '.', f);
+			}
+			fputc('|', f);
+		}
+		fputs("|\n", f);
+	}
+	fclose(f);
+	printf("Movie: Wrote %u frames to %s\n", moviePlayFrames, outPath);
+	return true;
+}
+
+static uint8_t movieParseFM2Pad(const char **line)
+{
+	uint8_t val = 0;
+	int b = 0;
+	while(**line && **line != '|' && **line != '\n' && **line != '\r')
+	{
+		//RLDUTSBA, anything but space and dot is held
+		if(b < 8 && **line != ' ' && **line != '.')
+			val |= 1 << (7-b);
+		b++;
+		(*line)++;
+	}
+	if(**line == '|')
+		(*line)++;
+	return val;
+}
+
+static bool movieConvertFromFM2(const char *inPath, const char *outPath)
+{
+	FILE *in = fopen(inPath, "r");
+	if(!in)
+	{
+		printf("Movie: Could not open %s\n", inPath);
+		return false;
+	}
+	FILE *out = fopen(outPath, "wb");
+	if(!out)
+	{
+		printf("Movie: Could not write %s\n", outPath);
+		fclose(in);
+		return false;
+	}
+	uint8_t ports = 1;
+	uint32_t frames = 0;
+	bool headerDone = false;
+	char line[256];
+	while(fgets(line, sizeof(line), in))
+	{
+		if(line[0] != '|')
+		{
+			if(strncmp(line, "port1 1", 7) == 0)
+				ports = 2;
+			continue;
+		}
+		if(!headerDone)
+		{
+			movieWriteHeader(out, ports, 0, 0);
+			headerDone = true;
+		}
+		const char *c = line+1;
+		int cmd = atoi(c);
+		while(*c && *c != '|')
+			c++;
+		if(*c == '|')
+			c++;
+		uint8_t rec[3];
+		rec[0] = ((cmd & 1) ? MOVIE_EV_RESET : 0) | ((cmd & (4|8)) ? MOVIE_EV_DISK : 0);
+		if(cmd & 2) //no power cycle in here, closest is a reset
+			rec[0] |= MOVIE_EV_RESET;
+		rec[1] = movieParseFM2Pad(&c);
+		rec[2] = movieParseFM2Pad(&c);
+		fwrite(rec, 1, 1+ports, out);
+		frames++;
+	}
+	if(!headerDone)
+		movieWriteHeader(out, ports, 0, 0);
+	uint8_t cnt[4];
+	moviePut32(cnt, frames);
+	fseek(out, 12, SEEK_SET);
+	fwrite(cnt, 1, 4, out);
+	fclose(out);
+	fclose(in);
+	printf("Movie: Converted %u frames to %s\n", frames, outPath);
+	return true;
+}
+
+//fixNES movie to fm2 or fm2 to fixNES movie, going by the input
+bool movieConvert(const char *inPath, const char *outPath)
+{
+	FILE *f = fopen(inPath, "rb");
+	if(!f)
+	{
+		printf("Movie: Could not open %s\n", inPath);
+		return false;
+	}
+	char magic[8];
+	bool isMovie = (fread(magic, 1, 8, f) == 8 && memcmp(magic, MOVIE_MAGIC, 8) == 0);
+	fclose(f);
+	if(!isMovie)
+		return movieConvertFromFM2(inPath, outPath);
+	if(!movieLoad(inPath))
+		return false;
+	bool ret = movieConvertToFM2(outPath);
+	moviePlayFree();
+	return ret;
+}
@@ -0,0 +1,23 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#ifndef _movie_h_
+#define _movie_h_
+
+//things happening right before a frame besides input
+#define MOVIE_EV_RESET (1<<0)
+#define MOVIE_EV_DISK  (1<<1)
+
+bool moviePlay(const char *path, uint32_t romCrc);
+bool movieRecord(const char *path, uint32_t romCrc);
+void movieFrameDone();
+void movieEvent(uint8_t ev);
+bool moviePlaying();
+void movieStop();
+bool movieConvert(const char *inPath, const char *outPath);
+
+#endif
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "pacer.h"
+#if WINDOWS_BUILD
+#include <windows.h>
+#else
+#include <time.h>
+#include <errno.h>
+#endif
+
+//frames behind schedule before giving up on catching up
+#define PACER_MAX_BEHIND 4
+
+static uint64_t pacerPeriod;
+static uint64_t pacerDeadline;
+#if WINDOWS_BUILD
+static LARGE_INTEGER pacerFreq;
+#endif
+
+uint64_t pacerNow()
+{
+#if WINDOWS_BUILD
+	LARGE_INTEGER cur;
+	QueryPerformanceCounter(&cur);
+	return (uint64_t)((cur.QuadPart/pacerFreq.QuadPart)*1000000000ULL
+		+ ((cur.QuadPart%pacerFreq.QuadPart)*1000000000ULL)/pacerFreq.QuadPart);
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec*1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+static void pacerSleepUntil(uint64_t deadline)
+{
+#if WINDOWS_BUILD
+	uint64_t cur = pacerNow();
+	//Sleep is only ms accurate even with timeBeginPeriod,
+	//so sleep most of the way and yield out the rest
+	if(deadline > cur + 2000000ULL)
+		Sleep((DWORD)((deadline - cur) / 1000000ULL) - 1);
+	while(pacerNow() < deadline)
+		Sleep(0);
+#else
+	struct timespec ts;
+	ts.tv_sec = deadline / 1000000000ULL;
+	ts.tv_nsec = deadline % 1000000000ULL;
+	while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+		;
+#endif
+}
+
+void pacerInit(double fps)
+{
+#if WINDOWS_BUILD
+	QueryPerformanceFrequency(&pacerFreq);
+	timeBeginPeriod(1);
+#endif
+	pacerPeriod = (uint64_t)(1000000000.0 / fps);
+	pacerReset();
+}
+
+void pacerDeinit()
+{
+#if WINDOWS_BUILD
+	timeEndPeriod(1);
+#endif
+}
+
+void pacerReset()
+{
+	pacerDeadline = pacerNow() + pacerPeriod;
+}
+
+uint64_t pacerGetPeriod()
+{
+	return pacerPeriod;
+}
+
+void pacerWait()
+{
+	uint64_t cur = pacerNow();
+	//deadlines are absolute so oversleeping one frame
+	//gets made up on the next instead of adding up
+	if(cur < pacerDeadline)
+		pacerSleepUntil(pacerDeadline);
+	else if(cur - pacerDeadline > pacerPeriod*PACER_MAX_BEHIND)
+	{
+		//way too slow or were stopped, dont try to catch up
+		pacerDeadline = cur;
+	}
+	pacerDeadline += pacerPeriod;
+}
@@ -0,0 +1,20 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#ifndef _pacer_h_
+#define _pacer_h_
+
+#include <stdint.h>
+
+void pacerInit(double fps);
+void pacerDeinit();
+void pacerReset();
+void pacerWait();
+uint64_t pacerNow();
+uint64_t pacerGetPeriod();
+
+#endif
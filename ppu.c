@@ -11,6 +11,8 @@
 #include <string.h>
 #include "mapper.h"
 #include "ppu.h"
+#include "state.h"
+#include "stats.h"
 
 //certain optimizations were taken from nestopias ppu code,
 //thanks to the people from there for all that
@@ -57,6 +59,8 @@ bool ppu816Sprite = false;
 bool ppuInFrame = false;
 bool ppuScanlineDone = false;
 uint8_t ppuDrawnXTile = 0;
+//skips pixel output for frames nobody will see
+bool ppuSkipRender = false;
 
 //from main.c
 extern uint16_t textureImage[0xF000];
@@ -248,6 +252,15 @@ void ppuInit()
 	ppu.RunCycles = nesPAL ? ppuRunCyclesPAL : ppuRunCyclesNTSC;
 	ppu.OddNum = 0;
 	ppu.OddArr = nesPAL ? ppuOddArrPAL : ppuOddArrNTSC;
+	//the luts above never change, no need to snapshot them
+	uint8_t group = stateSetGroup(STATE_GROUP_PPU);
+	stateAdd(ppu.PALRAM2, (uint8_t*)(&ppu+1) - (uint8_t*)ppu.PALRAM2);
+	stateAddVar(ppu4Screen);
+	stateAddVar(ppu816Sprite);
+	stateAddVar(ppuInFrame);
+	stateAddVar(ppuScanlineDone);
+	stateAddVar(ppuDrawnXTile);
+	stateSetGroup(group);
 }
 
 extern uint8_t m5_exMode;
@@ -693,6 +706,13 @@ void ppuCycle()
 						if(line < VISIBLE_LINES) //needs a lot of optimization, takes a lot of cpu atm
 						{
 						do_render_pixel:
+							if(ppuSkipRender)
+							{
+								/* Frame wont be displayed, only sprite 0 hit has to be kept */
+								if(ppu.SprEnable && ppu.ToDraw && ppu.Sprites[0][9])
+									ppuDoSprites(ppu.BGEnable ? ppu.BGTiles[(dot + ppu.FineXScroll) & 15] : 0, dot);
+								goto add_dot;
+							}
 							/* Grab color to render from BG and Sprites */
 							curCol = ppu.BGEnable ? ppu.BGTiles[(dot + ppu.FineXScroll) & 15] : 0;
 							if(ppu.SprEnable) curCol = ppuDoSprites(curCol, dot);
@@ -1049,6 +1069,7 @@ bool ppuDrawDone()
 
 void ppuSet8(uint8_t reg, uint8_t val)
 {
+	STATS_INC(STATS_PPU_SET_2000+reg);
 	ppu.lastVal = val;
 	if(reg == 0)
 	{
@@ -1264,6 +1285,32 @@ void ppuDumpMem()
 	}
 }
 
+//for frontends looking at the ppu memory
+uint8_t *ppuGetVRAM()
+{
+	return ppu.VRAM;
+}
+
+uint8_t *ppuGetOAM()
+{
+	return ppu.OAM;
+}
+
+uint8_t *ppuGetPALRAM()
+{
+	return ppu.PALRAM;
+}
+
+uint16_t ppuGetCurLine()
+{
+	return ppu.curLine;
+}
+
+uint16_t ppuGetCurDot()
+{
+	return ppu.curDot;
+}
+
 uint16_t ppuGetCurVramAddr()
 {
 	return ppu.VramAddr;
@@ -16,6 +16,15 @@ void ppuSet8(uint8_t reg, uint8_t val);
 bool ppuNMI();
 void ppuDumpMem();
 uint16_t ppuGetCurVramAddr();
+uint16_t ppuGetCurLine();
+uint16_t ppuGetCurDot();
+uint8_t *ppuGetVRAM();
+uint8_t *ppuGetOAM();
+uint8_t *ppuGetPALRAM();
+
+#define PPU_VRAM_SIZE 0x1000
+#define PPU_OAM_SIZE 0x100
+#define PPU_PALRAM_SIZE 0x20
 
 void ppuSetNameTblSingleLower();
 void ppuSetNameTblSingleUpper();
@@ -32,5 +41,6 @@ uint8_t ppuVRAMGet8(uint16_t addr);
 void ppuVRAMSet8(uint16_t addr, uint8_t val);
 
 extern bool ppu4Screen;
+extern bool ppuSkipRender;
 
 #endif
@@ -0,0 +1,445 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include "cpu.h"
+#include "dbg.h"
+#include "mapper.h"
+#include "prof.h"
+
+/*
+ * Counts exactly how many cpu cycles every instruction takes, the
+ * cycles between two opcode fetches go to the pc of the first one.
+ * Pcs are kept together with the 8k prg bank mapped there, so code
+ * of different banks at the same address stays apart.
+ * Call stacks get followed through JSR/RTS and interrupts/RTI, each
+ * distinct stack is one node in a tree that also gets the cycles,
+ * so writing out folded stacks for flamegraphs is just a tree walk.
+ * A return pops every frame whose stack pointer it goes above, that
+ * keeps the stacks right when games play tricks with RTS.
+ * A short backwards loop that runs with the same A/X/Y over and
+ * over is taken as waiting for the next frame, the rest of every
+ * frame is counted as busy.
+ */
+#define PROF_MAX_NODES 0x10000
+//starting size of the bank and pc table, doubles when half full
+#define PROF_PC_SIZE 0x10000
+#define PROF_HASH_SIZE 0x20000
+#define PROF_MAX_DEPTH 64
+#define PROF_TOP_PCS 32
+//loop iterations in a row until it counts as idle
+#define PROF_IDLE_ITERS 4
+#define PROF_IDLE_SPAN 16
+
+//bank above the pc, interrupts get PROF_NMI and so on with this set
+#define PROF_KEY(bank, pc) (((uint32_t)(bank)<<16)|(pc))
+#define PROF_KEY_INT (1u<<31)
+#define PROF_KEY_NONE 0xFFFFFFFF
+
+typedef struct _prof_node_t {
+	uint32_t parent;
+	uint32_t addr;
+	uint64_t cycles;
+} prof_node_t;
+
+typedef struct _prof_pc_t {
+	uint32_t key;
+	uint64_t cycles;
+} prof_pc_t;
+
+typedef struct _prof_frame_t {
+	uint32_t node;
+	uint8_t sp;
+} prof_frame_t;
+
+bool profActive = false;
+static char profPath[1024];
+static prof_pc_t *profPcs = NULL;
+static uint32_t profPcSize, profPcNum;
+static prof_node_t *profNodes = NULL;
+static uint32_t *profHash = NULL;
+static uint32_t profNodeNum;
+static prof_frame_t profStack[PROF_MAX_DEPTH];
+static uint8_t profDepth;
+static uint32_t profCurNode;
+static uint8_t profPendingInt;
+
+static uint64_t profLastCycle;
+static uint16_t profLastPc;
+static uint32_t profLastKey;
+static uint8_t profLastOp;
+static uint32_t profLastNode;
+
+//idle loop detection
+static uint16_t profLoopLo, profLoopHi;
+static uint8_t profLoopA, profLoopX, profLoopY;
+static uint8_t profLoopIters;
+static uint32_t profLoopPending;
+static uint64_t profFrameStart, profFrameIdle;
+//cycles and idle cycles of every frame
+static uint32_t *profFrames = NULL;
+static uint32_t profFrameNum, profFrameAlloc;
+
+bool profStart(const char *path)
+{
+	profStop();
+	profPcs = malloc(PROF_PC_SIZE*sizeof(prof_pc_t));
+	profNodes = malloc(PROF_MAX_NODES*sizeof(prof_node_t));
+	profHash = malloc(PROF_HASH_SIZE*sizeof(uint32_t));
+	if(profPcs == NULL || profNodes == NULL || profHash == NULL)
+	{
+		printf("Prof: Could not allocate tables\n");
+		profStop();
+		return false;
+	}
+	memset(profHash, 0xFF, PROF_HASH_SIZE*sizeof(uint32_t));
+	memset(profPcs, 0xFF, PROF_PC_SIZE*sizeof(prof_pc_t));
+	profPcSize = PROF_PC_SIZE;
+	profPcNum = 0;
+	strncpy(profPath, path, sizeof(profPath)-1);
+	profPath[sizeof(profPath)-1] = '\0';
+	//node 0 is whatever runs outside of any call
+	profNodes[0].parent = 0;
+	profNodes[0].addr = 0;
+	profNodes[0].cycles = 0;
+	profNodeNum = 1;
+	profDepth = 0;
+	profCurNode = 0;
+	profPendingInt = 0;
+	profLastCycle = cpuGetCycles();
+	profLastPc = cpuGetPc();
+	profLastKey = PROF_KEY(mapperGetPrgBank(profLastPc), profLastPc);
+	profLastOp = 0xEA;
+	profLastNode = 0;
+	profLoopIters = 0;
+	profLoopPending = 0;
+	profLoopLo = profLoopHi = 0;
+	profFrameStart = profLastCycle;
+	profFrameIdle = 0;
+	profFrameNum = 0;
+	profFrameAlloc = 0;
+	profActive = true;
+	printf("Prof: Profiling into %s\n", path);
+	return true;
+}
+
+static uint32_t profPcHash(uint32_t key, uint32_t size)
+{
+	uint32_t h = (key*0x9E3779B1u) & (size-1);
+	while(profPcs[h].key != PROF_KEY_NONE && profPcs[h].key != key)
+		h = (h+1) & (size-1);
+	return h;
+}
+
+static void profPcAdd(uint32_t key, uint32_t cycles)
+{
+	uint32_t h = profPcHash(key, profPcSize);
+	if(profPcs[h].key == PROF_KEY_NONE)
+	{
+		//keep it at most half full, when that fails the counts just stop growing
+		if(profPcNum >= profPcSize/2)
+		{
+			uint32_t i, newSize = profPcSize*2;
+			prof_pc_t *old = profPcs;
+			prof_pc_t *pcs = malloc(newSize*sizeof(prof_pc_t));
+			if(pcs == NULL)
+				return;
+			memset(pcs, 0xFF, newSize*sizeof(prof_pc_t));
+			profPcs = pcs;
+			for(i = 0; i < profPcSize; i++)
+			{
+				if(old[i].key != PROF_KEY_NONE)
+					profPcs[profPcHash(old[i].key, newSize)] = old[i];
+			}
+			free(old);
+			profPcSize = newSize;
+			h = profPcHash(key, profPcSize);
+		}
+		profPcs[h].key = key;
+		profPcs[h].cycles = 0;
+		profPcNum++;
+	}
+	profPcs[h].cycles += cycles;
+}
+
+static uint32_t profChild(uint32_t parent, uint32_t addr)
+{
+	uint32_t h = ((parent*0x9E3779B1u) ^ (addr*0x85EBCA77u)) & (PROF_HASH_SIZE-1);
+	while(profHash[h] != 0xFFFFFFFF)
+	{
+		prof_node_t *n = &profNodes[profHash[h]];
+		if(n->parent == parent && n->addr == addr)
+			return profHash[h];
+		h = (h+1) & (PROF_HASH_SIZE-1);
+	}
+	//out of nodes, the caller just gets it all
+	if(profNodeNum == PROF_MAX_NODES)
+		return parent;
+	profNodes[profNodeNum].parent = parent;
+	profNodes[profNodeNum].addr = addr;
+	profNodes[profNodeNum].cycles = 0;
+	profHash[h] = profNodeNum;
+	return profNodeNum++;
+}
+
+static void profPush(uint32_t addr, uint8_t sp)
+{
+	profCurNode = profChild(profCurNode, addr);
+	if(profDepth < PROF_MAX_DEPTH)
+	{
+		profStack[profDepth].node = profCurNode;
+		profStack[profDepth].sp = sp;
+		profDepth++;
+	}
+}
+
+static void profPop(uint16_t sp)
+{
+	while(profDepth && profStack[profDepth-1].sp <= sp)
+		profDepth--;
+	profCurNode = profDepth ? profStack[profDepth-1].node : 0;
+}
+
+//called by the cpu when it starts an interrupt
+void profInterrupt(uint8_t kind)
+{
+	profPendingInt = kind;
+}
+
+static bool profIsJump(uint8_t op)
+{
+	//all branches, JMP abs and JMP ind
+	return ((op&0x1F) == 0x10 || op == 0x4C || op == 0x6C);
+}
+
+static void profIdle(const cpuRegs_t *r, uint32_t delta)
+{
+	uint16_t pc = r->pc;
+	//landed on a short loop start again, same loop with the same registers
+	if(profIsJump(profLastOp) && pc < profLastPc && profLastPc-pc <= PROF_IDLE_SPAN)
+	{
+		if(pc == profLoopLo && r->a == profLoopA && r->x == profLoopX && r->y == profLoopY)
+		{
+			if(profLoopIters < PROF_IDLE_ITERS)
+			{
+				profLoopIters++;
+				if(profLoopIters == PROF_IDLE_ITERS)
+				{
+					profFrameIdle += profLoopPending;
+					profLoopPending = 0;
+				}
+			}
+		}
+		else
+		{
+			profLoopLo = pc;
+			profLoopHi = profLastPc;
+			profLoopA = r->a;
+			profLoopX = r->x;
+			profLoopY = r->y;
+			profLoopIters = 0;
+			profLoopPending = 0;
+		}
+	}
+	if(profLastPc >= profLoopLo && profLastPc <= profLoopHi)
+	{
+		if(profLoopIters == PROF_IDLE_ITERS)
+			profFrameIdle += delta;
+		else
+			profLoopPending += delta;
+	}
+}
+
+//called right after the opcode fetch, before anything executes
+void profInstr(uint8_t op)
+{
+	cpuRegs_t r;
+	uint64_t now = cpuGetCycles();
+	uint32_t delta = now - profLastCycle;
+	uint8_t lo = 0, hi = 0;
+	cpuGetRegs(&r);
+	profPcAdd(profLastKey, delta);
+	profNodes[profLastNode].cycles += delta;
+	profIdle(&r, delta);
+	profLastCycle = now;
+	if(profPendingInt)
+	{
+		//3 bytes got pushed, the RTI takes them again
+		profPush(PROF_KEY_INT|profPendingInt, r.s+3);
+		profPendingInt = 0;
+	}
+	profLastNode = profCurNode;
+	if(op == 0x20)
+	{
+		dbgPeek8(r.pc+1, &lo);
+		dbgPeek8(r.pc+2, &hi);
+		profPush(PROF_KEY(mapperGetPrgBank(lo | (hi<<8)), lo | (hi<<8)), r.s);
+	}
+	else if(op == 0x00)
+		profPendingInt = PROF_BRK;
+	else if(op == 0x60)
+		profPop(r.s+2);
+	else if(op == 0x40)
+		profPop(r.s+3);
+	profLastPc = r.pc;
+	profLastKey = PROF_KEY(mapperGetPrgBank(r.pc), r.pc);
+	profLastOp = op;
+}
+
+void profFrame()
+{
+	uint64_t now = cpuGetCycles();
+	if(!profActive)
+		return;
+	if(profFrameNum == profFrameAlloc)
+	{
+		uint32_t *f = realloc(profFrames, (profFrameAlloc+0x1000)*2*sizeof(uint32_t));
+		if(f == NULL)
+			return;
+		profFrames = f;
+		profFrameAlloc += 0x1000;
+	}
+	profFrames[profFrameNum*2] = now - profFrameStart;
+	profFrames[profFrameNum*2+1] = (profFrameIdle < now - profFrameStart) ? profFrameIdle : now - profFrameStart;
+	profFrameNum++;
+	profFrameStart = now;
+	profFrameIdle = 0;
+	//a loop not yet seen as idle stays busy in the frame it ran
+	profLoopPending = 0;
+}
+
+static void profNodeName(uint32_t addr, char *out)
+{
+	static const char *intNames[] = { "NMI", "IRQ", "BRK" };
+	if(addr & PROF_KEY_INT)
+		strcpy(out, intNames[(addr&~PROF_KEY_INT)-1]);
+	else
+		sprintf(out, "%02X:%04X", addr>>16, addr&0xFFFF);
+}
+
+static void profWriteFolded(FILE *f)
+{
+	uint32_t path[PROF_MAX_DEPTH+1];
+	char name[16];
+	uint32_t i;
+	for(i = 0; i < profNodeNum; i++)
+	{
+		uint32_t n = i, len = 0;
+		if(!profNodes[i].cycles)
+			continue;
+		while(n && len < PROF_MAX_DEPTH)
+		{
+			path[len++] = profNodes[n].addr;
+			n = profNodes[n].parent;
+		}
+		fputs("main", f);
+		while(len--)
+		{
+			profNodeName(path[len], name);
+			fprintf(f, ";%s", name);
+		}
+		fprintf(f, " %" PRIu64 "\n", profNodes[i].cycles);
+	}
+}
+
+static void profWriteReport(FILE *f)
+{
+	uint64_t total = 0, busy = 0;
+	uint32_t i, j, top[PROF_TOP_PCS];
+	uint32_t topNum = 0;
+	double minBusy = 100.0, maxBusy = 0.0;
+	for(i = 0; i < profPcSize; i++)
+	{
+		if(profPcs[i].key == PROF_KEY_NONE || !profPcs[i].cycles)
+			continue;
+		total += profPcs[i].cycles;
+		//keep the hottest ones sorted
+		for(j = topNum; j > 0 && profPcs[top[j-1]].cycles < profPcs[i].cycles; j--)
+		{
+			if(j < PROF_TOP_PCS)
+				top[j] = top[j-1];
+		}
+		if(j < PROF_TOP_PCS)
+		{
+			top[j] = i;
+			if(topNum < PROF_TOP_PCS)
+				topNum++;
+		}
+	}
+	for(i = 0; i < profFrameNum; i++)
+	{
+		uint32_t cyc = profFrames[i*2], idle = profFrames[i*2+1];
+		double b = cyc ? 100.0*(cyc-idle)/cyc : 0.0;
+		busy += cyc-idle;
+		if(b < minBusy)
+			minBusy = b;
+		if(b > maxBusy)
+			maxBusy = b;
+	}
+	fprintf(f, "%" PRIu64 " cycles in %u frames\n", total, profFrameNum);
+	if(profFrameNum)
+	{
+		uint64_t frameTotal = 0;
+		for(i = 0; i < profFrameNum; i++)
+			frameTotal += profFrames[i*2];
+		fprintf(f, "busy before the idle loop: %.1f%% average, %.1f%% min, %.1f%% max\n",
+			frameTotal ? 100.0*busy/frameTotal : 0.0, minBusy, maxBusy);
+	}
+	fprintf(f, "\nhottest instructions, bank:pc:\n");
+	for(i = 0; i < topNum; i++)
+		fprintf(f, "%02X:%04X %12" PRIu64 " %5.1f%%\n", profPcs[top[i]].key>>16, profPcs[top[i]].key&0xFFFF,
+			profPcs[top[i]].cycles, 100.0*profPcs[top[i]].cycles/total);
+	fprintf(f, "\nframe cycles busy%%\n");
+	for(i = 0; i < profFrameNum; i++)
+	{
+		uint32_t cyc = profFrames[i*2], idle = profFrames[i*2+1];
+		fprintf(f, "%u %u %.1f\n", i, cyc, cyc ? 100.0*(cyc-idle)/cyc : 0.0);
+	}
+}
+
+void profStop()
+{
+	if(profActive)
+	{
+		char foldedPath[1040];
+		FILE *f = fopen(profPath, "w");
+		if(f)
+		{
+			profWriteReport(f);
+			fclose(f);
+		}
+		else
+			printf("Prof: Could not write %s\n", profPath);
+		sprintf(foldedPath, "%s.folded", profPath);
+		f = fopen(foldedPath, "w");
+		if(f)
+		{
+			profWriteFolded(f);
+			fclose(f);
+		}
+		else
+			printf("Prof: Could not write %s\n", foldedPath);
+		printf("Prof: %u frames and %u call stacks written to %s\n", profFrameNum, profNodeNum, profPath);
+	}
+	profActive = false;
+	if(profPcs)
+		free(profPcs);
+	if(profNodes)
+		free(profNodes);
+	if(profHash)
+		free(profHash);
+	if(profFrames)
+		free(profFrames);
+	profPcs = NULL;
+	profNodes = NULL;
+	profHash = NULL;
+	profFrames = NULL;
+}
@@ -0,0 +1,24 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#ifndef _prof_h_
+#define _prof_h_
+
+#define PROF_NMI 1
+#define PROF_IRQ 2
+#define PROF_BRK 3
+
+//checked by the cpu on every instruction
+extern bool profActive;
+
+bool profStart(const char *path);
+void profStop();
+void profInstr(uint8_t op);
+void profInterrupt(uint8_t kind);
+void profFrame();
+
+#endif
@@ -0,0 +1,240 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include "state.h"
+#include "pacer.h"
+#include "rewind.h"
+
+/*
+ * Every interval frames the machine state gets xored with the
+ * one before it, that is mostly zeros from one frame to the next
+ * so it gets packed into zero runs and literals and put into a
+ * ring of fixed size, the oldest ones fall out when it is full.
+ * Going back is just undoing the newest one on the kept state.
+ * Every ring entry is the packed length, the data and the packed
+ * length again so it can be walked from both ends.
+ */
+#define REWIND_ENTRY_EXTRA 8
+
+static uint8_t *rewindRing = NULL;
+static uint32_t rewindRingSize;
+static uint32_t rewindHead, rewindTail, rewindUsed;
+static uint32_t rewindCount;
+//last captured state and scratch space
+static uint8_t *rewindCur = NULL, *rewindNew = NULL, *rewindPacked = NULL;
+static uint32_t rewindStateSize;
+static bool rewindHasCur;
+static uint8_t rewindInterval, rewindFrame;
+//for rewindPrintStats
+static uint32_t rewindCaptures;
+static uint64_t rewindPackedTotal;
+static uint64_t rewindCaptureTime;
+
+//token below 0x80 is that many zeros plus 1,
+//above is its low 7 bits plus 1 literals following
+static uint32_t rewindPack(const uint8_t *src, uint32_t size, uint8_t *dst)
+{
+	uint8_t *out = dst;
+	uint32_t i = 0;
+	while(i < size)
+	{
+		uint32_t n = 0;
+		while(i+n < size && n < 0x80 && src[i+n] == 0)
+			n++;
+		if(n)
+		{
+			*out++ = n-1;
+			i += n;
+			continue;
+		}
+		//a single zero is cheaper to keep as literal
+		while(i+n < size && n < 0x80 && (src[i+n] != 0 || (i+n+1 < size && src[i+n+1] != 0)))
+			n++;
+		*out++ = 0x80 | (n-1);
+		memcpy(out, src+i, n);
+		out += n;
+		i += n;
+	}
+	return out - dst;
+}
+
+static void rewindUnpackXor(const uint8_t *src, uint32_t len, uint8_t *dst)
+{
+	const uint8_t *end = src+len;
+	while(src < end)
+	{
+		uint8_t t = *src++;
+		if(t < 0x80)
+			dst += t+1;
+		else
+		{
+			uint8_t n = (t&0x7F)+1;
+			while(n--)
+				*dst++ ^= *src++;
+		}
+	}
+}
+
+static void rewindRingWrite(uint32_t pos, const uint8_t *src, uint32_t len)
+{
+	uint32_t first = rewindRingSize - pos;
+	if(first > len) first = len;
+	memcpy(rewindRing+pos, src, first);
+	memcpy(rewindRing, src+first, len-first);
+}
+
+static void rewindRingRead(uint32_t pos, uint8_t *dst, uint32_t len)
+{
+	uint32_t first = rewindRingSize - pos;
+	if(first > len) first = len;
+	memcpy(dst, rewindRing+pos, first);
+	memcpy(dst+first, rewindRing, len-first);
+}
+
+static uint32_t rewindRingPos(uint32_t pos, int32_t add)
+{
+	int64_t p = (int64_t)pos + add;
+	if(p < 0) p += rewindRingSize;
+	else if(p >= rewindRingSize) p -= rewindRingSize;
+	return p;
+}
+
+bool rewindInit(uint32_t ringSize, uint8_t interval)
+{
+	rewindDeinit();
+	rewindStateSize = stateSize();
+	if(!rewindStateSize || !interval)
+		return false;
+	rewindRing = malloc(ringSize);
+	rewindCur = malloc(rewindStateSize);
+	rewindNew = malloc(rewindStateSize);
+	//packing never grows more than a byte per 128
+	rewindPacked = malloc(rewindStateSize + rewindStateSize/128 + 1);
+	if(!rewindRing || !rewindCur || !rewindNew || !rewindPacked)
+	{
+		printf("Rewind: Could not allocate %u bytes\n", ringSize);
+		rewindDeinit();
+		return false;
+	}
+	rewindRingSize = ringSize;
+	rewindHead = rewindTail = rewindUsed = 0;
+	rewindCount = 0;
+	rewindHasCur = false;
+	rewindInterval = interval;
+	rewindFrame = 0;
+	rewindCaptures = 0;
+	rewindPackedTotal = 0;
+	rewindCaptureTime = 0;
+	printf("Rewind: %u KB ring, capturing every %i frames, %u bytes per state\n",
+		ringSize/1024, interval, rewindStateSize);
+	return true;
+}
+
+void rewindDeinit()
+{
+	if(rewindRing && rewindCaptures)
+		rewindPrintStats();
+	if(rewindRing) free(rewindRing);
+	if(rewindCur) free(rewindCur);
+	if(rewindNew) free(rewindNew);
+	if(rewindPacked) free(rewindPacked);
+	rewindRing = NULL;
+	rewindCur = NULL;
+	rewindNew = NULL;
+	rewindPacked = NULL;
+}
+
+static void rewindDropOldest()
+{
+	uint8_t lenBuf[4];
+	uint32_t len;
+	rewindRingRead(rewindTail, lenBuf, 4);
+	memcpy(&len, lenBuf, 4);
+	rewindTail = rewindRingPos(rewindTail, len+REWIND_ENTRY_EXTRA);
+	rewindUsed -= len+REWIND_ENTRY_EXTRA;
+	rewindCount--;
+}
+
+//called at the end of every emulated frame
+void rewindFrameDone()
+{
+	if(!rewindRing)
+		return;
+	if(++rewindFrame < rewindInterval)
+		return;
+	rewindFrame = 0;
+	uint64_t start = pacerNow();
+	stateSave(rewindNew);
+	if(rewindHasCur)
+	{
+		uint32_t i;
+		for(i = 0; i < rewindStateSize; i++)
+			rewindCur[i] ^= rewindNew[i];
+		uint32_t len = rewindPack(rewindCur, rewindStateSize, rewindPacked);
+		uint32_t need = len+REWIND_ENTRY_EXTRA;
+		if(need <= rewindRingSize)
+		{
+			while(rewindRingSize - rewindUsed < need)
+				rewindDropOldest();
+			uint8_t lenBuf[4];
+			memcpy(lenBuf, &len, 4);
+			rewindRingWrite(rewindHead, lenBuf, 4);
+			rewindRingWrite(rewindRingPos(rewindHead, 4), rewindPacked, len);
+			rewindRingWrite(rewindRingPos(rewindHead, len+4), lenBuf, 4);
+			rewindHead = rewindRingPos(rewindHead, need);
+			rewindUsed += need;
+			rewindCount++;
+		}
+		else //older ones cannot be reached without this one
+		{
+			rewindHead = rewindTail = rewindUsed = 0;
+			rewindCount = 0;
+		}
+		rewindPackedTotal += len;
+	}
+	//the new state is the one to go back from next
+	uint8_t *tmp = rewindCur;
+	rewindCur = rewindNew;
+	rewindNew = tmp;
+	rewindHasCur = true;
+	rewindCaptures++;
+	rewindCaptureTime += pacerNow() - start;
+}
+
+//goes back interval frames, false once the ring is empty
+bool rewindStep()
+{
+	if(!rewindRing || !rewindCount)
+		return false;
+	uint8_t lenBuf[4];
+	uint32_t len;
+	rewindRingRead(rewindRingPos(rewindHead, -4), lenBuf, 4);
+	memcpy(&len, lenBuf, 4);
+	rewindHead = rewindRingPos(rewindHead, -(int32_t)(len+REWIND_ENTRY_EXTRA));
+	rewindRingRead(rewindRingPos(rewindHead, 4), rewindPacked, len);
+	rewindUsed -= len+REWIND_ENTRY_EXTRA;
+	rewindCount--;
+	rewindUnpackXor(rewindPacked, len, rewindCur);
+	stateLoad(rewindCur);
+	rewindFrame = 0;
+	return true;
+}
+
+void rewindPrintStats()
+{
+	if(!rewindRing)
+		return;
+	uint32_t avg = rewindCaptures > 1 ? rewindPackedTotal/(rewindCaptures-1) : 0;
+	printf("Rewind: %u states back (%u frames) in %u of %u KB, %u bytes per state packed, %.1f us per capture\n",
+		rewindCount, rewindCount*rewindInterval, rewindUsed/1024, rewindRingSize/1024, avg,
+		rewindCaptures ? (double)rewindCaptureTime/rewindCaptures/1000.0 : 0.0);
+}
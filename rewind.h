@@ -0,0 +1,17 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#ifndef _rewind_h_
+#define _rewind_h_
+
+bool rewindInit(uint32_t ringSize, uint8_t interval);
+void rewindDeinit();
+void rewindFrameDone();
+bool rewindStep();
+void rewindPrintStats();
+
+#endif
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#if !RING_ATOMICS && defined(_MSC_VER)
+#include <windows.h>
+#endif
+#include "ring.h"
+
+#if RING_ATOMICS
+#define ringLoad(p) atomic_load_explicit(p, memory_order_acquire)
+#define ringStore(p, v) atomic_store_explicit(p, v, memory_order_release)
+#else
+#if defined(_MSC_VER)
+#define ringBarrier() MemoryBarrier()
+#else
+#define ringBarrier() __sync_synchronize()
+#endif
+static inline uint32_t ringLoad(ringPos_t *p)
+{
+	uint32_t v = *p;
+	ringBarrier();
+	return v;
+}
+static inline void ringStore(ringPos_t *p, uint32_t v)
+{
+	ringBarrier();
+	*p = v;
+}
+#endif
+
+bool ringInit(ring_t *r, uint32_t minSize, uint32_t unit)
+{
+	//power of two so positions can just wrap around
+	uint32_t size = 1;
+	while(size < minSize || size < unit)
+		size <<= 1;
+	r->buf = malloc(size);
+	if(!r->buf)
+		return false;
+	r->size = size;
+	r->unit = unit ? unit : 1;
+	ringStore(&r->rdPos, 0);
+	ringStore(&r->wrPos, 0);
+	return true;
+}
+
+void ringDeinit(ring_t *r)
+{
+	if(r->buf)
+		free(r->buf);
+	r->buf = NULL;
+	r->size = 0;
+}
+
+//only safe while neither side is active
+void ringClear(ring_t *r)
+{
+	ringStore(&r->rdPos, 0);
+	ringStore(&r->wrPos, 0);
+}
+
+uint32_t ringUsed(ring_t *r)
+{
+	return ringLoad(&r->wrPos) - ringLoad(&r->rdPos);
+}
+
+uint32_t ringWrite(ring_t *r, const uint8_t *src, uint32_t size)
+{
+	uint32_t wr = ringLoad(&r->wrPos);
+	uint32_t rd = ringLoad(&r->rdPos);
+	uint32_t space = r->size - (wr - rd);
+	if(size > space)
+		size = space;
+	size &= ~(r->unit-1);
+	uint32_t pos = wr & (r->size-1);
+	uint32_t first = r->size - pos;
+	if(first > size)
+		first = size;
+	memcpy(r->buf+pos, src, first);
+	memcpy(r->buf, src+first, size-first);
+	ringStore(&r->wrPos, wr+size);
+	return size;
+}
+
+uint32_t ringRead(ring_t *r, uint8_t *dst, uint32_t size)
+{
+	uint32_t rd = ringLoad(&r->rdPos);
+	uint32_t wr = ringLoad(&r->wrPos);
+	uint32_t avail = wr - rd;
+	if(size > avail)
+		size = avail;
+	uint32_t pos = rd & (r->size-1);
+	uint32_t first = r->size - pos;
+	if(first > size)
+		first = size;
+	memcpy(dst, r->buf+pos, first);
+	memcpy(dst+first, r->buf, size-first);
+	ringStore(&r->rdPos, rd+size);
+	return size;
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#ifndef _ring_h_
+#define _ring_h_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//msvc and pre-c11 compilers get volatile positions plus barriers
+#if !defined(_MSC_VER) && !defined(__STDC_NO_ATOMICS__) && defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#include <stdatomic.h>
+#define RING_ATOMICS 1
+typedef atomic_uint ringPos_t;
+#else
+#define RING_ATOMICS 0
+typedef volatile uint32_t ringPos_t;
+#endif
+
+//lock-free for exactly one writer and one reader thread
+typedef struct _ring_t {
+	uint8_t *buf;
+	uint32_t size;
+	uint32_t unit;
+	ringPos_t rdPos;
+	ringPos_t wrPos;
+} ring_t;
+
+//unit is the power of two every write gets rounded down to,
+//so a nearly full ring never splits a sample frame
+bool ringInit(ring_t *r, uint32_t minSize, uint32_t unit);
+void ringDeinit(ring_t *r);
+void ringClear(ring_t *r);
+uint32_t ringUsed(ring_t *r);
+uint32_t ringWrite(ring_t *r, const uint8_t *src, uint32_t size);
+uint32_t ringRead(ring_t *r, uint8_t *dst, uint32_t size);
+
+#endif
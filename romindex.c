@@ -0,0 +1,543 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include <ctype.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#if WINDOWS_BUILD
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+#if ZIPSUPPORT
+#include "unzip/unzip.h"
+#endif
+#include "rominfo.h"
+#include "romindex.h"
+#include "gamedb.h"
+
+/*
+ * Index file layout, all values little endian:
+ * header: magic, entry count, hash table size, then the file
+ *         offsets of the entries, crc table, name table and strings
+ * entries: ROM_INDEX_ENTRY_SIZE bytes each, see romIndexWrite
+ * tables: open addressing, each slot holds entry number+1, 0 is empty
+ * strings: zero terminated paths and names
+ */
+#define ROM_INDEX_MAGIC "FXNIDX02"
+#define ROM_INDEX_HDR_SIZE 32
+#define ROM_INDEX_ENTRY_SIZE 48
+#define ROM_INDEX_MAX_THREADS 64
+//links to directories are never followed, this only
+//guards against junction loops where there is no lstat
+#define ROM_INDEX_MAX_DEPTH 32
+
+typedef struct _romIndexRec_t {
+	romInfo_t info;
+	char *path;
+	char *name;
+	uint64_t zipPos;
+	uint32_t zipNum;
+} romIndexRec_t;
+
+//files found by the directory scan, handed out to the workers
+static char **romIndexFiles = NULL;
+static uint32_t romIndexFileNum, romIndexFileCap;
+static atomic_uint romIndexNext;
+
+//results of the workers
+static romIndexRec_t *romIndexRecs = NULL;
+static uint32_t romIndexRecNum, romIndexRecCap;
+static pthread_mutex_t romIndexMutex = PTHREAD_MUTEX_INITIALIZER;
+
+//currently opened index
+static uint8_t *romIndexData = NULL;
+static uint32_t romIndexDataSize;
+static uint32_t romIndexCount, romIndexTblSize;
+static uint32_t romIndexEntryOff, romIndexCrcOff, romIndexNameOff, romIndexStrOff;
+
+static void romIndexPut32(uint8_t *p, uint32_t v)
+{
+	p[0] = v; p[1] = v>>8; p[2] = v>>16; p[3] = v>>24;
+}
+
+static uint32_t romIndexGet32(const uint8_t *p)
+{
+	return p[0] | (p[1]<<8) | (p[2]<<16) | ((uint32_t)p[3]<<24);
+}
+
+static uint32_t romIndexHashName(const char *name)
+{
+	uint32_t h = 2166136261u;
+	while(*name)
+	{
+		h ^= (uint8_t)*name++;
+		h *= 16777619u;
+	}
+	return h;
+}
+
+//lowercase file name without its directory
+static char *romIndexKeyName(const char *path)
+{
+	const char *base = path;
+	if(strrchr(base,'/') != NULL)
+		base = strrchr(base,'/')+1;
+	if(strrchr(base,'\\') != NULL)
+		base = strrchr(base,'\\')+1;
+	char *name = strdup(base);
+	char *c;
+	for(c = name; *c; c++)
+		*c = tolower(*c);
+	return name;
+}
+
+static bool romIndexHasExt(const char *name, const char *ext)
+{
+	size_t nLen = strlen(name), eLen = strlen(ext);
+	return nLen > eLen && strcasecmp(name+nLen-eLen, ext) == 0;
+}
+
+static bool romIndexIsRom(const char *name)
+{
+	return romIndexHasExt(name, ".nes") || romIndexHasExt(name, ".nsf")
+		|| romIndexHasExt(name, ".fds") || romIndexHasExt(name, ".qd");
+}
+
+static void romIndexAddFile(const char *path)
+{
+	if(romIndexFileNum == romIndexFileCap)
+	{
+		romIndexFileCap = romIndexFileCap ? romIndexFileCap*2 : 256;
+		romIndexFiles = realloc(romIndexFiles, romIndexFileCap*sizeof(char*));
+	}
+	romIndexFiles[romIndexFileNum++] = strdup(path);
+}
+
+static void romIndexScan(const char *dir, uint8_t depth)
+{
+	if(depth > ROM_INDEX_MAX_DEPTH)
+	{
+		printf("Index: Not going deeper than %s\n", dir);
+		return;
+	}
+	DIR *d = opendir(dir);
+	if(!d)
+	{
+		printf("Index: Could not open %s\n", dir);
+		return;
+	}
+	struct dirent *ent;
+	while((ent = readdir(d)) != NULL)
+	{
+		if(strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0)
+			continue;
+		char path[4096];
+		snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name);
+		struct stat st;
+#if WINDOWS_BUILD
+		if(stat(path, &st) != 0)
+			continue;
+#else
+		if(lstat(path, &st) != 0)
+			continue;
+		//linked files get indexed, linked directories could loop
+		if(S_ISLNK(st.st_mode) && (stat(path, &st) != 0 || S_ISDIR(st.st_mode)))
+			continue;
+#endif
+		if(S_ISDIR(st.st_mode))
+			romIndexScan(path, depth+1);
+#if ZIPSUPPORT
+		else if(romIndexIsRom(path) || romIndexHasExt(path, ".zip"))
+#else
+		else if(romIndexIsRom(path))
+#endif
+			romIndexAddFile(path);
+	}
+	closedir(d);
+}
+
+static void romIndexAdd(const char *path, const char *entryName, uint64_t zipPos, uint32_t zipNum,
+						const uint8_t *data, uint32_t size)
+{
+	romIndexRec_t rec;
+	if(romIndexHasExt(entryName, ".nes"))
+	{
+		if(!romInfoParseNES(data, size, entryName, &rec.info))
+			return;
+	}
+	else
+		romInfoParseData(data, size, entryName, &rec.info);
+	rec.path = strdup(path);
+	rec.name = romIndexKeyName(entryName);
+	rec.zipPos = zipPos;
+	rec.zipNum = zipNum;
+	pthread_mutex_lock(&romIndexMutex);
+	if(romIndexRecNum == romIndexRecCap)
+	{
+		romIndexRecCap = romIndexRecCap ? romIndexRecCap*2 : 256;
+		romIndexRecs = realloc(romIndexRecs, romIndexRecCap*sizeof(romIndexRec_t));
+	}
+	romIndexRecs[romIndexRecNum++] = rec;
+	pthread_mutex_unlock(&romIndexMutex);
+}
+
+#if ZIPSUPPORT
+static void romIndexAddZip(const char *path, uint8_t **buf, uint32_t *bufSize)
+{
+	unzFile zip = unzOpen(path);
+	if(!zip)
+	{
+		printf("Index: Could not open %s\n", path);
+		return;
+	}
+	int err = unzGoToFirstFile(zip);
+	while(err == UNZ_OK)
+	{
+		char zName[256];
+		unz_file_info zInfo;
+		unz_file_pos zPos;
+		//zip64 entries can be past 4GB, no rom comes close
+		if(unzGetCurrentFileInfo(zip,&zInfo,zName,sizeof(zName),NULL,0,NULL,0) == UNZ_OK && romIndexIsRom(zName)
+			&& zInfo.uncompressed_size <= UINT32_MAX && unzGetFilePos(zip, &zPos) == UNZ_OK && unzOpenCurrentFile(zip) == UNZ_OK)
+		{
+			if(zInfo.uncompressed_size > *bufSize)
+			{
+				*bufSize = zInfo.uncompressed_size;
+				*buf = realloc(*buf, *bufSize);
+			}
+			int got = unzReadCurrentFile(zip, *buf, zInfo.uncompressed_size);
+			if(unzCloseCurrentFile(zip) == UNZ_OK && got == (int)zInfo.uncompressed_size)
+				romIndexAdd(path, zName, zPos.pos_in_zip_directory, zPos.num_of_file, *buf, got);
+			else
+				printf("Index: Damaged entry %s in %s\n", zName, path);
+		}
+		err = unzGoToNextFile(zip);
+	}
+	unzClose(zip);
+}
+#endif
+
+static void *romIndexWorker(void *arg)
+{
+	(void)arg;
+	uint8_t *buf = NULL;
+	uint32_t bufSize = 0;
+	while(1)
+	{
+		uint32_t i = atomic_fetch_add(&romIndexNext, 1);
+		if(i >= romIndexFileNum)
+			break;
+		const char *path = romIndexFiles[i];
+#if ZIPSUPPORT
+		if(romIndexHasExt(path, ".zip"))
+		{
+			romIndexAddZip(path, &buf, &bufSize);
+			continue;
+		}
+#endif
+		FILE *f = fopen(path, "rb");
+		if(!f)
+			continue;
+		fseek(f, 0, SEEK_END);
+		uint32_t size = ftell(f);
+		rewind(f);
+		if(size > bufSize)
+		{
+			bufSize = size;
+			buf = realloc(buf, bufSize);
+		}
+		if(fread(buf, 1, size, f) == size)
+			romIndexAdd(path, path, 0, ROM_INDEX_NO_ZIP, buf, size);
+		fclose(f);
+	}
+	free(buf);
+	return NULL;
+}
+
+static int romIndexThreadCount()
+{
+#if WINDOWS_BUILD
+	SYSTEM_INFO si;
+	GetSystemInfo(&si);
+	int num = si.dwNumberOfProcessors;
+#else
+	int num = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+	if(num < 1)
+		num = 1;
+	if(num > ROM_INDEX_MAX_THREADS)
+		num = ROM_INDEX_MAX_THREADS;
+	return num;
+}
+
+//sorted so the same romset always gives the same index
+static int romIndexRecCmp(const void *a, const void *b)
+{
+	const romIndexRec_t *ra = a, *rb = b;
+	int c = strcmp(ra->path, rb->path);
+	if(c)
+		return c;
+	return (ra->zipNum > rb->zipNum) - (ra->zipNum < rb->zipNum);
+}
+
+static bool romIndexWrite(const char *indexPath)
+{
+	uint32_t i, tblSize = 16;
+	while(tblSize < romIndexRecNum*2)
+		tblSize <<= 1;
+	uint32_t entryOff = ROM_INDEX_HDR_SIZE;
+	uint32_t crcOff = entryOff + romIndexRecNum*ROM_INDEX_ENTRY_SIZE;
+	uint32_t nameOff = crcOff + tblSize*4;
+	uint32_t strOff = nameOff + tblSize*4;
+	uint32_t strSize = 0;
+	for(i = 0; i < romIndexRecNum; i++)
+	{
+		if(i == 0 || strcmp(romIndexRecs[i].path, romIndexRecs[i-1].path) != 0)
+			strSize += strlen(romIndexRecs[i].path)+1;
+		strSize += strlen(romIndexRecs[i].name)+1;
+	}
+	uint32_t size = strOff + strSize;
+	uint8_t *out = calloc(1, size);
+	if(!out)
+		return false;
+	memcpy(out, ROM_INDEX_MAGIC, 8);
+	romIndexPut32(out+8, romIndexRecNum);
+	romIndexPut32(out+12, tblSize);
+	romIndexPut32(out+16, entryOff);
+	romIndexPut32(out+20, crcOff);
+	romIndexPut32(out+24, nameOff);
+	romIndexPut32(out+28, strOff);
+	uint32_t strPos = 0, pathPos = 0;
+	for(i = 0; i < romIndexRecNum; i++)
+	{
+		const romIndexRec_t *rec = &romIndexRecs[i];
+		//entries of one zip share the path string
+		if(i == 0 || strcmp(rec->path, romIndexRecs[i-1].path) != 0)
+		{
+			pathPos = strPos;
+			strcpy((char*)out+strOff+strPos, rec->path);
+			strPos += strlen(rec->path)+1;
+		}
+		uint32_t namePos = strPos;
+		strcpy((char*)out+strOff+strPos, rec->name);
+		strPos += strlen(rec->name)+1;
+
+		uint8_t *e = out + entryOff + i*ROM_INDEX_ENTRY_SIZE;
+		romIndexPut32(e, rec->info.crc);
+		romIndexPut32(e+4, rec->info.prgCrc);
+		romIndexPut32(e+8, rec->info.chrCrc);
+		romIndexPut32(e+12, rec->info.prgSize);
+		romIndexPut32(e+16, rec->info.chrSize);
+		romIndexPut32(e+20, pathPos);
+		romIndexPut32(e+24, namePos);
+		romIndexPut32(e+28, (uint32_t)rec->zipPos);
+		romIndexPut32(e+32, rec->zipNum);
+		e[36] = rec->info.mapper; e[37] = rec->info.mapper>>8;
+		e[38] = rec->info.flags6;
+		e[39] = rec->info.flags7;
+		e[40] = rec->info.region;
+		e[41] = rec->info.submapper;
+		//zip64 archives put the central directory past 4GB
+		romIndexPut32(e+44, (uint32_t)(rec->zipPos>>32));
+
+		//first entry wins if a rom shows up more than once
+		uint32_t slot = rec->info.crc & (tblSize-1);
+		while(romIndexGet32(out+crcOff+slot*4))
+			slot = (slot+1) & (tblSize-1);
+		romIndexPut32(out+crcOff+slot*4, i+1);
+		slot = romIndexHashName(rec->name) & (tblSize-1);
+		while(romIndexGet32(out+nameOff+slot*4))
+			slot = (slot+1) & (tblSize-1);
+		romIndexPut32(out+nameOff+slot*4, i+1);
+	}
+	FILE *f = fopen(indexPath, "wb");
+	if(!f)
+	{
+		printf("Index: Could not write %s\n", indexPath);
+		free(out);
+		return false;
+	}
+	bool ok = fwrite(out, 1, size, f) == size;
+	fclose(f);
+	free(out);
+	return ok;
+}
+
+bool romIndexBuild(const char *dir, const char *indexPath)
+{
+	uint32_t i;
+	romIndexFileNum = 0;
+	romIndexRecNum = 0;
+	romIndexScan(dir, 0);
+	int numThreads = romIndexThreadCount();
+	if((uint32_t)numThreads > romIndexFileNum)
+		numThreads = romIndexFileNum ? romIndexFileNum : 1;
+	printf("Index: Found %u files in %s, hashing on %i threads\n", romIndexFileNum, dir, numThreads);
+	//fill the crc table and database before any thread uses them
+	romInfoCrc32(0, NULL, 0);
+	gameDbInit();
+	atomic_store(&romIndexNext, 0);
+	pthread_t threads[ROM_INDEX_MAX_THREADS];
+	int started = 0;
+	for(i = 0; i < (uint32_t)numThreads; i++)
+	{
+		if(pthread_create(&threads[started], NULL, romIndexWorker, NULL) == 0)
+			started++;
+	}
+	//no threads at all, still get it done
+	if(started == 0)
+		romIndexWorker(NULL);
+	for(i = 0; i < (uint32_t)started; i++)
+		pthread_join(threads[i], NULL);
+
+	qsort(romIndexRecs, romIndexRecNum, sizeof(romIndexRec_t), romIndexRecCmp);
+	bool ok = romIndexWrite(indexPath);
+	if(ok)
+		printf("Index: Wrote %u entries to %s\n", romIndexRecNum, indexPath);
+
+	for(i = 0; i < romIndexFileNum; i++)
+		free(romIndexFiles[i]);
+	free(romIndexFiles);
+	romIndexFiles = NULL;
+	romIndexFileNum = romIndexFileCap = 0;
+	for(i = 0; i < romIndexRecNum; i++)
+	{
+		free(romIndexRecs[i].path);
+		free(romIndexRecs[i].name);
+	}
+	free(romIndexRecs);
+	romIndexRecs = NULL;
+	romIndexRecNum = romIndexRecCap = 0;
+	return ok;
+}
+
+bool romIndexOpen(const char *indexPath)
+{
+	romIndexClose();
+	FILE *f = fopen(indexPath, "rb");
+	if(!f)
+	{
+		printf("Index: Could not open %s\n", indexPath);
+		return false;
+	}
+	fseek(f, 0, SEEK_END);
+	romIndexDataSize = ftell(f);
+	rewind(f);
+	romIndexData = malloc(romIndexDataSize);
+	if(!romIndexData || romIndexDataSize < ROM_INDEX_HDR_SIZE
+		|| fread(romIndexData, 1, romIndexDataSize, f) != romIndexDataSize)
+	{
+		fclose(f);
+		romIndexClose();
+		printf("Index: Could not read %s\n", indexPath);
+		return false;
+	}
+	fclose(f);
+	romIndexCount = romIndexGet32(romIndexData+8);
+	romIndexTblSize = romIndexGet32(romIndexData+12);
+	romIndexEntryOff = romIndexGet32(romIndexData+16);
+	romIndexCrcOff = romIndexGet32(romIndexData+20);
+	romIndexNameOff = romIndexGet32(romIndexData+24);
+	romIndexStrOff = romIndexGet32(romIndexData+28);
+	if(memcmp(romIndexData, ROM_INDEX_MAGIC, 8) != 0 || romIndexTblSize == 0 || (romIndexTblSize & (romIndexTblSize-1))
+		|| romIndexTblSize < romIndexCount || (uint64_t)romIndexEntryOff + (uint64_t)romIndexCount*ROM_INDEX_ENTRY_SIZE > romIndexDataSize
+		|| (uint64_t)romIndexCrcOff + romIndexTblSize*4ull > romIndexDataSize
+		|| (uint64_t)romIndexNameOff + romIndexTblSize*4ull > romIndexDataSize
+		|| romIndexStrOff >= romIndexDataSize || romIndexData[romIndexDataSize-1] != 0)
+	{
+		romIndexClose();
+		printf("Index: %s is no valid index\n", indexPath);
+		return false;
+	}
+	return true;
+}
+
+static bool romIndexGetEntry(uint32_t slotVal, romIndexEntry_t *entry)
+{
+	if(slotVal == 0 || slotVal > romIndexCount)
+		return false;
+	const uint8_t *e = romIndexData + romIndexEntryOff + (slotVal-1)*ROM_INDEX_ENTRY_SIZE;
+	uint32_t strSize = romIndexDataSize - romIndexStrOff;
+	uint32_t pathPos = romIndexGet32(e+20);
+	uint32_t namePos = romIndexGet32(e+24);
+	if(pathPos >= strSize || namePos >= strSize)
+		return false;
+	memset(&entry->info, 0, sizeof(romInfo_t));
+	entry->info.crc = romIndexGet32(e);
+	entry->info.prgCrc = romIndexGet32(e+4);
+	entry->info.chrCrc = romIndexGet32(e+8);
+	entry->info.prgSize = romIndexGet32(e+12);
+	entry->info.chrSize = romIndexGet32(e+16);
+	entry->path = (const char*)romIndexData + romIndexStrOff + pathPos;
+	entry->name = (const char*)romIndexData + romIndexStrOff + namePos;
+	entry->zipPos = romIndexGet32(e+28) | ((uint64_t)romIndexGet32(e+44)<<32);
+	entry->zipNum = romIndexGet32(e+32);
+	entry->info.mapper = e[36] | (e[37]<<8);
+	entry->info.flags6 = e[38];
+	entry->info.flags7 = e[39];
+	entry->info.region = e[40];
+	entry->info.submapper = e[41];
+	return true;
+}
+
+//key is either a crc32 as 8 hex digits or a file name
+bool romIndexFind(const char *key, romIndexEntry_t *entry)
+{
+	if(!romIndexData)
+		return false;
+	uint32_t mask = romIndexTblSize-1;
+	uint32_t probes;
+	size_t keyLen = strlen(key);
+	if(keyLen == 8 && strspn(key, "0123456789abcdefABCDEF") == 8)
+	{
+		uint32_t crc = strtoul(key, NULL, 16);
+		uint32_t slot = crc & mask;
+		for(probes = 0; probes < romIndexTblSize; probes++)
+		{
+			uint32_t val = romIndexGet32(romIndexData + romIndexCrcOff + slot*4);
+			if(val == 0)
+				break;
+			if(romIndexGetEntry(val, entry) && entry->info.crc == crc)
+				return true;
+			slot = (slot+1) & mask;
+		}
+	}
+	char *name = romIndexKeyName(key);
+	uint32_t slot = romIndexHashName(name) & mask;
+	bool found = false;
+	for(probes = 0; probes < romIndexTblSize; probes++)
+	{
+		uint32_t val = romIndexGet32(romIndexData + romIndexNameOff + slot*4);
+		if(val == 0)
+			break;
+		if(romIndexGetEntry(val, entry) && strcmp(entry->name, name) == 0)
+		{
+			found = true;
+			break;
+		}
+		slot = (slot+1) & mask;
+	}
+	free(name);
+	return found;
+}
+
+void romIndexClose()
+{
+	if(romIndexData)
+		free(romIndexData);
+	romIndexData = NULL;
+	romIndexDataSize = 0;
+	romIndexCount = 0;
+}
@@ -0,0 +1,29 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#ifndef _romindex_h_
+#define _romindex_h_
+
+#define ROM_INDEX_NO_ZIP 0xFFFFFFFF
+
+typedef struct _romIndexEntry_t {
+	romInfo_t info;
+	//file to open, for zip entries the archive itself
+	const char *path;
+	//lowercase file name the entry is found by
+	const char *name;
+	//central directory position of zip entries, skips the search
+	uint64_t zipPos;
+	uint32_t zipNum;
+} romIndexEntry_t;
+
+bool romIndexBuild(const char *dir, const char *indexPath);
+bool romIndexOpen(const char *indexPath);
+bool romIndexFind(const char *key, romIndexEntry_t *entry);
+void romIndexClose();
+
+#endif
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include "rominfo.h"
+#include "gamedb.h"
+
+static uint32_t romInfoCrcTbl[256];
+static bool romInfoCrcInit = false;
+
+uint32_t romInfoCrc32(uint32_t crc, const uint8_t *buf, size_t len)
+{
+	if(!romInfoCrcInit)
+	{
+		uint32_t i, j;
+		for(i = 0; i < 256; i++)
+		{
+			uint32_t c = i;
+			for(j = 0; j < 8; j++)
+				c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+			romInfoCrcTbl[i] = c;
+		}
+		romInfoCrcInit = true;
+	}
+	crc = ~crc;
+	while(len--)
+		crc = romInfoCrcTbl[(crc ^ *buf++) & 0xFF] ^ (crc >> 8);
+	return ~crc;
+}
+
+//tags used by the usual romset naming schemes
+static const char *romInfoPALTags[] = {
+	"(E)", "(Europe)", "(Australia)", "(France)",
+	"(Germany)", "(Italy)", "(Spain)", "(Sweden)",
+};
+
+bool romInfoNameIsPAL(const char *name)
+{
+	size_t i;
+	for(i = 0; i < sizeof(romInfoPALTags)/sizeof(romInfoPALTags[0]); i++)
+	{
+		if(strstr(name, romInfoPALTags[i]) != NULL)
+			return true;
+	}
+	return false;
+}
+
+//nes 2.0 sizes with the msb nibble set to F are 2^E*(M*2+1)
+static uint32_t romInfoNES2Size(uint8_t lsb, uint8_t msb, uint32_t unit)
+{
+	if(msb == 0xF)
+	{
+		uint64_t expSize = (1ull << (lsb >> 2)) * ((lsb & 3)*2 + 1);
+		return expSize > 0xFFFFFFFF ? 0xFFFFFFFF : (uint32_t)expSize;
+	}
+	return ((msb << 8) | lsb) * unit;
+}
+
+bool romInfoParseNES(const uint8_t *rom, uint32_t size, const char *name, romInfo_t *info)
+{
+	memset(info, 0, sizeof(romInfo_t));
+	if(size < 16 || memcmp(rom, "NES\x1A", 4) != 0)
+		return false;
+	info->flags6 = rom[6];
+	info->flags7 = rom[7];
+	info->mapper = (rom[6] & 0xF0) >> 4;
+	if((rom[7] & 0x0C) == 0x08) //nes 2.0
+	{
+		info->mapper |= (rom[7] & 0xF0) | ((rom[8] & 0x0F) << 8);
+		info->submapper = rom[8] >> 4;
+		info->prgSize = romInfoNES2Size(rom[4], rom[9] & 0xF, 0x4000);
+		info->chrSize = romInfoNES2Size(rom[5], rom[9] >> 4, 0x2000);
+		//volatile and battery backed ram as shift counts
+		if(rom[10] & 0xF)
+			info->prgRamSize += 64 << (rom[10] & 0xF);
+		if(rom[10] >> 4)
+			info->prgRamSize += 64 << (rom[10] >> 4);
+		info->region = rom[12] & 3;
+		info->exact = true;
+	}
+	else
+	{
+		//old tools wrote their name over bytes 7-15,
+		//the upper mapper bits are garbage then
+		if(rom[12] == 0 && rom[13] == 0 && rom[14] == 0 && rom[15] == 0)
+			info->mapper |= rom[7] & 0xF0;
+		info->prgSize = rom[4] * 0x4000;
+		info->chrSize = rom[5] * 0x2000;
+		info->prgRamSize = rom[8] * 0x2000;
+		info->region = (name && romInfoNameIsPAL(name)) ? ROM_REGION_PAL : ROM_REGION_NTSC;
+	}
+	uint32_t prgOffset = 16;
+	if(rom[6] & (1<<2)) //trainer
+		prgOffset += 512;
+	//cut down to what is actually in the file
+	if(prgOffset > size)
+		prgOffset = size;
+	if(info->prgSize > size - prgOffset)
+		info->prgSize = size - prgOffset;
+	if(info->chrSize > size - prgOffset - info->prgSize)
+		info->chrSize = size - prgOffset - info->prgSize;
+	info->prgCrc = romInfoCrc32(0, rom + prgOffset, info->prgSize);
+	info->chrCrc = romInfoCrc32(0, rom + prgOffset + info->prgSize, info->chrSize);
+	info->crc = romInfoCrc32(0, rom + prgOffset, info->prgSize + info->chrSize);
+	const gameDbEntry_t *db = gameDbFind(info->crc);
+	if(db)
+	{
+		info->mapper = db->mapper;
+		info->submapper = db->submapper;
+		info->region = db->region;
+		info->prgRamSize = db->prgRamSize;
+		info->exact = true;
+		info->dbMatch = true;
+	}
+	return true;
+}
+
+//nsf and disk images, crc covers the whole file
+void romInfoParseData(const uint8_t *data, uint32_t size, const char *name, romInfo_t *info)
+{
+	memset(info, 0, sizeof(romInfo_t));
+	info->prgSize = size;
+	info->prgCrc = romInfoCrc32(0, data, size);
+	info->crc = info->prgCrc;
+	if(size >= 0x80 && memcmp(data, "NESM\x1A", 5) == 0)
+		info->region = (data[0x7A] & 2) ? ROM_REGION_MULTI : ((data[0x7A] & 1) ? ROM_REGION_PAL : ROM_REGION_NTSC);
+	else
+		info->region = (name && romInfoNameIsPAL(name)) ? ROM_REGION_PAL : ROM_REGION_NTSC;
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#ifndef _rominfo_h_
+#define _rominfo_h_
+
+enum {
+	ROM_REGION_NTSC = 0,
+	ROM_REGION_PAL,
+	ROM_REGION_MULTI,
+	ROM_REGION_DENDY,
+};
+
+typedef struct _romInfo_t {
+	//crc covers prg followed by chr, no header or trainer
+	uint32_t crc;
+	uint32_t prgCrc;
+	uint32_t chrCrc;
+	uint32_t prgSize;
+	uint32_t chrSize;
+	//0 if the header does not say
+	uint32_t prgRamSize;
+	uint16_t mapper;
+	uint8_t submapper;
+	uint8_t flags6;
+	uint8_t flags7;
+	uint8_t region;
+	//mapper, submapper and region came from a nes 2.0
+	//header or the game database, no guessing needed
+	bool exact;
+	bool dbMatch;
+} romInfo_t;
+
+uint32_t romInfoCrc32(uint32_t crc, const uint8_t *buf, size_t len);
+bool romInfoNameIsPAL(const char *name);
+bool romInfoParseNES(const uint8_t *rom, uint32_t size, const char *name, romInfo_t *info);
+void romInfoParseData(const uint8_t *data, uint32_t size, const char *name, romInfo_t *info);
+
+#endif
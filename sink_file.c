@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include "apu.h"
+#include "audio.h"
+#include "ring.h"
+
+//seconds of audio the writer thread may fall behind
+#define SINK_FILE_RING_SECS 2
+#define SINK_FILE_CHUNK 0x10000
+
+static FILE *sinkFile = NULL;
+static bool sinkFileWav;
+static uint32_t sinkFileDataSize;
+static ring_t sinkFileRing;
+static pthread_t sinkFileThread;
+static pthread_mutex_t sinkFileMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sinkFileCond = PTHREAD_COND_INITIALIZER;
+static volatile bool sinkFileRunning;
+
+static void sinkFilePut32(uint8_t *p, uint32_t v)
+{
+	p[0] = v; p[1] = v>>8; p[2] = v>>16; p[3] = v>>24;
+}
+
+static void sinkFilePut16(uint8_t *p, uint16_t v)
+{
+	p[0] = v; p[1] = v>>8;
+}
+
+//also used for the audio track of video captures
+void audioWriteWavHeader(FILE *f, uint32_t dataSize)
+{
+#if AUDIO_FLOAT
+	uint16_t fmt = 3, bits = 32;
+#else
+	uint16_t fmt = 1, bits = 16;
+#endif
+	uint32_t rate = apuGetFrequency();
+	uint8_t hdr[44];
+	memcpy(hdr, "RIFF", 4);
+	sinkFilePut32(hdr+4, 36 + dataSize);
+	memcpy(hdr+8, "WAVEfmt ", 8);
+	sinkFilePut32(hdr+16, 16);
+	sinkFilePut16(hdr+20, fmt);
+	sinkFilePut16(hdr+22, 2);
+	sinkFilePut32(hdr+24, rate);
+	sinkFilePut32(hdr+28, rate*2*(bits/8));
+	sinkFilePut16(hdr+32, 2*(bits/8));
+	sinkFilePut16(hdr+34, bits);
+	memcpy(hdr+36, "data", 4);
+	sinkFilePut32(hdr+40, dataSize);
+	fwrite(hdr, 1, sizeof(hdr), f);
+}
+
+//drains the ring so the emulation thread never touches the disk
+static void *sinkFileWriter(void *arg)
+{
+	(void)arg;
+	uint8_t *chunk = malloc(SINK_FILE_CHUNK);
+	while(1)
+	{
+		uint32_t got = ringRead(&sinkFileRing, chunk, SINK_FILE_CHUNK);
+		if(got)
+		{
+			fwrite(chunk, 1, got, sinkFile);
+			sinkFileDataSize += got;
+			continue;
+		}
+		pthread_mutex_lock(&sinkFileMutex);
+		if(sinkFileRunning && ringUsed(&sinkFileRing) == 0)
+			pthread_cond_wait(&sinkFileCond, &sinkFileMutex);
+		bool running = sinkFileRunning;
+		pthread_mutex_unlock(&sinkFileMutex);
+		if(!running && ringUsed(&sinkFileRing) == 0)
+			break;
+	}
+	free(chunk);
+	return NULL;
+}
+
+static bool sinkFileInit(const char *path, bool wav)
+{
+	if(!path || !*path)
+	{
+		printf("Audio: %s output needs a file, use %s:file\n", wav ? "wav" : "raw", wav ? "wav" : "raw");
+		return false;
+	}
+#if AUDIO_FLOAT
+	uint32_t sampleSize = sizeof(float);
+#else
+	uint32_t sampleSize = sizeof(int16_t);
+#endif
+	if(!ringInit(&sinkFileRing, apuGetFrequency()*2*sampleSize*SINK_FILE_RING_SECS, 2*sampleSize))
+		return false;
+	sinkFile = fopen(path, "wb");
+	if(!sinkFile)
+	{
+		printf("Audio: Could not open %s\n", path);
+		ringDeinit(&sinkFileRing);
+		return false;
+	}
+	sinkFileWav = wav;
+	sinkFileDataSize = 0;
+	if(wav) //filled in on close
+		audioWriteWavHeader(sinkFile, 0);
+	sinkFileRunning = true;
+	if(pthread_create(&sinkFileThread, NULL, sinkFileWriter, NULL) != 0)
+	{
+		fclose(sinkFile);
+		sinkFile = NULL;
+		ringDeinit(&sinkFileRing);
+		return false;
+	}
+	printf("Audio: Writing %s\n", path);
+	return true;
+}
+
+static bool wavSinkInit(const char *arg)
+{
+	return sinkFileInit(arg, true);
+}
+
+static bool rawSinkInit(const char *arg)
+{
+	return sinkFileInit(arg, false);
+}
+
+static int fileSinkUpdate(const uint8_t *data, uint32_t size)
+{
+	uint32_t written = 0;
+	while(1)
+	{
+		written += ringWrite(&sinkFileRing, data+written, size-written);
+		pthread_mutex_lock(&sinkFileMutex);
+		pthread_cond_signal(&sinkFileCond);
+		pthread_mutex_unlock(&sinkFileMutex);
+		if(written == size)
+			break;
+		//only if the disk cant keep up, files should not lose audio
+		sched_yield();
+	}
+	return 1;
+}
+
+static void fileSinkDeinit()
+{
+	if(!sinkFile)
+		return;
+	pthread_mutex_lock(&sinkFileMutex);
+	sinkFileRunning = false;
+	pthread_cond_signal(&sinkFileCond);
+	pthread_mutex_unlock(&sinkFileMutex);
+	pthread_join(sinkFileThread, NULL);
+	if(sinkFileWav)
+	{
+		rewind(sinkFile);
+		audioWriteWavHeader(sinkFile, sinkFileDataSize);
+	}
+	fclose(sinkFile);
+	sinkFile = NULL;
+	ringDeinit(&sinkFileRing);
+}
+
+const audioSink_t audioSinkWav = { "wav", wavSinkInit, fileSinkUpdate, fileSinkDeinit };
+const audioSink_t audioSinkRaw = { "raw", rawSinkInit, fileSinkUpdate, fileSinkDeinit };
@@ -0,0 +1,376 @@
+#include <string.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <malloc.h>
+#include <math.h>
+#include "AL/al.h"
+#include "AL/alc.h"
+#include "AL/alext.h"
+#include "alhelpers.h"
+#include "apu.h"
+#include "audio.h"
+
+static LPALBUFFERSAMPLESSOFT alBufferSamplesSOFT = wrap_BufferSamples;
+static LPALISBUFFERFORMATSUPPORTEDSOFT alIsBufferFormatSupportedSOFT;
+
+/* Upper limit for the configurable buffer count */
+#define AUDIO_MAX_BUFFERS 64
+#define AUDIO_MAX_CHUNK(period) ((period)+((period)>>3))
+
+typedef struct StreamPlayer {
+    /* These are the buffers and source to play out through OpenAL with */
+    ALuint buffers[AUDIO_MAX_BUFFERS];
+    ALsizei numBuffers;
+    ALuint source;
+
+    /* Handle for the audio file */
+    //FilePtr file;
+
+    /* The format of the output stream */
+    ALenum format;
+    ALenum channels;
+    ALenum type;
+    ALuint rate;
+
+    /* Buffers not currently queued on the source */
+    ALuint freeBuffers[AUDIO_MAX_BUFFERS];
+    ALsizei numFree;
+
+    /* Sample frames in each buffer and on the whole queue */
+    ALsizei bufFrames[AUDIO_MAX_BUFFERS];
+    ALsizei queuedFrames;
+
+    /* Sample frames per queued buffer and per emulated frame */
+    ALsizei periodFrames;
+    ALsizei frameFrames;
+
+    /* Audio kept queued ahead of each new frame, grows on underruns */
+    ALsizei margin;
+    ALsizei maxMargin;
+    unsigned underruns;
+    ALsizei lastFill;
+    void *silence;
+} StreamPlayer;
+
+/* Max deviation from the nominal rate when steering the queue fill, small
+ * enough to not be heard as a pitch change */
+#define AUDIO_DRC_MAX_DELTA 0.005
+
+extern bool nesPAL;
+
+/* Queue layout, 0ms period means one buffer per emulated frame */
+static int audioNumBuffers = NUM_BUFFERS;
+static int audioPeriodMs = 0;
+
+static StreamPlayer *NewPlayer(ALsizei numBuffers);
+static void DeletePlayer(StreamPlayer *player);
+
+/* Creates a new player object, and allocates the needed OpenAL source and
+ * buffer objects. Error checking is simplified for the purposes of this
+ * example, and will cause an abort if needed. */
+static StreamPlayer *NewPlayer(ALsizei numBuffers)
+{
+    StreamPlayer *player;
+
+    player = malloc(sizeof(*player));
+    if(!player)
+        return NULL;
+
+    memset(player, 0, sizeof(*player));
+
+    /* Generate the buffers and source */
+    player->numBuffers = numBuffers;
+    alGenBuffers(numBuffers, player->buffers);
+    //assert(alGetError() == AL_NO_ERROR && "Could not create buffers");
+
+    alGenSources(1, &player->source);
+    //assert(alGetError() == AL_NO_ERROR && "Could not create source");
+
+    /* Set parameters so mono sources play out the front-center speaker and
+     * won't distance attenuate. */
+    alSource3i(player->source, AL_POSITION, 0, 0, -1);
+    alSourcei(player->source, AL_SOURCE_RELATIVE, AL_TRUE);
+    alSourcei(player->source, AL_ROLLOFF_FACTOR, 0);
+    //assert(alGetError() == AL_NO_ERROR && "Could not set source parameters");
+
+    return player;
+}
+
+/* Destroys a player object, deleting the source and buffers. No error handling
+ * since these calls shouldn't fail with a properly-made player object. */
+static void DeletePlayer(StreamPlayer *player)
+{
+   // ClosePlayerFile(player);
+
+    alDeleteSources(1, &player->source);
+    alDeleteBuffers(player->numBuffers, player->buffers);
+    if(alGetError() != AL_NO_ERROR)
+        fprintf(stderr, "Failed to delete object IDs\n");
+
+    free(player->silence);
+    memset(player, 0, sizeof(*player));
+    free(player);
+}
+
+/* Every buffer on one source queue has to share the same format and
+ * frequency, so they all get the nominal rate */
+static int QueueBuffer(StreamPlayer *player, const void *data, ALsizei frames)
+{
+    ALsizei i;
+    ALuint bufid = player->freeBuffers[--player->numFree];
+
+    alBufferSamplesSOFT(bufid, player->rate, player->format, frames,
+                        player->channels, player->type, data);
+    alSourceQueueBuffers(player->source, 1, &bufid);
+    if(alGetError() != AL_NO_ERROR)
+    {
+        fprintf(stderr, "Error buffering data\n");
+        player->freeBuffers[player->numFree++] = bufid;
+        return 0;
+    }
+    for(i = 0;i < player->numBuffers;i++)
+    {
+        if(player->buffers[i] == bufid)
+            player->bufFrames[i] = frames;
+    }
+    player->queuedFrames += frames;
+    return 1;
+}
+
+/* Splits data into period sized buffers, whatever does not fit into the
+ * queue anymore gets dropped */
+static int QueueData(StreamPlayer *player, const uint8_t *data, ALsizei frames)
+{
+    ALsizei pos, chunk;
+
+    for(pos = 0;pos < frames;pos += chunk)
+    {
+        /* Let a chunk run a bit over the period instead
+         * of queueing a tiny leftover on its own */
+        chunk = frames - pos;
+        if(chunk > AUDIO_MAX_CHUNK(player->periodFrames))
+            chunk = player->periodFrames;
+        if(!player->numFree)
+            return 0;
+        if(!QueueBuffer(player, data ? data+FramesToBytes(pos, player->channels, player->type) : player->silence, chunk))
+            return 0;
+    }
+    return 1;
+}
+
+static int StartPlayer(StreamPlayer *player)
+{
+    ALsizei i;
+
+    /* Rewind the source position and clear the buffer queue */
+    alSourceRewind(player->source);
+    alSourcei(player->source, AL_BUFFER, 0);
+
+    for(i = 0;i < player->numBuffers;i++)
+        player->freeBuffers[i] = player->buffers[i];
+    player->numFree = player->numBuffers;
+    player->queuedFrames = 0;
+
+    player->silence = calloc(AUDIO_MAX_CHUNK(player->periodFrames), FramesToBytes(1, player->channels, player->type));
+    if(!player->silence) return 0;
+
+    /* Prime the queue with the safety margin, that is the fill
+     * level audioUpdate steers towards before each new frame */
+    QueueData(player, NULL, player->margin);
+
+    /* Now start playback! */
+    alSourcePlay(player->source);
+    if(alGetError() != AL_NO_ERROR)
+    {
+        fprintf(stderr, "Error starting playback\n");
+        return 0;
+    }
+
+    return 1;
+}
+
+static StreamPlayer *player = NULL;
+
+static bool alSinkInit(const char *arg)
+{
+    (void)arg;
+
+    if(InitAL() != 0)
+        return false;
+
+    if(alIsExtensionPresent("AL_SOFT_buffer_samples"))
+    {
+        alBufferSamplesSOFT = alGetProcAddress("alBufferSamplesSOFT");
+        alIsBufferFormatSupportedSOFT = alGetProcAddress("alIsBufferFormatSupportedSOFT");
+    }
+
+	ALuint rate = apuGetFrequency();
+	ALsizei frameFrames = (ALsizei)(rate / (nesPAL ? 50.0070 : 60.0988));
+	ALsizei periodFrames = audioPeriodMs ? (ALsizei)(((uint64_t)rate*audioPeriodMs)/1000) : frameFrames;
+	if(periodFrames > frameFrames) periodFrames = frameFrames;
+	ALsizei numBuffers = audioNumBuffers;
+	/* Needs room for a whole frame plus at least one period of margin */
+	ALsizei minBuffers = (frameFrames+periodFrames-1)/periodFrames + 1;
+	if(numBuffers < minBuffers)
+	{
+		printf("Audio: %i buffers too few for a frame, using %i\n", numBuffers, minBuffers);
+		numBuffers = minBuffers;
+	}
+	if(numBuffers > AUDIO_MAX_BUFFERS)
+		numBuffers = AUDIO_MAX_BUFFERS;
+
+    player = NewPlayer(numBuffers);
+    if(!player)
+    {
+        fprintf(stderr, "Could not create player\n");
+        goto error;
+    }
+
+	player->channels = AL_STEREO_SOFT;
+	player->rate = rate;
+	player->frameFrames = frameFrames;
+	player->periodFrames = periodFrames;
+	player->maxMargin = numBuffers*periodFrames - frameFrames;
+	if(player->maxMargin < 0)
+		player->maxMargin = 0;
+	/* Start out with half the queue filled, or a single period
+	 * when a period was explicitly asked for */
+	if(audioPeriodMs)
+		player->margin = periodFrames;
+	else
+		player->margin = (numBuffers/2)*frameFrames - frameFrames;
+	if(player->margin > player->maxMargin)
+		player->margin = player->maxMargin;
+	printf("Audio: %i buffers of %.1fms, %.1fms margin\n", numBuffers,
+		periodFrames*1000.0/rate, player->margin*1000.0/rate);
+#if AUDIO_FLOAT
+	player->type = AL_FLOAT_SOFT;
+#else
+	player->type = AL_SHORT_SOFT;
+#endif
+    player->format = GetFormat(player->channels, player->type, alIsBufferFormatSupportedSOFT);
+    if(player->format == 0)
+    {
+        fprintf(stderr, "Unsupported format (%s, %s)\n",
+                ChannelsName(player->channels), TypeName(player->type));
+        goto error;
+    }
+    if(!StartPlayer(player))
+        goto error;
+    return true;
+
+error:
+    if(player)
+    {
+        DeletePlayer(player);
+        player = NULL;
+    }
+    CloseAL();
+    return false;
+}
+
+static int alSinkUpdate(const uint8_t *data, uint32_t size)
+{
+    ALint processed = 0, state, offset = 0;
+    ALsizei frames, target, fill, i;
+    double ratio;
+
+    /* Get relevant source info */
+    alGetSourcei(player->source, AL_SOURCE_STATE, &state);
+    alGetSourcei(player->source, AL_BUFFERS_PROCESSED, &processed);
+    if(alGetError() != AL_NO_ERROR)
+    {
+        fprintf(stderr, "Error checking source state\n");
+        return 0;
+    }
+
+    /* Unqueue all processed buffers so they can be refilled */
+    while(processed-- > 0)
+    {
+        ALuint bufid;
+        alSourceUnqueueBuffers(player->source, 1, &bufid);
+        for(i = 0;i < player->numBuffers;i++)
+        {
+            if(player->buffers[i] == bufid)
+                player->queuedFrames -= player->bufFrames[i];
+        }
+        player->freeBuffers[player->numFree++] = bufid;
+    }
+
+    frames = BytesToFrames(size, player->channels, player->type);
+    if(!frames)
+        return 0;
+
+    /* The source ran dry, grow the margin by a period and
+     * put it back in front so this frame does not run dry too */
+    if(state == AL_STOPPED)
+    {
+        player->underruns++;
+        if(player->margin + player->periodFrames <= player->maxMargin)
+            player->margin += player->periodFrames;
+        printf("Audio: Underrun %u, margin now %.1fms\n", player->underruns,
+            player->margin*1000.0/player->rate);
+        QueueData(player, NULL, player->margin);
+    }
+
+    /* Steer the queue towards the margin plus this frame by slightly
+     * adjusting the pitch it gets played back at, instead of waiting on
+     * the device */
+    alGetSourcei(player->source, AL_SAMPLE_OFFSET, &offset);
+    fill = player->queuedFrames + frames - offset;
+    player->lastFill = fill;
+    target = player->margin + frames;
+    ratio = 1.0 + AUDIO_DRC_MAX_DELTA*((double)(fill - target)/(double)target);
+    if(ratio < 1.0 - AUDIO_DRC_MAX_DELTA) ratio = 1.0 - AUDIO_DRC_MAX_DELTA;
+    else if(ratio > 1.0 + AUDIO_DRC_MAX_DELTA) ratio = 1.0 + AUDIO_DRC_MAX_DELTA;
+
+    alSourcef(player->source, AL_PITCH, (ALfloat)ratio);
+
+    /* Whatever does not fit is running too far ahead of the device */
+    QueueData(player, data, frames);
+
+    /* Make sure the source hasn't underrun */
+    if(state != AL_PLAYING && state != AL_PAUSED)
+    {
+        alSourcePlay(player->source);
+        if(alGetError() != AL_NO_ERROR)
+        {
+            fprintf(stderr, "Error restarting playback\n");
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static void alSinkDeinit()
+{
+	if(player)
+	{
+		if(player->underruns)
+			printf("Audio: %u underruns\n", player->underruns);
+		DeletePlayer(player);
+		player = NULL;
+	}
+    CloseAL();
+}
+
+void audioSetLatency(int numBuffers, int periodMs)
+{
+	audioNumBuffers = numBuffers;
+	audioPeriodMs = periodMs;
+}
+
+unsigned audioGetUnderruns()
+{
+	return player ? player->underruns : 0;
+}
+
+//audio queued on the device after the last update
+unsigned audioGetQueuedMs()
+{
+	return player ? (unsigned)(player->lastFill*1000.0/player->rate) : 0;
+}
+
+const audioSink_t audioSinkOpenAL = { "openal", alSinkInit, alSinkUpdate, alSinkDeinit };
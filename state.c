@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include "state.h"
+#include "hash.h"
+
+/*
+ * Every part of the machine adds its variables in its init
+ * function, a snapshot is just all of them copied back to back.
+ * Those are raw copies, pointers in there only stay valid for
+ * as long as the same game stays loaded, which is why state
+ * hashes skip the ranges marked with stateNoHash.
+ */
+#define STATE_MAX_ENTRIES 256
+#define STATE_MAX_NOHASH 32
+
+typedef struct _stateEntry_t {
+	void *ptr;
+	uint32_t size;
+	uint8_t group;
+} stateEntry_t;
+
+typedef struct _stateRange_t {
+	uint8_t *ptr;
+	uint32_t size;
+} stateRange_t;
+
+static stateEntry_t stateList[STATE_MAX_ENTRIES];
+static uint32_t stateNum = 0;
+static uint32_t stateTotal = 0;
+static uint8_t stateGroup = STATE_GROUP_CART;
+static stateRange_t stateNoHashList[STATE_MAX_NOHASH];
+static uint32_t stateNoHashNum = 0;
+
+void stateClear()
+{
+	stateNum = 0;
+	stateTotal = 0;
+	stateGroup = STATE_GROUP_CART;
+	stateNoHashNum = 0;
+}
+
+//entries added from now on belong to group, returns the one before
+uint8_t stateSetGroup(uint8_t group)
+{
+	uint8_t prev = stateGroup;
+	stateGroup = group;
+	return prev;
+}
+
+void stateAdd(void *ptr, uint32_t size)
+{
+	uint32_t i;
+	//some init functions run again, like on nsf track changes
+	for(i = 0; i < stateNum; i++)
+	{
+		if(stateList[i].ptr == ptr)
+			return;
+	}
+	if(stateNum == STATE_MAX_ENTRIES)
+	{
+		printf("State: Too many entries, snapshots will be incomplete!\n");
+		return;
+	}
+	stateList[stateNum].ptr = ptr;
+	stateList[stateNum].size = size;
+	stateList[stateNum].group = stateGroup;
+	stateNum++;
+	stateTotal += size;
+}
+
+//part of an entry that is no machine state, like pointers into luts
+void stateNoHash(void *ptr, uint32_t size)
+{
+	uint32_t i;
+	for(i = 0; i < stateNoHashNum; i++)
+	{
+		if(stateNoHashList[i].ptr == ptr)
+			return;
+	}
+	if(stateNoHashNum == STATE_MAX_NOHASH)
+	{
+		printf("State: Too many unhashed ranges, hashes will differ between runs!\n");
+		return;
+	}
+	stateNoHashList[stateNoHashNum].ptr = ptr;
+	stateNoHashList[stateNoHashNum].size = size;
+	stateNoHashNum++;
+}
+
+uint32_t stateSize()
+{
+	return stateTotal;
+}
+
+void stateSave(uint8_t *buf)
+{
+	uint32_t i;
+	for(i = 0; i < stateNum; i++)
+	{
+		memcpy(buf, stateList[i].ptr, stateList[i].size);
+		buf += stateList[i].size;
+	}
+}
+
+void stateLoad(const uint8_t *buf)
+{
+	uint32_t i;
+	for(i = 0; i < stateNum; i++)
+	{
+		memcpy(stateList[i].ptr, buf, stateList[i].size);
+		buf += stateList[i].size;
+	}
+}
+
+//one hash per group, each entry hashed around its unhashed ranges
+void stateHash(uint64_t *hashes)
+{
+	uint32_t i, j;
+	for(i = 0; i < STATE_GROUPS; i++)
+		hashes[i] = 0;
+	for(i = 0; i < stateNum; i++)
+	{
+		uint8_t *pos = stateList[i].ptr;
+		uint8_t *end = pos + stateList[i].size;
+		uint64_t *h = &hashes[stateList[i].group];
+		while(pos < end)
+		{
+			//next unhashed range starting in what is left
+			uint8_t *skip = end;
+			uint32_t skipSize = 0;
+			for(j = 0; j < stateNoHashNum; j++)
+			{
+				if(stateNoHashList[j].ptr >= pos && stateNoHashList[j].ptr < skip)
+				{
+					skip = stateNoHashList[j].ptr;
+					skipSize = stateNoHashList[j].size;
+				}
+			}
+			if(skip > pos)
+				*h = hashBuf(pos, skip - pos, *h);
+			pos = skip + skipSize;
+		}
+	}
+}
@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#ifndef _state_h_
+#define _state_h_
+
+//what part of the machine entries belong to, for state hashes
+enum {
+	STATE_GROUP_CART = 0,
+	STATE_GROUP_CPU,
+	STATE_GROUP_RAM,
+	STATE_GROUP_PPU,
+	STATE_GROUP_APU,
+	STATE_GROUP_INPUT,
+	STATE_GROUPS
+};
+
+void stateClear();
+uint8_t stateSetGroup(uint8_t group);
+void stateAdd(void *ptr, uint32_t size);
+#define stateAddVar(v) stateAdd(&(v), sizeof(v))
+void stateNoHash(void *ptr, uint32_t size);
+#define stateNoHashVar(v) stateNoHash(&(v), sizeof(v))
+uint32_t stateSize();
+void stateSave(uint8_t *buf);
+void stateLoad(const uint8_t *buf);
+void stateHash(uint64_t *hashes);
+
+#endif
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include <time.h>
+#if EMU_STATS && (defined(__i386__) || defined(__x86_64__))
+#include <x86intrin.h>
+#endif
+#include "mapper.h"
+#include "stats.h"
+
+/*
+ * Counters of what the emulated hardware did next to the host time
+ * every part of the main loop took, so a slow game can be tracked
+ * down to what it does differently. The counters are plain increments
+ * right where things happen and only exist in EMU_STATS builds,
+ * statsFrame turns the running totals into per frame numbers.
+ */
+
+static const char *statsNames[STATS_COUNTERS] = {
+	"mem read ram", "mem read ppu", "mem read io", "mem read cart",
+	"mem write ram", "mem write ppu", "mem write io", "mem write cart",
+	"chr read",
+	"ppu write 2000", "ppu write 2001", "ppu write 2002", "ppu write 2003",
+	"ppu write 2004", "ppu write 2005", "ppu write 2006", "ppu write 2007",
+	"dma stall", "exp audio", "vrc7 audio",
+};
+
+static const char *statsTimeNames[STATS_TIMERS] = {
+	"cpu", "ppu", "apu", "mapper",
+};
+
+const char *statsGetName(uint8_t counter)
+{
+	return counter < STATS_COUNTERS ? statsNames[counter] : NULL;
+}
+
+const char *statsGetTimeName(uint8_t timer)
+{
+	return timer < STATS_TIMERS ? statsTimeNames[timer] : NULL;
+}
+
+#if EMU_STATS
+uint64_t statsCount[STATS_COUNTERS];
+uint64_t statsTime[STATS_TIMERS];
+uint32_t statsLoops = 0;
+static uint64_t statsPrevCount[STATS_COUNTERS];
+static uint64_t statsPrevTime[STATS_TIMERS];
+static uint64_t statsFrameCount[STATS_COUNTERS];
+static uint64_t statsFrameTime[STATS_TIMERS];
+static uint32_t statsFrames;
+static bool statsOn = false;
+static chrGet8FuncT statsOrigChrGet8 = NULL;
+
+//cpu timestamp counter where there is one
+uint64_t statsTick()
+{
+#if defined(__i386__) || defined(__x86_64__)
+	return __rdtsc();
+#else
+	return clock();
+#endif
+}
+
+static uint8_t statsChrGet8(uint16_t addr)
+{
+	statsCount[STATS_CHR_GET]++;
+	return statsOrigChrGet8(addr);
+}
+
+bool statsStart()
+{
+	memset(statsCount, 0, sizeof(statsCount));
+	memset(statsTime, 0, sizeof(statsTime));
+	memset(statsPrevCount, 0, sizeof(statsPrevCount));
+	memset(statsPrevTime, 0, sizeof(statsPrevTime));
+	memset(statsFrameCount, 0, sizeof(statsFrameCount));
+	memset(statsFrameTime, 0, sizeof(statsFrameTime));
+	statsFrames = 0;
+	//chr reads go straight to the mapper, so count them there
+	if(statsOrigChrGet8 == NULL)
+	{
+		statsOrigChrGet8 = mapperChrGet8;
+		mapperChrGet8 = statsChrGet8;
+	}
+	statsOn = true;
+	return true;
+}
+
+void statsFrame()
+{
+	uint8_t i;
+	if(!statsOn)
+		return;
+	for(i = 0; i < STATS_COUNTERS; i++)
+	{
+		statsFrameCount[i] = statsCount[i] - statsPrevCount[i];
+		statsPrevCount[i] = statsCount[i];
+	}
+	for(i = 0; i < STATS_TIMERS; i++)
+	{
+		statsFrameTime[i] = statsTime[i] - statsPrevTime[i];
+		statsPrevTime[i] = statsTime[i];
+	}
+	statsFrames++;
+}
+
+//numbers of the last finished frame, either pointer can be NULL
+bool statsGetFrame(uint64_t *counts, uint64_t *times)
+{
+	if(!statsOn)
+		return false;
+	if(counts)
+		memcpy(counts, statsFrameCount, sizeof(statsFrameCount));
+	if(times)
+		memcpy(times, statsFrameTime, sizeof(statsFrameTime));
+	return true;
+}
+
+void statsStop()
+{
+	uint64_t total = 0;
+	uint8_t i;
+	if(!statsOn)
+		return;
+	statsOn = false;
+	if(statsOrigChrGet8 != NULL && mapperChrGet8 == statsChrGet8)
+		mapperChrGet8 = statsOrigChrGet8;
+	statsOrigChrGet8 = NULL;
+	if(!statsFrames)
+		return;
+	printf("Stats: %u frames, per frame average:\n", statsFrames);
+	for(i = 0; i < STATS_COUNTERS; i++)
+		printf("%-16s %12.1f\n", statsNames[i], (double)statsCount[i]/statsFrames);
+	for(i = 0; i < STATS_TIMERS; i++)
+		total += statsTime[i];
+	printf("Stats: host ticks per frame:\n");
+	for(i = 0; i < STATS_TIMERS; i++)
+		printf("%-16s %12.0f %5.1f%%\n", statsTimeNames[i], (double)statsTime[i]/statsFrames,
+			total ? 100.0*statsTime[i]/total : 0.0);
+}
+#else
+bool statsStart()
+{
+	printf("Stats: Not available, build with -DEMU_STATS=1\n");
+	return false;
+}
+
+void statsStop()
+{
+}
+
+void statsFrame()
+{
+}
+
+bool statsGetFrame(uint64_t *counts, uint64_t *times)
+{
+	(void)counts;
+	(void)times;
+	return false;
+}
+#endif
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#ifndef _stats_h_
+#define _stats_h_
+
+//build with -DEMU_STATS=1 to get the counters, without
+//it every STATS_ macro compiles to nothing
+#ifndef EMU_STATS
+#define EMU_STATS 0
+#endif
+
+enum {
+	STATS_MEM_GET_RAM = 0,
+	STATS_MEM_GET_PPU,
+	STATS_MEM_GET_IO,
+	STATS_MEM_GET_CART,
+	STATS_MEM_SET_RAM,
+	STATS_MEM_SET_PPU,
+	STATS_MEM_SET_IO,
+	STATS_MEM_SET_CART,
+	STATS_CHR_GET,
+	STATS_PPU_SET_2000,
+	STATS_PPU_SET_2001,
+	STATS_PPU_SET_2002,
+	STATS_PPU_SET_2003,
+	STATS_PPU_SET_2004,
+	STATS_PPU_SET_2005,
+	STATS_PPU_SET_2006,
+	STATS_PPU_SET_2007,
+	STATS_DMA_STALL,
+	STATS_EXP_AUDIO,
+	STATS_VRC7_AUDIO,
+	STATS_COUNTERS
+};
+
+//host time, split by the main loop
+enum {
+	STATS_TIME_CPU = 0,
+	STATS_TIME_PPU,
+	STATS_TIME_APU,
+	STATS_TIME_MAPPER,
+	STATS_TIMERS
+};
+
+//only every 1<<STATS_TIME_SHIFT main loop runs get timed,
+//reading the timestamp counter costs about as much as a ppu dot
+#define STATS_TIME_SHIFT 4
+
+#if EMU_STATS
+extern uint64_t statsCount[STATS_COUNTERS];
+extern uint64_t statsTime[STATS_TIMERS];
+extern uint32_t statsLoops;
+uint64_t statsTick();
+#define STATS_INC(c) (statsCount[c]++)
+#define STATS_LOOP() (statsLoops++)
+#define STATS_TIME(t, call) do { \
+		if(statsLoops & ((1<<STATS_TIME_SHIFT)-1)) { call; } \
+		else { uint64_t _statsStart = statsTick(); call; statsTime[t] += (statsTick()-_statsStart)<<STATS_TIME_SHIFT; } \
+	} while(0)
+#else
+#define STATS_INC(c) ((void)0)
+#define STATS_LOOP() ((void)0)
+#define STATS_TIME(t, call) do { call; } while(0)
+#endif
+
+bool statsStart();
+void statsStop();
+void statsFrame();
+bool statsGetFrame(uint64_t *counts, uint64_t *times);
+const char *statsGetName(uint8_t counter);
+const char *statsGetTimeName(uint8_t timer);
+
+#endif
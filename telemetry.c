@@ -0,0 +1,229 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include <errno.h>
+#if !WINDOWS_BUILD
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+#include "audio.h"
+#include "pacer.h"
+#include "telemetry.h"
+
+/*
+ * One JSON line per shown frame on how the host kept up: time spent
+ * emulating, waiting on the pacer and drawing, the wall time since the
+ * last shown frame, the audio queue and whether the frame was drawn at
+ * all. Goes to a file or, with unix:path, to a listening local socket
+ * that whole lines just get dropped on while it is not keeping up.
+ */
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+#define TELEMETRY_LINE_MAX 320
+
+bool telemetryActive = false;
+static FILE *telemetryFile = NULL;
+static int telemetrySock = -1;
+static uint32_t telemetryFrames;
+static uint32_t telemetryDropped;
+static uint64_t telemetryEmuBegin;
+static uint64_t telemetryEmuNs;
+static uint64_t telemetryWaitBegin;
+static uint64_t telemetryLastShown;
+static uint64_t telemetryRenderNs;
+static uint8_t telemetryEmuFrames;
+//unsent end of the last line on the socket
+static char telemetryTail[TELEMETRY_LINE_MAX];
+static int telemetryTailPos, telemetryTailLen;
+
+static bool telemetryOpenSock(const char *path)
+{
+#if !WINDOWS_BUILD
+	struct sockaddr_un addr;
+	if(strlen(path) >= sizeof(addr.sun_path))
+	{
+		printf("Telemetry: Socket path %s too long\n", path);
+		return false;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path);
+	telemetrySock = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(telemetrySock < 0 || connect(telemetrySock, (struct sockaddr*)&addr, sizeof(addr)) != 0)
+	{
+		printf("Telemetry: Unable to connect to %s: %s\n", path, strerror(errno));
+		if(telemetrySock >= 0)
+			close(telemetrySock);
+		telemetrySock = -1;
+		return false;
+	}
+	//never hold up the emulation on a slow reader
+	fcntl(telemetrySock, F_SETFL, fcntl(telemetrySock, F_GETFL) | O_NONBLOCK);
+	return true;
+#else
+	(void)path;
+	printf("Telemetry: Sockets not supported on this platform\n");
+	return false;
+#endif
+}
+
+bool telemetryStart(const char *spec)
+{
+	telemetryStop();
+	if(strncmp(spec, "unix:", 5) == 0)
+	{
+		if(!telemetryOpenSock(spec+5))
+			return false;
+	}
+	else
+	{
+		telemetryFile = fopen(spec, "w");
+		if(!telemetryFile)
+		{
+			printf("Telemetry: Unable to write %s\n", spec);
+			return false;
+		}
+		//whole lines, so it can be followed while running
+		setvbuf(telemetryFile, NULL, _IOLBF, 1024);
+	}
+	telemetryFrames = 0;
+	telemetryDropped = 0;
+	telemetryEmuNs = 0;
+	telemetryEmuFrames = 0;
+	telemetryRenderNs = 0;
+	telemetryTailPos = 0;
+	telemetryTailLen = 0;
+	telemetryLastShown = pacerNow();
+	telemetryActive = true;
+	printf("Telemetry: Writing to %s\n", spec);
+	return true;
+}
+
+void telemetryStop()
+{
+	if(!telemetryActive)
+		return;
+	telemetryActive = false;
+	if(telemetryFile)
+	{
+		fclose(telemetryFile);
+		telemetryFile = NULL;
+	}
+#if !WINDOWS_BUILD
+	if(telemetrySock >= 0)
+	{
+		close(telemetrySock);
+		telemetrySock = -1;
+	}
+#endif
+	printf("Telemetry: %u frames", telemetryFrames);
+	if(telemetryDropped)
+		printf(", %u dropped", telemetryDropped);
+	printf("\n");
+}
+
+void telemetryEmuStart()
+{
+	telemetryEmuBegin = pacerNow();
+}
+
+//emulation of this shown frame is done, pacing comes next
+void telemetryEmuDone(uint8_t frames)
+{
+	telemetryWaitBegin = pacerNow();
+	telemetryEmuNs = telemetryWaitBegin - telemetryEmuBegin;
+	telemetryEmuFrames = frames;
+}
+
+//drawing happens after the frame got shown, so each line
+//carries the render time of the frame before it
+void telemetryRender(uint64_t ns)
+{
+	telemetryRenderNs = ns;
+}
+
+#if !WINDOWS_BUILD
+//sends what the socket takes right now, -1 once the reader is gone
+static int telemetrySend(const char *buf, int len)
+{
+	ssize_t sent = send(telemetrySock, buf, len, MSG_NOSIGNAL);
+	if(sent >= 0)
+		return (int)sent;
+	if(errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+		return 0;
+	printf("Telemetry: Reader went away: %s\n", strerror(errno));
+	telemetryStop();
+	return -1;
+}
+#endif
+
+static void telemetryWrite(const char *line, int len)
+{
+	if(telemetryFile)
+	{
+		fwrite(line, 1, len, telemetryFile);
+		return;
+	}
+#if !WINDOWS_BUILD
+	int sent;
+	//a line that only went out partly gets finished first,
+	//the reader never sees half a line followed by another
+	if(telemetryTailLen)
+	{
+		sent = telemetrySend(telemetryTail+telemetryTailPos, telemetryTailLen);
+		if(sent < 0)
+			return;
+		telemetryTailPos += sent;
+		telemetryTailLen -= sent;
+		if(telemetryTailLen)
+		{
+			telemetryDropped++;
+			return;
+		}
+	}
+	sent = telemetrySend(line, len);
+	if(sent < 0)
+		return;
+	if(sent == 0)
+		telemetryDropped++;
+	else if(sent < len)
+	{
+		memcpy(telemetryTail, line+sent, len-sent);
+		telemetryTailPos = 0;
+		telemetryTailLen = len-sent;
+	}
+#endif
+}
+
+void telemetryFrameShown(bool skipped)
+{
+	char line[TELEMETRY_LINE_MAX];
+	uint64_t now = pacerNow();
+	uint64_t hostNs = now - telemetryLastShown;
+	uint64_t waitNs = now - telemetryWaitBegin;
+	//emulated time over wall time, 1.0 is full speed
+	double speed = hostNs ? (double)(pacerGetPeriod()*telemetryEmuFrames)/(double)hostNs : 0.0;
+	telemetryLastShown = now;
+	int len = snprintf(line, sizeof(line),
+		"{\"frame\":%u,\"emu_frames\":%u,\"emu_ms\":%.3f,\"wait_ms\":%.3f,\"host_ms\":%.3f,"
+		"\"render_ms\":%.3f,\"speed\":%.3f,\"audio_queue_ms\":%u,\"underruns\":%u,\"skipped\":%s}\n",
+		telemetryFrames, telemetryEmuFrames, telemetryEmuNs/1000000.0, waitNs/1000000.0,
+		hostNs/1000000.0, telemetryRenderNs/1000000.0, speed, audioGetQueuedMs(),
+		audioGetUnderruns(), skipped ? "true" : "false");
+	telemetryFrames++;
+	if(len > 0 && len < (int)sizeof(line))
+		telemetryWrite(line, len);
+}
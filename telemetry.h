@@ -0,0 +1,21 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#ifndef _telemetry_h_
+#define _telemetry_h_
+
+//checked by the main loop before taking any timestamps
+extern bool telemetryActive;
+
+bool telemetryStart(const char *spec);
+void telemetryStop();
+void telemetryEmuStart();
+void telemetryEmuDone(uint8_t frames);
+void telemetryFrameShown(bool skipped);
+void telemetryRender(uint64_t ns);
+
+#endif
@@ -0,0 +1,366 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#if WINDOWS_BUILD
+#include <process.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#endif
+#include "cpu.h"
+#include "dbg.h"
+#include "hash.h"
+#include "pacer.h"
+#include "testrom.h"
+
+/*
+ * Runs test roms without a window so accuracy can be checked after
+ * every change. A rom either reports through the $6000 protocol most
+ * test roms use (signature DE B0 61 at $6001, status at $6000, text
+ * from $6004) or gets compared against a known hash of its last
+ * frame. The suite runs every rom in its own process, as many at
+ * once as there are cores, since the core only exists once.
+ */
+
+#define TESTROM_DEFAULT_FRAMES 3600
+//the protocol asks for a reset no earlier than 100ms later
+#define TESTROM_RESET_FRAMES 8
+#define TESTROM_MAX_JOBS 64
+
+extern uint16_t textureImage[0xF000];
+
+static uint8_t testRomPeek(uint16_t addr)
+{
+	uint8_t val = 0;
+	dbgPeek8(addr, &val);
+	return val;
+}
+
+static bool testRomHasProtocol()
+{
+	return testRomPeek(0x6001) == 0xDE && testRomPeek(0x6002) == 0xB0 && testRomPeek(0x6003) == 0x61;
+}
+
+//result text with line breaks folded into one line
+static void testRomPrintText()
+{
+	char text[256];
+	uint16_t i;
+	for(i = 0; i < sizeof(text)-1; i++)
+	{
+		text[i] = testRomPeek(0x6004+i);
+		if(text[i] == 0)
+			break;
+		if(text[i] == '\n')
+			text[i] = ' ';
+	}
+	text[i] = 0;
+	while(i > 0 && text[i-1] == ' ')
+		text[--i] = 0;
+	if(i)
+		printf("Test: %s\n", text);
+}
+
+int testRomRun(bool (*runFrame)(), uint32_t frames, const char *hash)
+{
+	uint32_t f = 0, resetAt = 0;
+	uint8_t status = 0x80;
+	bool protocol = false;
+	while(f < frames)
+	{
+		if(!runFrame())
+			break;
+		f++;
+		if(hash || !testRomHasProtocol())
+			continue;
+		protocol = true;
+		status = testRomPeek(0x6000);
+		if(status == 0x81)
+		{
+			if(!resetAt)
+				resetAt = f + TESTROM_RESET_FRAMES;
+			else if(f >= resetAt)
+			{
+				cpuSoftReset();
+				resetAt = 0;
+			}
+		}
+		else if(status < 0x80)
+			break;
+	}
+	uint64_t video = hashBuf(textureImage, sizeof(textureImage), 0);
+	printf("Test: %u frames, video hash %016" PRIx64 "\n", f, video);
+	if(hash)
+	{
+		if(video == strtoull(hash, NULL, 16))
+			return TESTROM_PASS;
+		printf("Test: Expected video hash %s\n", hash);
+		return TESTROM_FAIL;
+	}
+	if(!protocol || status >= 0x80)
+	{
+		printf("Test: No result after %u frames\n", f);
+		return TESTROM_TIMEOUT;
+	}
+	testRomPrintText();
+	if(status)
+	{
+		printf("Test: Result code %u\n", status);
+		return TESTROM_FAIL;
+	}
+	return TESTROM_PASS;
+}
+
+typedef struct _testRomJob_t {
+	char rom[2048];
+	char frames[16];
+	char hash[24];
+	//result that counts as passing, roms checking the runner itself fail on purpose
+	int expect;
+#if !WINDOWS_BUILD
+	pid_t pid;
+	FILE *out;
+#endif
+} testRomJob_t;
+
+static const char *testRomResultName(int code)
+{
+	switch(code)
+	{
+		case TESTROM_PASS:
+			return "pass";
+		case TESTROM_FAIL:
+			return "FAIL";
+		case TESTROM_TIMEOUT:
+			return "TIMEOUT";
+		default:
+			return "ERROR";
+	}
+}
+
+static bool testRomIsNumber(const char *s)
+{
+	if(*s == 0)
+		return false;
+	while(*s >= '0' && *s <= '9')
+		s++;
+	return *s == 0;
+}
+
+//one "rom [frames] [video hash] [pass|fail|timeout]" per line, # starts
+//a comment, rom paths are relative to the list
+static bool testRomParse(FILE *f, const char *dir, testRomJob_t *job)
+{
+	char line[1200], rom[1024], args[3][24];
+	while(fgets(line, sizeof(line), f))
+	{
+		char *c = strchr(line, '#');
+		if(c) *c = 0;
+		job->frames[0] = 0;
+		job->hash[0] = 0;
+		job->expect = TESTROM_PASS;
+		int i, num = sscanf(line, "%1023s %23s %23s %23s", rom, args[0], args[1], args[2]);
+		if(num < 1)
+			continue;
+		for(i = 0; i < num-1; i++)
+		{
+			if(i == 0 && testRomIsNumber(args[i]))
+				snprintf(job->frames, sizeof(job->frames), "%.15s", args[i]);
+			else if(strcmp(args[i], "pass") == 0)
+				job->expect = TESTROM_PASS;
+			else if(strcmp(args[i], "fail") == 0)
+				job->expect = TESTROM_FAIL;
+			else if(strcmp(args[i], "timeout") == 0)
+				job->expect = TESTROM_TIMEOUT;
+			else
+				snprintf(job->hash, sizeof(job->hash), "%.23s", args[i]);
+		}
+		if(rom[0] == '/' || dir[0] == 0)
+			snprintf(job->rom, sizeof(job->rom), "%s", rom);
+		else
+			snprintf(job->rom, sizeof(job->rom), "%s/%s", dir, rom);
+		if(job->frames[0] == 0)
+			snprintf(job->frames, sizeof(job->frames), "%u", TESTROM_DEFAULT_FRAMES);
+		return true;
+	}
+	return false;
+}
+
+static void testRomArgs(const char *self, testRomJob_t *job, const char **args)
+{
+	uint8_t n = 0;
+	args[n++] = self;
+	args[n++] = job->rom;
+	args[n++] = "--test";
+	args[n++] = job->frames;
+	if(job->hash[0])
+	{
+		args[n++] = "--test-hash";
+		args[n++] = job->hash;
+	}
+	args[n] = NULL;
+}
+
+static void testRomPrintResult(testRomJob_t *job, int code)
+{
+	if(code == job->expect && code != TESTROM_PASS)
+		printf("Test: %-7s %s (%s as expected)\n", "pass", job->rom, testRomResultName(code));
+	else if(code != job->expect && code == TESTROM_PASS)
+		printf("Test: %-7s %s (passed, expected %s)\n", "FAIL", job->rom, testRomResultName(job->expect));
+	else
+		printf("Test: %-7s %s\n", testRomResultName(code), job->rom);
+}
+
+//what a finished run counts as in the totals
+static int testRomOutcome(testRomJob_t *job, int code)
+{
+	if(code == job->expect)
+		return TESTROM_PASS;
+	//only fails on purpose, so passing is the failure
+	if(code == TESTROM_PASS)
+		return TESTROM_FAIL;
+	return code;
+}
+
+#if !WINDOWS_BUILD
+static bool testRomStart(const char *self, testRomJob_t *job)
+{
+	const char *args[8];
+	testRomArgs(self, job, args);
+	job->out = tmpfile();
+	if(job->out == NULL)
+		return false;
+	job->pid = fork();
+	if(job->pid < 0)
+	{
+		fclose(job->out);
+		return false;
+	}
+	if(job->pid == 0)
+	{
+		int nul = open("/dev/null", O_RDONLY);
+		if(nul >= 0)
+			dup2(nul, 0);
+		dup2(fileno(job->out), 1);
+		dup2(fileno(job->out), 2);
+		execvp(self, (char**)args);
+		_exit(TESTROM_ERROR);
+	}
+	return true;
+}
+
+//what the run said about itself, for anything unexpected
+static void testRomReport(testRomJob_t *job, int code)
+{
+	char line[512], last[512] = "";
+	testRomPrintResult(job, code);
+	if(code != job->expect)
+	{
+		rewind(job->out);
+		while(fgets(line, sizeof(line), job->out))
+		{
+			if(strncmp(line, "Test: ", 6) == 0)
+				printf("        %s", line+6);
+			else if(line[0] != '\n' && strncmp(line, "Press enter", 11) != 0)
+				strcpy(last, line);
+		}
+		//did not get to run, say why
+		if(code == TESTROM_ERROR && last[0])
+			printf("        %s", last);
+	}
+	fclose(job->out);
+}
+#endif
+
+bool testRomSuite(const char *self, const char *list, int jobs)
+{
+	static testRomJob_t running[TESTROM_MAX_JOBS];
+	uint32_t counts[TESTROM_TIMEOUT+1] = { 0 };
+	char dir[1024];
+	int code;
+	FILE *f = fopen(list, "r");
+	if(f == NULL)
+	{
+		printf("Test: Could not open %s\n", list);
+		return false;
+	}
+	snprintf(dir, sizeof(dir), "%s", list);
+	char *slash = strrchr(dir, '/');
+	if(slash) *slash = 0;
+	else dir[0] = 0;
+	//only used for its clock here
+	pacerInit(60.0);
+	uint64_t start = pacerNow();
+#if WINDOWS_BUILD
+	//no fork here, so one rom after the other
+	(void)jobs;
+	const char *args[8];
+	while(testRomParse(f, dir, &running[0]))
+	{
+		testRomArgs(self, &running[0], args);
+		code = _spawnv(_P_WAIT, self, args);
+		if(code < TESTROM_PASS || code > TESTROM_TIMEOUT)
+			code = TESTROM_ERROR;
+		testRomPrintResult(&running[0], code);
+		counts[testRomOutcome(&running[0], code)]++;
+	}
+#else
+	int i, num = 0, status;
+	bool more = true;
+	if(jobs <= 0)
+		jobs = sysconf(_SC_NPROCESSORS_ONLN);
+	if(jobs <= 0)
+		jobs = 1;
+	if(jobs > TESTROM_MAX_JOBS)
+		jobs = TESTROM_MAX_JOBS;
+	while(more || num > 0)
+	{
+		while(more && num < jobs)
+		{
+			more = testRomParse(f, dir, &running[num]);
+			if(!more)
+				break;
+			if(testRomStart(self, &running[num]))
+				num++;
+			else
+			{
+				printf("Test: Could not start %s\n", running[num].rom);
+				counts[TESTROM_ERROR]++;
+			}
+		}
+		if(num == 0)
+			break;
+		pid_t pid = wait(&status);
+		if(pid < 0)
+			break;
+		for(i = 0; i < num; i++)
+		{
+			if(running[i].pid != pid)
+				continue;
+			code = WIFEXITED(status) ? WEXITSTATUS(status) : TESTROM_ERROR;
+			if(code > TESTROM_TIMEOUT)
+				code = TESTROM_ERROR;
+			testRomReport(&running[i], code);
+			counts[testRomOutcome(&running[i], code)]++;
+			running[i] = running[--num];
+			break;
+		}
+	}
+#endif
+	fclose(f);
+	printf("Test: %u passed, %u failed, %u timed out, %u errors in %.1fs\n",
+		counts[TESTROM_PASS], counts[TESTROM_FAIL], counts[TESTROM_TIMEOUT],
+		counts[TESTROM_ERROR], (pacerNow()-start)/1000000000.0);
+	pacerDeinit();
+	return counts[TESTROM_PASS] && !counts[TESTROM_FAIL] && !counts[TESTROM_TIMEOUT] && !counts[TESTROM_ERROR];
+}
@@ -0,0 +1,21 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#ifndef _testrom_h_
+#define _testrom_h_
+
+//exit codes of a single headless run, 1 is
+//left to main for roms that did not load
+#define TESTROM_PASS 0
+#define TESTROM_ERROR 1
+#define TESTROM_FAIL 2
+#define TESTROM_TIMEOUT 3
+
+int testRomRun(bool (*runFrame)(), uint32_t frames, const char *hash);
+bool testRomSuite(const char *self, const char *list, int jobs);
+
+#endif
@@ -0,0 +1,499 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+
+/*
+ * Writes the small NROM test roms suite.txt runs, so the headless
+ * runner itself can be checked without any outside roms: one that
+ * passes, one that fails, one that asks for a reset through $6000
+ * before it passes, one that never reports and one that draws a
+ * fixed scene for a video hash. That last one reads the pad right
+ * after its sprite 0 hit on scanline 80, which is also what the
+ * libretro input latency check runs on.
+ * The timing roms count 11 cycle loops between two events and check
+ * the counts against what the hardware gives, with a bit of room for
+ * the sync jitter: vbl.nes the frame length, vblank flag and sprite 0
+ * hit, frameirq.nes the $4017 frame counter modes and when its irq
+ * and $4015 flag come, dma.nes the cycles OAM and DMC DMA take away.
+ */
+
+#define MK_ORG 0xC000
+#define MK_LABELS 32
+#define MK_FIXUPS 64
+
+enum {
+	ROM_PASS = 0,
+	ROM_FAIL,
+	ROM_RESET,
+	ROM_TIMEOUT,
+};
+
+static uint8_t mkPrg[0x4000];
+static uint8_t mkChr[0x2000];
+static uint16_t mkPos;
+static uint16_t mkLabels[MK_LABELS];
+static struct { uint16_t pos; uint8_t label; bool rel; } mkFixups[MK_FIXUPS];
+static uint8_t mkFixupNum;
+static uint8_t mkLabelNext;
+
+static void mkStart()
+{
+	memset(mkPrg, 0xFF, sizeof(mkPrg));
+	memset(mkChr, 0, sizeof(mkChr));
+	mkPos = 0;
+	mkFixupNum = 0;
+	mkLabelNext = MK_LABELS;
+}
+
+static void mkByte(uint8_t b)
+{
+	mkPrg[mkPos++] = b;
+}
+
+static void mkBytes(const uint8_t *b, uint16_t len)
+{
+	while(len--)
+		mkByte(*b++);
+}
+#define MK(...) do { static const uint8_t _b[] = { __VA_ARGS__ }; mkBytes(_b, sizeof(_b)); } while(0)
+
+static void mkLabel(uint8_t label)
+{
+	mkLabels[label] = MK_ORG + mkPos;
+}
+
+//labels for the helpers, taken from the top so the
+//ones of a rom can just be an enum starting at 0
+static uint8_t mkNewLabel()
+{
+	return --mkLabelNext;
+}
+
+//branch opcode to a label, resolved by mkFinish
+static void mkBranch(uint8_t op, uint8_t label)
+{
+	mkByte(op);
+	mkFixups[mkFixupNum].pos = mkPos;
+	mkFixups[mkFixupNum].label = label;
+	mkFixups[mkFixupNum++].rel = true;
+	mkByte(0);
+}
+
+//absolute operand opcode (jmp, lda abs) to a label
+static void mkAbs(uint8_t op, uint8_t label)
+{
+	mkByte(op);
+	mkFixups[mkFixupNum].pos = mkPos;
+	mkFixups[mkFixupNum].label = label;
+	mkFixups[mkFixupNum++].rel = false;
+	mkByte(0);
+	mkByte(0);
+}
+
+//lda #val sta addr
+static void mkStore(uint8_t val, uint16_t addr)
+{
+	mkByte(0xA9); mkByte(val);
+	mkByte(0x8D); mkByte(addr&0xFF); mkByte(addr>>8);
+}
+
+static void mkWaitVblank(uint8_t label)
+{
+	mkLabel(label);
+	MK(0x2C, 0x02, 0x20); //bit $2002
+	mkBranch(0x10, label); //bpl
+}
+
+static void mkJmpSelf(uint8_t label)
+{
+	mkLabel(label);
+	mkAbs(0x4C, label);
+}
+
+//waits for n vblank flags, the first one may already be close
+static void mkWaitFrames(uint8_t n)
+{
+	uint8_t loop = mkNewLabel(), wait = mkNewLabel();
+	mkByte(0xA0); mkByte(n); //ldy #n
+	mkLabel(loop);
+	mkWaitVblank(wait);
+	MK(0x88); //dey
+	mkBranch(0xD0, loop); //bne
+}
+
+//sta each byte of msg and its terminator from $6004 on
+static void mkText(const char *msg)
+{
+	uint16_t i;
+	for(i = 0; i <= strlen(msg); i++)
+		mkStore(msg[i], 0x6004+i);
+}
+
+//start of every $6000 protocol rom, two vblanks
+//for the ppu to warm up, then signature and running
+static void mkProtocolStart(uint8_t reset)
+{
+	uint8_t v1 = mkNewLabel(), v2 = mkNewLabel();
+	mkLabel(reset);
+	MK(0x78, 0xD8, 0xA2, 0xFF, 0x9A); //sei cld ldx #$FF txs
+	mkWaitVblank(v1);
+	mkWaitVblank(v2);
+	mkStore(0xDE, 0x6001);
+	mkStore(0xB0, 0x6002);
+	mkStore(0x61, 0x6003);
+	mkStore(0x80, 0x6000);
+}
+
+//counts loops in $01:$00 until bit addr takes the branch, a
+//loop is 11 cycles and every 256th one takes 4 more for iny
+static void mkCount(uint16_t addr, uint8_t branch)
+{
+	uint8_t loop = mkNewLabel(), done = mkNewLabel();
+	MK(0xA2, 0x00, 0xA0, 0x00); //ldx #0 ldy #0
+	mkLabel(loop);
+	mkByte(0x2C); mkByte(addr&0xFF); mkByte(addr>>8); //bit addr
+	mkBranch(branch, done);
+	MK(0xE8); //inx
+	mkBranch(0xD0, loop); //bne
+	MK(0xC8); //iny
+	mkAbs(0x4C, loop);
+	mkLabel(done);
+	MK(0x86, 0x00, 0x84, 0x01); //stx $00 sty $01
+}
+
+//$01:$00 = $05:$04 - $01:$00
+static void mkCountDiff()
+{
+	MK(0x38, 0xA5, 0x04, 0xE5, 0x00, 0x85, 0x00); //sec lda $04 sbc $00 sta $00
+	MK(0xA5, 0x05, 0xE5, 0x01, 0x85, 0x01); //lda $05 sbc $01 sta $01
+}
+
+//jumps to fail with code in x unless lo <= $01:$00 <= hi
+static void mkCheck(uint16_t lo, uint16_t hi, uint8_t code, uint8_t fail)
+{
+	mkByte(0xA2); mkByte(code); //ldx #code
+	MK(0xA5, 0x00, 0xC9); mkByte(lo&0xFF); //lda $00 cmp #<lo
+	MK(0xA5, 0x01, 0xE9); mkByte(lo>>8); //lda $01 sbc #>lo
+	MK(0xB0, 0x03); //bcs +3
+	mkAbs(0x4C, fail);
+	mkByte(0xA9); mkByte(hi&0xFF); MK(0xC5, 0x00); //lda #<hi cmp $00
+	mkByte(0xA9); mkByte(hi>>8); MK(0xE5, 0x01); //lda #>hi sbc $01
+	MK(0xB0, 0x03);
+	mkAbs(0x4C, fail);
+}
+
+//jumps to fail with code in x if bit addr takes the branch
+static void mkCheckBit(uint16_t addr, uint8_t branch, uint8_t code, uint8_t fail)
+{
+	mkByte(0xA2); mkByte(code);
+	mkByte(0x2C); mkByte(addr&0xFF); mkByte(addr>>8);
+	mkByte(branch^0x20); mkByte(0x03); //opposite branch +3
+	mkAbs(0x4C, fail);
+}
+
+//reports code in x with the last count as 4 hex digits
+static void mkFailReport(uint8_t fail)
+{
+	uint8_t hex = mkNewLabel(), end = mkNewLabel();
+	static const char digits[] = "0123456789ABCDEF";
+	uint8_t i;
+	mkLabel(fail);
+	MK(0x86, 0x02); //stx $02
+	mkText("Failed #0\ncount 0000\n");
+	MK(0x8A, 0x09, 0x30, 0x8D, 0x0C, 0x60); //txa ora #$30 sta $600C
+	for(i = 0; i < 4; i++)
+	{
+		//high nibble of $01, low of $01, high of $00, low of $00
+		mkByte(0xA5); mkByte(0x01 - (i>>1)); //lda $01/$00
+		if(!(i&1))
+			MK(0x4A, 0x4A, 0x4A, 0x4A); //lsr x4
+		MK(0x29, 0x0F, 0xAA); //and #$0F tax
+		mkAbs(0xBD, hex); //lda hex,x
+		mkByte(0x8D); mkByte(0x14+i); mkByte(0x60); //sta $6014+i
+	}
+	MK(0xA5, 0x02, 0x8D, 0x00, 0x60); //lda $02 sta $6000
+	mkJmpSelf(end);
+	mkLabel(hex);
+	mkBytes((const uint8_t*)digits, 16);
+}
+
+//all checks went through
+static void mkPassReport()
+{
+	uint8_t end = mkNewLabel();
+	mkText("Passed\n");
+	mkStore(0, 0x6000);
+	mkJmpSelf(end);
+}
+
+static bool mkFinish(const char *dir, const char *name, uint8_t nmi, uint8_t reset)
+{
+	uint8_t i;
+	for(i = 0; i < mkFixupNum; i++)
+	{
+		uint16_t target = mkLabels[mkFixups[i].label];
+		uint16_t pos = mkFixups[i].pos;
+		if(mkFixups[i].rel)
+		{
+			int off = target - (MK_ORG + pos + 1);
+			if(off < -128 || off > 127)
+			{
+				printf("mkroms: Branch out of range in %s\n", name);
+				return false;
+			}
+			mkPrg[pos] = (uint8_t)off;
+		}
+		else
+		{
+			mkPrg[pos] = target&0xFF;
+			mkPrg[pos+1] = target>>8;
+		}
+	}
+	mkPrg[0x3FFA] = mkLabels[nmi]&0xFF; mkPrg[0x3FFB] = mkLabels[nmi]>>8;
+	mkPrg[0x3FFC] = mkLabels[reset]&0xFF; mkPrg[0x3FFD] = mkLabels[reset]>>8;
+	mkPrg[0x3FFE] = mkLabels[nmi]&0xFF; mkPrg[0x3FFF] = mkLabels[nmi]>>8;
+	//16k prg, 8k chr, vertical mirroring, no battery so runs never
+	//leave a save next to the rom that changes the next run
+	static const uint8_t hdr[16] = { 'N', 'E', 'S', 0x1A, 1, 1, 1, 0 };
+	char path[1024];
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+	FILE *f = fopen(path, "wb");
+	if(!f)
+	{
+		printf("mkroms: Could not write %s\n", path);
+		return false;
+	}
+	fwrite(hdr, 1, sizeof(hdr), f);
+	fwrite(mkPrg, 1, sizeof(mkPrg), f);
+	fwrite(mkChr, 1, sizeof(mkChr), f);
+	fclose(f);
+	return true;
+}
+
+//$6000 protocol roms, see testrom.c
+static bool mkProtocolRom(const char *dir, const char *name, uint8_t kind)
+{
+	enum { L_RESET, L_SECOND, L_HANG, L_END, L_NMI };
+	mkStart();
+	mkProtocolStart(L_RESET);
+	if(kind == ROM_RESET)
+	{
+		//first boot marks $6100 and asks for a reset, the second passes
+		MK(0xAD, 0x00, 0x61, 0xC9, 0x5A); //lda $6100 cmp #$5A
+		mkBranch(0xF0, L_SECOND); //beq
+		mkStore(0x5A, 0x6100);
+		mkStore(0x81, 0x6000);
+		mkJmpSelf(L_HANG);
+		mkLabel(L_SECOND);
+	}
+	//let 40 frames pass before reporting
+	mkWaitFrames(40);
+	if(kind == ROM_TIMEOUT)
+		mkJmpSelf(L_HANG);
+	else
+	{
+		mkText((kind == ROM_FAIL) ? "Failed #3\nbad timing\n" : "Passed\n");
+		mkStore(kind == ROM_FAIL ? 3 : 0, 0x6000);
+	}
+	mkJmpSelf(L_END);
+	mkLabel(L_NMI);
+	MK(0x40); //rti
+	return mkFinish(dir, name, L_NMI, L_RESET);
+}
+
+//background tile plus sprite 0 on scanline 80, the pad gets read
+//right after the hit and the buttons kept at $12
+static bool mkInputRom(const char *dir, const char *name)
+{
+	enum { L_RESET, L_V1, L_V2, L_PAL, L_OAM, L_MAIN, L_HITCLR, L_HIT, L_READ, L_NMI, L_PALDATA };
+	uint8_t i;
+	mkStart();
+	mkLabel(L_RESET);
+	MK(0x78, 0xD8, 0xA2, 0xFF, 0x9A);
+	mkWaitVblank(L_V1);
+	mkWaitVblank(L_V2);
+	//palette from the table at the end
+	MK(0xA9, 0x3F, 0x8D, 0x06, 0x20, 0xA9, 0x00, 0x8D, 0x06, 0x20, 0xA2, 0x00);
+	mkLabel(L_PAL);
+	mkAbs(0xBD, L_PALDATA); //lda table,x
+	MK(0x8D, 0x07, 0x20, 0xE8, 0xE0, 0x20); //sta $2007 inx cpx #$20
+	mkBranch(0xD0, L_PAL);
+	//one background tile at $214A
+	MK(0xA9, 0x21, 0x8D, 0x06, 0x20, 0xA9, 0x4A, 0x8D, 0x06, 0x20, 0xA9, 0x01, 0x8D, 0x07, 0x20);
+	//oam page at $200 all hidden, then sprite 0 and one more
+	MK(0xA9, 0xFF, 0xA2, 0x00);
+	mkLabel(L_OAM);
+	MK(0x9D, 0x00, 0x02, 0xE8); //sta $200,x inx
+	mkBranch(0xD0, L_OAM);
+	mkStore(79, 0x200); mkStore(1, 0x201); mkStore(0, 0x202); mkStore(80, 0x203);
+	mkStore(120, 0x204); mkStore(1, 0x205); mkStore(1, 0x206); mkStore(30, 0x207);
+	MK(0xA9, 0x00, 0x8D, 0x05, 0x20, 0x8D, 0x05, 0x20);
+	mkStore(0x80, 0x2000);
+	mkStore(0x1E, 0x2001);
+	mkLabel(L_MAIN);
+	//wait for the hit flag to clear in vblank, then for the hit
+	mkLabel(L_HITCLR);
+	MK(0x2C, 0x02, 0x20);
+	mkBranch(0x70, L_HITCLR); //bvs
+	mkLabel(L_HIT);
+	MK(0x2C, 0x02, 0x20);
+	mkBranch(0x50, L_HIT); //bvc
+	MK(0xE6, 0x10); //inc $10
+	MK(0xA9, 0x01, 0x8D, 0x16, 0x40, 0xA9, 0x00, 0x8D, 0x16, 0x40, 0xA2, 0x08);
+	mkLabel(L_READ);
+	MK(0xAD, 0x16, 0x40, 0x4A, 0x26, 0x12, 0xCA); //lda $4016 lsr rol $12 dex
+	mkBranch(0xD0, L_READ);
+	mkAbs(0x4C, L_MAIN);
+	//sprite dma every frame, counts frames at $11
+	mkLabel(L_NMI);
+	MK(0x48, 0xA9, 0x02, 0x8D, 0x14, 0x40, 0xE6, 0x11, 0xA9, 0x00, 0x8D, 0x05, 0x20, 0x8D, 0x05, 0x20, 0x68, 0x40);
+	mkLabel(L_PALDATA);
+	for(i = 0; i < 8; i++)
+		MK(0x0F, 0x16, 0x27, 0x18);
+	//tile 1 is a solid line on top
+	memset(mkChr+16, 0xFF, 8);
+	return mkFinish(dir, name, L_NMI, L_RESET);
+}
+
+//rendering off vblank to vblank, the flag clearing on read and
+//how far into the frame sprite 0 hits on scanline 80
+static bool mkVblRom(const char *dir, const char *name)
+{
+	enum { L_RESET, L_V1, L_V2, L_HIT, L_HITCLR, L_FAIL, L_NMI };
+	mkStart();
+	mkProtocolStart(L_RESET);
+	//89342 dots are 29780.67 cycles
+	mkWaitVblank(L_V1);
+	mkCount(0x2002, 0x30); //bmi
+	mkCheck(2701, 2704, 2, L_FAIL);
+	//the bit in the loop that saw it already cleared it
+	mkCheckBit(0x2002, 0x30, 3, L_FAIL);
+	//background tile 1 at $214A and sprite 0 over it, so
+	//both are opaque from scanline 80 dot 81 on
+	mkWaitVblank(L_V2);
+	MK(0xA9, 0x21, 0x8D, 0x06, 0x20, 0xA9, 0x4A, 0x8D, 0x06, 0x20, 0xA9, 0x01, 0x8D, 0x07, 0x20);
+	mkStore(0, 0x2003);
+	mkStore(79, 0x2004); mkStore(1, 0x2004); mkStore(0, 0x2004); mkStore(80, 0x2004);
+	MK(0xA9, 0x00, 0x8D, 0x00, 0x20, 0x8D, 0x05, 0x20, 0x8D, 0x05, 0x20);
+	mkStore(0x1E, 0x2001);
+	//one hit to be sure rendering runs, then the flag clears
+	//on the pre-render line dot 1, 27701 dots before the hit
+	mkLabel(L_HIT);
+	MK(0x2C, 0x02, 0x20);
+	mkBranch(0x50, L_HIT); //bvc
+	mkLabel(L_HITCLR);
+	MK(0x2C, 0x02, 0x20);
+	mkBranch(0x70, L_HITCLR); //bvs
+	mkCount(0x2002, 0x70); //bvs
+	mkCheck(836, 839, 4, L_FAIL);
+	mkStore(0x00, 0x2001);
+	mkPassReport();
+	mkFailReport(L_FAIL);
+	mkLabel(L_NMI);
+	MK(0x40); //rti
+	memset(mkChr+16, 0xFF, 8);
+	return mkFinish(dir, name, L_NMI, L_RESET);
+}
+
+//the 4 step frame counter sets its flag and irq 29829 cycles after
+//the $4017 write, inhibited or in 5 step mode it never does
+static bool mkFrameIrqRom(const char *dir, const char *name)
+{
+	enum { L_RESET, L_FAIL, L_IRQ };
+	mkStart();
+	mkProtocolStart(L_RESET);
+	//$40 clears a flag left from the warm up
+	mkStore(0x40, 0x4017);
+	MK(0xA9, 0x00, 0x8D, 0x17, 0x40); //lda #0 sta $4017
+	mkCount(0x4015, 0x70); //bvs
+	mkCheck(2706, 2709, 2, L_FAIL);
+	//the flag is up for 3 cycles, past those the read acks it
+	MK(0xEA, 0xEA, 0xEA, 0xEA, 0xAD, 0x15, 0x40); //nop x4 lda $4015
+	mkCheckBit(0x4015, 0x70, 3, L_FAIL);
+	mkStore(0x40, 0x4017);
+	mkWaitFrames(4);
+	mkCheckBit(0x4015, 0x70, 4, L_FAIL);
+	mkStore(0x80, 0x4017);
+	mkWaitFrames(4);
+	mkCheckBit(0x4015, 0x70, 5, L_FAIL);
+	//the irq handler sets bit 6 of $03
+	mkStore(0x00, 0x0003);
+	MK(0xA9, 0x00, 0x8D, 0x17, 0x40, 0x58); //lda #0 sta $4017 cli
+	mkCount(0x0003, 0x70);
+	MK(0x78); //sei
+	mkCheck(2706, 2709, 6, L_FAIL);
+	mkPassReport();
+	mkFailReport(L_FAIL);
+	mkLabel(L_IRQ);
+	MK(0x48, 0xAD, 0x15, 0x40, 0xA9, 0x40, 0x85, 0x03, 0x68, 0x40); //pha lda $4015 lda #$40 sta $03 pla rti
+	return mkFinish(dir, name, L_IRQ, L_RESET);
+}
+
+//counts from one nmi to the next with a 4 cycle sta to target
+//right after the first, $4014 there adds the OAM DMA
+static void mkNmiCount(uint16_t target)
+{
+	uint8_t sync = mkNewLabel();
+	mkStore(0x00, 0x0003);
+	mkLabel(sync);
+	MK(0x2C, 0x03, 0x00); //bit $0003
+	mkBranch(0x50, sync); //bvc
+	mkStore(0x00, 0x0003);
+	mkStore(0x02, target);
+	mkCount(0x0003, 0x70); //bvs
+}
+
+//a frame is 29780.67 cycles, OAM DMA takes 513 or 514 of them and
+//DMC DMA at rate $F about 69 fetches of 3 or 4 cycles each,
+//which one depends on the get/put alignment it starts on
+static bool mkDmaRom(const char *dir, const char *name)
+{
+	enum { L_RESET, L_FAIL, L_NMI };
+	mkStart();
+	mkProtocolStart(L_RESET);
+	mkStore(0x80, 0x2000);
+	mkNmiCount(0x0700);
+	MK(0xA5, 0x00, 0x85, 0x04, 0xA5, 0x01, 0x85, 0x05); //keep it at $05:$04
+	mkCheck(2697, 2701, 2, L_FAIL);
+	mkNmiCount(0x4014);
+	mkCountDiff();
+	mkCheck(45, 48, 3, L_FAIL);
+	//looped sample from $C000, so it fetches all frame long
+	mkStore(0x4F, 0x4010);
+	mkStore(0x00, 0x4012);
+	mkStore(0xFF, 0x4013);
+	mkStore(0x10, 0x4015);
+	mkNmiCount(0x0700);
+	mkStore(0x00, 0x4015);
+	mkCountDiff();
+	mkCheck(16, 27, 4, L_FAIL);
+	mkStore(0x00, 0x2000);
+	mkPassReport();
+	mkFailReport(L_FAIL);
+	mkLabel(L_NMI);
+	MK(0x48, 0xA9, 0x40, 0x85, 0x03, 0x68, 0x40); //pha lda #$40 sta $03 pla rti
+	return mkFinish(dir, name, L_NMI, L_RESET);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *dir = (argc >= 2) ? argv[1] : ".";
+	bool ok = mkProtocolRom(dir, "pass.nes", ROM_PASS)
+		&& mkProtocolRom(dir, "fail.nes", ROM_FAIL)
+		&& mkProtocolRom(dir, "reset.nes", ROM_RESET)
+		&& mkProtocolRom(dir, "timeout.nes", ROM_TIMEOUT)
+		&& mkInputRom(dir, "input.nes")
+		&& mkVblRom(dir, "vbl.nes")
+		&& mkFrameIrqRom(dir, "frameirq.nes")
+		&& mkDmaRom(dir, "dma.nes");
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
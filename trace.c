@@ -0,0 +1,289 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include "cpu.h"
+#include "ppu.h"
+#include "dbg.h"
+#include "mapper.h"
+#include "trace.h"
+
+/*
+ * Every executed instruction becomes one fixed size binary record,
+ * filled into a preallocated buffer. Either the buffer goes to the
+ * file whenever it is full, or it is used as ring that only keeps
+ * the last instructions and gets written out on stop. Turning the
+ * records into text only happens later in tracePrint/traceDiff.
+ * Records are stored in host byte order.
+ */
+#define TRACE_BUF_RECS 0x10000
+#define TRACE_VERSION 2
+
+enum {
+	MODE_IMP = 0, MODE_ACC, MODE_IMM, MODE_ZP, MODE_ZPX, MODE_ZPY, MODE_ABS,
+	MODE_ABX, MODE_ABY, MODE_IND, MODE_IZX, MODE_IZY, MODE_REL
+};
+
+static const uint8_t traceModeLen[] = { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 2, 2, 2 };
+
+static const char traceOpNames[256][4] = {
+	"BRK", "ORA", "KIL", "SLO", "NOP", "ORA", "ASL", "SLO", "PHP", "ORA", "ASL", "ANC", "NOP", "ORA", "ASL", "SLO",
+	"BPL", "ORA", "KIL", "SLO", "NOP", "ORA", "ASL", "SLO", "CLC", "ORA", "NOP", "SLO", "NOP", "ORA", "ASL", "SLO",
+	"JSR", "AND", "KIL", "RLA", "BIT", "AND", "ROL", "RLA", "PLP", "AND", "ROL", "ANC", "BIT", "AND", "ROL", "RLA",
+	"BMI", "AND", "KIL", "RLA", "NOP", "AND", "ROL", "RLA", "SEC", "AND", "NOP", "RLA", "NOP", "AND", "ROL", "RLA",
+	"RTI", "EOR", "KIL", "SRE", "NOP", "EOR", "LSR", "SRE", "PHA", "EOR", "LSR", "ALR", "JMP", "EOR", "LSR", "SRE",
+	"BVC", "EOR", "KIL", "SRE", "NOP", "EOR", "LSR", "SRE", "CLI", "EOR", "NOP", "SRE", "NOP", "EOR", "LSR", "SRE",
+	"RTS", "ADC", "KIL", "RRA", "NOP", "ADC", "ROR", "RRA", "PLA", "ADC", "ROR", "ARR", "JMP", "ADC", "ROR", "RRA",
+	"BVS", "ADC", "KIL", "RRA", "NOP", "ADC", "ROR", "RRA", "SEI", "ADC", "NOP", "RRA", "NOP", "ADC", "ROR", "RRA",
+	"NOP", "STA", "NOP", "SAX", "STY", "STA", "STX", "SAX", "DEY", "NOP", "TXA", "XAA", "STY", "STA", "STX", "SAX",
+	"BCC", "STA", "KIL", "AHX", "STY", "STA", "STX", "SAX", "TYA", "STA", "TXS", "TAS", "SHY", "STA", "SHX", "AHX",
+	"LDY", "LDA", "LDX", "LAX", "LDY", "LDA", "LDX", "LAX", "TAY", "LDA", "TAX", "LAX", "LDY", "LDA", "LDX", "LAX",
+	"BCS", "LDA", "KIL", "LAX", "LDY", "LDA", "LDX", "LAX", "CLV", "LDA", "TSX", "LAS", "LDY", "LDA", "LDX", "LAX",
+	"CPY", "CMP", "NOP", "DCP", "CPY", "CMP", "DEC", "DCP", "INY", "CMP", "DEX", "AXS", "CPY", "CMP", "DEC", "DCP",
+	"BNE", "CMP", "KIL", "DCP", "NOP", "CMP", "DEC", "DCP", "CLD", "CMP", "NOP", "DCP", "NOP", "CMP", "DEC", "DCP",
+	"CPX", "SBC", "NOP", "ISB", "CPX", "SBC", "INC", "ISB", "INX", "SBC", "NOP", "SBC", "CPX", "SBC", "INC", "ISB",
+	"BEQ", "SBC", "KIL", "ISB", "NOP", "SBC", "INC", "ISB", "SED", "SBC", "NOP", "ISB", "NOP", "SBC", "INC", "ISB",
+};
+
+static const uint8_t traceOpModes[256] = {
+	MODE_IMP, MODE_IZX, MODE_IMP, MODE_IZX, MODE_ZP, MODE_ZP, MODE_ZP, MODE_ZP, MODE_IMP, MODE_IMM, MODE_ACC, MODE_IMM, MODE_ABS, MODE_ABS, MODE_ABS, MODE_ABS,
+	MODE_REL, MODE_IZY, MODE_IMP, MODE_IZY, MODE_ZPX, MODE_ZPX, MODE_ZPX, MODE_ZPX, MODE_IMP, MODE_ABY, MODE_IMP, MODE_ABY, MODE_ABX, MODE_ABX, MODE_ABX, MODE_ABX,
+	MODE_ABS, MODE_IZX, MODE_IMP, MODE_IZX, MODE_ZP, MODE_ZP, MODE_ZP, MODE_ZP, MODE_IMP, MODE_IMM, MODE_ACC, MODE_IMM, MODE_ABS, MODE_ABS, MODE_ABS, MODE_ABS,
+	MODE_REL, MODE_IZY, MODE_IMP, MODE_IZY, MODE_ZPX, MODE_ZPX, MODE_ZPX, MODE_ZPX, MODE_IMP, MODE_ABY, MODE_IMP, MODE_ABY, MODE_ABX, MODE_ABX, MODE_ABX, MODE_ABX,
+	MODE_IMP, MODE_IZX, MODE_IMP, MODE_IZX, MODE_ZP, MODE_ZP, MODE_ZP, MODE_ZP, MODE_IMP, MODE_IMM, MODE_ACC, MODE_IMM, MODE_ABS, MODE_ABS, MODE_ABS, MODE_ABS,
+	MODE_REL, MODE_IZY, MODE_IMP, MODE_IZY, MODE_ZPX, MODE_ZPX, MODE_ZPX, MODE_ZPX, MODE_IMP, MODE_ABY, MODE_IMP, MODE_ABY, MODE_ABX, MODE_ABX, MODE_ABX, MODE_ABX,
+	MODE_IMP, MODE_IZX, MODE_IMP, MODE_IZX, MODE_ZP, MODE_ZP, MODE_ZP, MODE_ZP, MODE_IMP, MODE_IMM, MODE_ACC, MODE_IMM, MODE_IND, MODE_ABS, MODE_ABS, MODE_ABS,
+	MODE_REL, MODE_IZY, MODE_IMP, MODE_IZY, MODE_ZPX, MODE_ZPX, MODE_ZPX, MODE_ZPX, MODE_IMP, MODE_ABY, MODE_IMP, MODE_ABY, MODE_ABX, MODE_ABX, MODE_ABX, MODE_ABX,
+	MODE_IMM, MODE_IZX, MODE_IMM, MODE_IZX, MODE_ZP, MODE_ZP, MODE_ZP, MODE_ZP, MODE_IMP, MODE_IMM, MODE_IMP, MODE_IMM, MODE_ABS, MODE_ABS, MODE_ABS, MODE_ABS,
+	MODE_REL, MODE_IZY, MODE_IMP, MODE_IZY, MODE_ZPX, MODE_ZPX, MODE_ZPY, MODE_ZPY, MODE_IMP, MODE_ABY, MODE_IMP, MODE_ABY, MODE_ABX, MODE_ABX, MODE_ABY, MODE_ABY,
+	MODE_IMM, MODE_IZX, MODE_IMM, MODE_IZX, MODE_ZP, MODE_ZP, MODE_ZP, MODE_ZP, MODE_IMP, MODE_IMM, MODE_IMP, MODE_IMM, MODE_ABS, MODE_ABS, MODE_ABS, MODE_ABS,
+	MODE_REL, MODE_IZY, MODE_IMP, MODE_IZY, MODE_ZPX, MODE_ZPX, MODE_ZPY, MODE_ZPY, MODE_IMP, MODE_ABY, MODE_IMP, MODE_ABY, MODE_ABX, MODE_ABX, MODE_ABY, MODE_ABY,
+	MODE_IMM, MODE_IZX, MODE_IMM, MODE_IZX, MODE_ZP, MODE_ZP, MODE_ZP, MODE_ZP, MODE_IMP, MODE_IMM, MODE_IMP, MODE_IMM, MODE_ABS, MODE_ABS, MODE_ABS, MODE_ABS,
+	MODE_REL, MODE_IZY, MODE_IMP, MODE_IZY, MODE_ZPX, MODE_ZPX, MODE_ZPX, MODE_ZPX, MODE_IMP, MODE_ABY, MODE_IMP, MODE_ABY, MODE_ABX, MODE_ABX, MODE_ABX, MODE_ABX,
+	MODE_IMM, MODE_IZX, MODE_IMM, MODE_IZX, MODE_ZP, MODE_ZP, MODE_ZP, MODE_ZP, MODE_IMP, MODE_IMM, MODE_IMP, MODE_IMM, MODE_ABS, MODE_ABS, MODE_ABS, MODE_ABS,
+	MODE_REL, MODE_IZY, MODE_IMP, MODE_IZY, MODE_ZPX, MODE_ZPX, MODE_ZPX, MODE_ZPX, MODE_IMP, MODE_ABY, MODE_IMP, MODE_ABY, MODE_ABX, MODE_ABX, MODE_ABX, MODE_ABX,
+};
+
+
+bool traceActive = false;
+static FILE *traceFile = NULL;
+static trace_rec_t *traceBuf = NULL;
+static uint32_t traceBufRecs;
+static uint32_t tracePos;
+static bool traceRing;
+static bool traceWrapped;
+static uint64_t traceTotal;
+
+bool traceStart(const char *path, uint32_t ringRecs)
+{
+	uint8_t hdr[8] = { 'F', 'X', 'T', 'R', TRACE_VERSION, sizeof(trace_rec_t), 0, 0 };
+	traceStop();
+	traceFile = fopen(path, "wb");
+	if(traceFile == NULL)
+	{
+		printf("Trace: Could not write %s\n", path);
+		return false;
+	}
+	traceRing = (ringRecs != 0);
+	traceBufRecs = traceRing ? ringRecs : TRACE_BUF_RECS;
+	traceBuf = malloc((size_t)traceBufRecs*sizeof(trace_rec_t));
+	if(traceBuf == NULL)
+	{
+		printf("Trace: Could not allocate %u records\n", traceBufRecs);
+		fclose(traceFile);
+		traceFile = NULL;
+		return false;
+	}
+	fwrite(hdr, 1, sizeof(hdr), traceFile);
+	tracePos = 0;
+	traceWrapped = false;
+	traceTotal = 0;
+	traceActive = true;
+	if(traceRing)
+		printf("Trace: Keeping the last %u instructions for %s\n", traceBufRecs, path);
+	else
+		printf("Trace: Writing every instruction to %s\n", path);
+	return true;
+}
+
+void traceStop()
+{
+	if(traceFile == NULL)
+		return;
+	if(traceWrapped)
+		fwrite(traceBuf+tracePos, sizeof(trace_rec_t), traceBufRecs-tracePos, traceFile);
+	fwrite(traceBuf, sizeof(trace_rec_t), tracePos, traceFile);
+	fclose(traceFile);
+	traceFile = NULL;
+	free(traceBuf);
+	traceBuf = NULL;
+	traceActive = false;
+	printf("Trace: %" PRIu64 " instructions traced\n", traceTotal);
+}
+
+//called right after the opcode fetch, before anything executes
+void traceInstr(uint8_t op)
+{
+	trace_rec_t *rec = &traceBuf[tracePos];
+	cpuRegs_t r;
+	uint8_t len = traceModeLen[traceOpModes[op]];
+	cpuGetRegs(&r);
+	rec->cycle = cpuGetCycles();
+	rec->pc = r.pc;
+	rec->line = ppuGetCurLine();
+	rec->dot = ppuGetCurDot();
+	rec->op[0] = op;
+	rec->op[1] = 0;
+	rec->op[2] = 0;
+	if(len > 1)
+		dbgPeek8(r.pc+1, &rec->op[1]);
+	if(len > 2)
+		dbgPeek8(r.pc+2, &rec->op[2]);
+	rec->a = r.a;
+	rec->x = r.x;
+	rec->y = r.y;
+	rec->p = r.p;
+	rec->s = r.s;
+	rec->bank = mapperGetPrgBank(r.pc);
+	traceTotal++;
+	if(++tracePos < traceBufRecs)
+		return;
+	tracePos = 0;
+	if(traceRing)
+		traceWrapped = true;
+	else
+		fwrite(traceBuf, sizeof(trace_rec_t), traceBufRecs, traceFile);
+}
+
+static FILE *traceOpen(const char *path)
+{
+	uint8_t hdr[8];
+	FILE *f = fopen(path, "rb");
+	if(f == NULL)
+	{
+		printf("Trace: Could not open %s\n", path);
+		return NULL;
+	}
+	if(fread(hdr, 1, sizeof(hdr), f) != sizeof(hdr) || memcmp(hdr, "FXTR", 4) != 0
+		|| hdr[4] != TRACE_VERSION || hdr[5] != sizeof(trace_rec_t))
+	{
+		printf("Trace: %s is no fixNES trace\n", path);
+		fclose(f);
+		return NULL;
+	}
+	return f;
+}
+
+//same layout as the well known nestest.log, the bank comes last
+static void traceFormat(const trace_rec_t *rec, char *out)
+{
+	char bytes[12], args[16];
+	uint8_t mode = traceOpModes[rec->op[0]];
+	uint16_t w = rec->op[1] | (rec->op[2]<<8);
+	if(traceModeLen[mode] == 1)
+		sprintf(bytes, "%02X", rec->op[0]);
+	else if(traceModeLen[mode] == 2)
+		sprintf(bytes, "%02X %02X", rec->op[0], rec->op[1]);
+	else
+		sprintf(bytes, "%02X %02X %02X", rec->op[0], rec->op[1], rec->op[2]);
+	switch(mode)
+	{
+		case MODE_ACC: strcpy(args, "A"); break;
+		case MODE_IMM: sprintf(args, "#$%02X", rec->op[1]); break;
+		case MODE_ZP: sprintf(args, "$%02X", rec->op[1]); break;
+		case MODE_ZPX: sprintf(args, "$%02X,X", rec->op[1]); break;
+		case MODE_ZPY: sprintf(args, "$%02X,Y", rec->op[1]); break;
+		case MODE_ABS: sprintf(args, "$%04X", w); break;
+		case MODE_ABX: sprintf(args, "$%04X,X", w); break;
+		case MODE_ABY: sprintf(args, "$%04X,Y", w); break;
+		case MODE_IND: sprintf(args, "($%04X)", w); break;
+		case MODE_IZX: sprintf(args, "($%02X,X)", rec->op[1]); break;
+		case MODE_IZY: sprintf(args, "($%02X),Y", rec->op[1]); break;
+		case MODE_REL: sprintf(args, "$%04X", (uint16_t)(rec->pc+2+(int8_t)rec->op[1])); break;
+		default: args[0] = '\0'; break;
+	}
+	sprintf(out, "%04X  %-8s  %s %-27s A:%02X X:%02X Y:%02X P:%02X SP:%02X PPU:%3i,%3i CYC:%" PRIu64 " BK:%02X",
+		rec->pc, bytes, traceOpNames[rec->op[0]], args, rec->a, rec->x, rec->y, rec->p, rec->s,
+		rec->line, rec->dot, rec->cycle, rec->bank);
+}
+
+bool tracePrint(const char *path)
+{
+	trace_rec_t rec;
+	char line[128];
+	FILE *f = traceOpen(path);
+	if(f == NULL)
+		return false;
+	while(fread(&rec, sizeof(rec), 1, f) == 1)
+	{
+		traceFormat(&rec, line);
+		puts(line);
+	}
+	fclose(f);
+	return true;
+}
+
+#define TRACE_DIFF_CONTEXT 4
+
+//prints the first instruction where both traces went different ways
+bool traceDiff(const char *pathA, const char *pathB)
+{
+	trace_rec_t ctx[TRACE_DIFF_CONTEXT], ra, rb;
+	char line[128];
+	uint64_t n = 0;
+	bool gotA, gotB, same = true;
+	FILE *fa = traceOpen(pathA);
+	if(fa == NULL)
+		return false;
+	FILE *fb = traceOpen(pathB);
+	if(fb == NULL)
+	{
+		fclose(fa);
+		return false;
+	}
+	while(1)
+	{
+		gotA = (fread(&ra, sizeof(ra), 1, fa) == 1);
+		gotB = (fread(&rb, sizeof(rb), 1, fb) == 1);
+		if(!gotA || !gotB)
+		{
+			if(gotA != gotB)
+			{
+				printf("Trace: %s ends after %" PRIu64 " instructions\n", gotA ? pathB : pathA, n);
+				same = false;
+			}
+			else
+				printf("Trace: All %" PRIu64 " instructions match\n", n);
+			break;
+		}
+		if(memcmp(&ra, &rb, sizeof(ra)) != 0)
+		{
+			uint64_t i = (n > TRACE_DIFF_CONTEXT) ? n-TRACE_DIFF_CONTEXT : 0;
+			printf("Trace: First difference at instruction %" PRIu64 "\n", n);
+			for(; i < n; i++)
+			{
+				traceFormat(&ctx[i%TRACE_DIFF_CONTEXT], line);
+				printf("  %s\n", line);
+			}
+			traceFormat(&ra, line);
+			printf("< %s\n", line);
+			traceFormat(&rb, line);
+			printf("> %s\n", line);
+			same = false;
+			break;
+		}
+		ctx[n%TRACE_DIFF_CONTEXT] = ra;
+		n++;
+	}
+	fclose(fa);
+	fclose(fb);
+	return same;
+}
@@ -0,0 +1,32 @@
+/*
+ * Copyright (C) 2017 FIX94
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#ifndef _trace_h_
+#define _trace_h_
+
+//one executed instruction, with the state right before it
+typedef struct _trace_rec_t {
+	uint64_t cycle;
+	uint16_t pc;
+	uint16_t line;
+	uint16_t dot;
+	uint8_t op[3];
+	uint8_t a, x, y, p, s;
+	//8k prg bank at pc, 0 if the mapper does not tell
+	uint16_t bank;
+} trace_rec_t;
+
+//checked by the cpu on every instruction
+extern bool traceActive;
+
+bool traceStart(const char *path, uint32_t ringRecs);
+void traceStop();
+void traceInstr(uint8_t op);
+bool tracePrint(const char *path);
+bool traceDiff(const char *pathA, const char *pathB);
+
+#endif
@@ -20,6 +20,13 @@
 #define ZLIB_FILEFUNC_MODE_CREATE   (8)
 
 
+/* zip64 archives go past 4GB, so offsets are 64bit everywhere */
+#if defined(_MSC_VER) || defined(__BORLANDC__)
+typedef unsigned __int64 ZPOS64_T;
+#else
+typedef unsigned long long int ZPOS64_T;
+#endif
+
 #ifndef ZCALLBACK
 
 #if (defined(WIN32) || defined (WINDOWS) || defined (_WINDOWS)) && defined(CALLBACK) && defined (USEWINDOWS_CALLBACK)
@@ -36,8 +43,8 @@ extern "C" {
 typedef voidpf (ZCALLBACK *open_file_func) OF((voidpf opaque, const char* filename, int mode));
 typedef uLong  (ZCALLBACK *read_file_func) OF((voidpf opaque, voidpf stream, void* buf, uLong size));
 typedef uLong  (ZCALLBACK *write_file_func) OF((voidpf opaque, voidpf stream, const void* buf, uLong size));
-typedef long   (ZCALLBACK *tell_file_func) OF((voidpf opaque, voidpf stream));
-typedef long   (ZCALLBACK *seek_file_func) OF((voidpf opaque, voidpf stream, uLong offset, int origin));
+typedef ZPOS64_T (ZCALLBACK *tell_file_func) OF((voidpf opaque, voidpf stream));
+typedef long   (ZCALLBACK *seek_file_func) OF((voidpf opaque, voidpf stream, ZPOS64_T offset, int origin));
 typedef int    (ZCALLBACK *close_file_func) OF((voidpf opaque, voidpf stream));
 typedef int    (ZCALLBACK *testerror_file_func) OF((voidpf opaque, voidpf stream));
 
@@ -55,7 +62,16 @@ typedef struct zlib_filefunc_def_s
 
 
 
-void fill_memory_filefunc OF((zlib_filefunc_def* pzlib_filefunc_def));
+/* region of memory holding a whole archive, has to stay valid
+   for as long as the archive is open */
+typedef struct zlib_mem_region_s
+{
+    const void* base;
+    uLong       size;
+} zlib_mem_region;
+
+void fill_fopen_filefunc OF((zlib_filefunc_def* pzlib_filefunc_def));
+void fill_memory_filefunc OF((zlib_filefunc_def* pzlib_filefunc_def, zlib_mem_region* region));
 
 #define ZREAD(filefunc,filestream,buf,size) ((*((filefunc).zread_file))((filefunc).opaque,filestream,buf,size))
 #define ZWRITE(filefunc,filestream,buf,size) ((*((filefunc).zwrite_file))((filefunc).opaque,filestream,buf,size))
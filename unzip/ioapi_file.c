@@ -0,0 +1,180 @@
+/* ioapi_file.c -- IO base function header for compress/uncompress .zip
+   files using zlib + zip or unzip API
+   This version of ioapi reads the archive straight from disk through
+   stdio, so only the central directory and the entries actually being
+   extracted are ever read, no matter how large the archive is.
+   Based on Unzip ioapi.c version 1.01e, February 12th, 2005
+   Copyright (C) 1998-2005 Gilles Vollant
+   This file is under the same license as the Unzip tool it is distributed
+   with.
+*/
+
+
+/* zip64 archives go past 4GB, so stdio needs 64bit offsets */
+#ifndef _WIN32
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <sys/types.h>
+#endif
+
+#include "zlib.h"
+#include "ioapi.h"
+
+#ifdef _WIN32
+#define FSEEK64 _fseeki64
+#define FTELL64 _ftelli64
+typedef __int64 zoff64_t;
+#else
+#define FSEEK64 fseeko
+#define FTELL64 ftello
+typedef off_t zoff64_t;
+#endif
+
+
+
+voidpf ZCALLBACK fopen_file_func OF((
+   voidpf opaque,
+   const char* filename,
+   int mode));
+
+uLong ZCALLBACK fread_file_func OF((
+   voidpf opaque,
+   voidpf stream,
+   void* buf,
+   uLong size));
+
+uLong ZCALLBACK fwrite_file_func OF((
+   voidpf opaque,
+   voidpf stream,
+   const void* buf,
+   uLong size));
+
+ZPOS64_T ZCALLBACK ftell_file_func OF((
+   voidpf opaque,
+   voidpf stream));
+
+long ZCALLBACK fseek_file_func OF((
+   voidpf opaque,
+   voidpf stream,
+   ZPOS64_T offset,
+   int origin));
+
+int ZCALLBACK fclose_file_func OF((
+   voidpf opaque,
+   voidpf stream));
+
+int ZCALLBACK ferror_file_func OF((
+   voidpf opaque,
+   voidpf stream));
+
+
+voidpf ZCALLBACK fopen_file_func (opaque, filename, mode)
+   voidpf opaque;
+   const char* filename;
+   int mode;
+{
+	(void)opaque;
+    FILE* file = NULL;
+    const char* mode_fopen = NULL;
+    if ((mode & ZLIB_FILEFUNC_MODE_READWRITEFILTER)==ZLIB_FILEFUNC_MODE_READ)
+        mode_fopen = "rb";
+    else if (mode & ZLIB_FILEFUNC_MODE_EXISTING)
+        mode_fopen = "r+b";
+    else if (mode & ZLIB_FILEFUNC_MODE_CREATE)
+        mode_fopen = "wb";
+
+    if ((filename!=NULL) && (mode_fopen != NULL))
+        file = fopen(filename, mode_fopen);
+    return file;
+}
+
+
+uLong ZCALLBACK fread_file_func (opaque, stream, buf, size)
+   voidpf opaque;
+   voidpf stream;
+   void* buf;
+   uLong size;
+{
+	(void)opaque;
+    return (uLong)fread(buf, 1, (size_t)size, (FILE *)stream);
+}
+
+
+uLong ZCALLBACK fwrite_file_func (opaque, stream, buf, size)
+   voidpf opaque;
+   voidpf stream;
+   const void* buf;
+   uLong size;
+{
+	(void)opaque;
+    return (uLong)fwrite(buf, 1, (size_t)size, (FILE *)stream);
+}
+
+ZPOS64_T ZCALLBACK ftell_file_func (opaque, stream)
+   voidpf opaque;
+   voidpf stream;
+{
+	(void)opaque;
+    return (ZPOS64_T)FTELL64((FILE *)stream);
+}
+
+long ZCALLBACK fseek_file_func (opaque, stream, offset, origin)
+   voidpf opaque;
+   voidpf stream;
+   ZPOS64_T offset;
+   int origin;
+{
+	(void)opaque;
+    int fseek_origin;
+    switch (origin)
+    {
+    case ZLIB_FILEFUNC_SEEK_CUR :
+        fseek_origin = SEEK_CUR;
+        break;
+    case ZLIB_FILEFUNC_SEEK_END :
+        fseek_origin = SEEK_END;
+        break;
+    case ZLIB_FILEFUNC_SEEK_SET :
+        fseek_origin = SEEK_SET;
+        break;
+    default: return -1;
+    }
+    /* offsets relative to the end come in as negative numbers */
+    if (FSEEK64((FILE *)stream, (zoff64_t)offset, fseek_origin) != 0)
+        return -1;
+    return 0;
+}
+
+int ZCALLBACK fclose_file_func (opaque, stream)
+   voidpf opaque;
+   voidpf stream;
+{
+	(void)opaque;
+    return fclose((FILE *)stream);
+}
+
+int ZCALLBACK ferror_file_func (opaque, stream)
+   voidpf opaque;
+   voidpf stream;
+{
+	(void)opaque;
+    return ferror((FILE *)stream);
+}
+
+void fill_fopen_filefunc (pzlib_filefunc_def)
+  zlib_filefunc_def* pzlib_filefunc_def;
+{
+    pzlib_filefunc_def->zopen_file = fopen_file_func;
+    pzlib_filefunc_def->zread_file = fread_file_func;
+    pzlib_filefunc_def->zwrite_file = fwrite_file_func;
+    pzlib_filefunc_def->ztell_file = ftell_file_func;
+    pzlib_filefunc_def->zseek_file = fseek_file_func;
+    pzlib_filefunc_def->zclose_file = fclose_file_func;
+    pzlib_filefunc_def->zerror_file = ferror_file_func;
+    pzlib_filefunc_def->opaque = NULL;
+}
@@ -41,14 +41,14 @@ uLong ZCALLBACK fwrite_mem_func OF((
    const void* buf,
    uLong size));
 
-long ZCALLBACK ftell_mem_func OF((
+ZPOS64_T ZCALLBACK ftell_mem_func OF((
    voidpf opaque,
    voidpf stream));
 
 long ZCALLBACK fseek_mem_func OF((
    voidpf opaque,
    voidpf stream,
-   uLong offset,
+   ZPOS64_T offset,
    int origin));
 
 int ZCALLBACK fclose_mem_func OF((
@@ -72,19 +72,20 @@ voidpf ZCALLBACK fopen_mem_func (opaque, filename, mode)
    const char* filename;
    int mode;
 {
-	(void)opaque;
+    (void)filename;
+    const zlib_mem_region *region = (const zlib_mem_region *)opaque;
+    if (region==NULL || region->base==NULL)
+      return NULL;
+
     ourmemory_t *mem = malloc(sizeof(*mem));
     if (mem==NULL)
       return NULL; /* Can't allocate space, so failed */
 
-    /* Filenames are specified in the form :
-     *    <hex base of zip file>+<hex size of zip file>
-     * This may not work where memory addresses are longer than the
-     * size of an int and therefore may need addressing for 64bit
-     * architectures
+    /* The region comes in through the opaque pointer given to
+     * fill_memory_filefunc, the filename is not used.
      */
-    if (sscanf(filename,"%x+%x",(unsigned int*)&mem->base,(unsigned int*)&mem->size)!=2)
-      return NULL;
+    mem->base = (char *)region->base;
+    mem->size = region->size;
 
     if (mode & ZLIB_FILEFUNC_MODE_CREATE)
       mem->limit=0; /* When writing we start with 0 bytes written */
@@ -136,7 +137,7 @@ uLong ZCALLBACK fwrite_mem_func (opaque, stream, buf, size)
     return size;
 }
 
-long ZCALLBACK ftell_mem_func (opaque, stream)
+ZPOS64_T ZCALLBACK ftell_mem_func (opaque, stream)
    voidpf opaque;
    voidpf stream;
 {
@@ -149,12 +150,13 @@ long ZCALLBACK ftell_mem_func (opaque, stream)
 long ZCALLBACK fseek_mem_func (opaque, stream, offset, origin)
    voidpf opaque;
    voidpf stream;
-   uLong offset;
+   ZPOS64_T offset;
    int origin;
 {
 	(void)opaque;
     ourmemory_t *mem = (ourmemory_t *)stream;
-    uLong new_pos;
+    /* negative offsets wrap around to the right position */
+    ZPOS64_T new_pos;
     switch (origin)
     {
     case ZLIB_FILEFUNC_SEEK_CUR :
@@ -208,8 +210,9 @@ int ZCALLBACK ferror_mem_func (opaque, stream)
     return 0;
 }
 
-void fill_memory_filefunc (pzlib_filefunc_def)
+void fill_memory_filefunc (pzlib_filefunc_def, region)
   zlib_filefunc_def* pzlib_filefunc_def;
+  zlib_mem_region* region;
 {
     pzlib_filefunc_def->zopen_file = fopen_mem_func;
     pzlib_filefunc_def->zread_file = fread_mem_func;
@@ -218,5 +221,5 @@ void fill_memory_filefunc (pzlib_filefunc_def)
     pzlib_filefunc_def->zseek_file = fseek_mem_func;
     pzlib_filefunc_def->zclose_file = fclose_mem_func;
     pzlib_filefunc_def->zerror_file = ferror_mem_func;
-    pzlib_filefunc_def->opaque = NULL;
+    pzlib_filefunc_def->opaque = region;
 }
\ No newline at end of file
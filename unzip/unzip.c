@@ -93,7 +93,8 @@ const char unz_copyright[] =
 /* unz_file_info_interntal contain internal info about a file in zipfile*/
 typedef struct unz_file_info_internal_s
 {
-    uLong offset_curfile;/* relative offset of local header 4 bytes */
+    ZPOS64_T offset_curfile;/* relative offset of local header 4 bytes,
+                               8 in zip64 */
 } unz_file_info_internal;
 
 
@@ -104,21 +105,21 @@ typedef struct
     char  *read_buffer;         /* internal buffer for compressed data */
     z_stream stream;            /* zLib stream structure for inflate */
 
-    uLong pos_in_zipfile;       /* position in byte on the zipfile, for fseek*/
+    ZPOS64_T pos_in_zipfile;    /* position in byte on the zipfile, for fseek*/
     uLong stream_initialised;   /* flag set if stream structure is initialised*/
 
-    uLong offset_local_extrafield;/* offset of the local extra field */
+    ZPOS64_T offset_local_extrafield;/* offset of the local extra field */
     uInt  size_local_extrafield;/* size of the local extra field */
     uLong pos_local_extrafield;   /* position in the local extra field in read*/
 
     uLong crc32;                /* crc32 of all data uncompressed */
     uLong crc32_wait;           /* crc32 we must obtain after decompress all */
-    uLong rest_read_compressed; /* number of byte to be decompressed */
-    uLong rest_read_uncompressed;/*number of byte to be obtained after decomp*/
+    ZPOS64_T rest_read_compressed; /* number of byte to be decompressed */
+    ZPOS64_T rest_read_uncompressed;/*number of byte to be obtained after decomp*/
     zlib_filefunc_def z_filefunc;
     voidpf filestream;        /* io structore of the zipfile */
     uLong compression_method;   /* compression method (0==store) */
-    uLong byte_before_the_zipfile;/* byte before the zipfile, (>0 for sfx)*/
+    ZPOS64_T byte_before_the_zipfile;/* byte before the zipfile, (>0 for sfx)*/
     int   raw;
 } file_in_zip_read_info_s;
 
@@ -130,15 +131,16 @@ typedef struct
     zlib_filefunc_def z_filefunc;
     voidpf filestream;        /* io structore of the zipfile */
     unz_global_info gi;       /* public global information */
-    uLong byte_before_the_zipfile;/* byte before the zipfile, (>0 for sfx)*/
+    ZPOS64_T byte_before_the_zipfile;/* byte before the zipfile, (>0 for sfx)*/
     uLong num_file;             /* number of the current file in the zipfile*/
-    uLong pos_in_central_dir;   /* pos of the current file in the central dir*/
+    ZPOS64_T pos_in_central_dir;/* pos of the current file in the central dir*/
     uLong current_file_ok;      /* flag about the usability of the current file*/
-    uLong central_pos;          /* position of the beginning of the central dir*/
+    ZPOS64_T central_pos;       /* position of the end of central dir record*/
 
-    uLong size_central_dir;     /* size of the central directory  */
-    uLong offset_central_dir;   /* offset of start of central directory with
+    ZPOS64_T size_central_dir;  /* size of the central directory  */
+    ZPOS64_T offset_central_dir;/* offset of start of central directory with
                                    respect to the starting disk number */
+    int isZip64;                /* sizes and offsets came from zip64 records */
 
     unz_file_info cur_file_info; /* public info about the current file in zip*/
     unz_file_info_internal cur_file_info_internal; /* private info about it*/
@@ -258,6 +260,31 @@ local int unzlocal_getLong (pzlib_filefunc_def,filestream,pX)
 }
 
 
+local int unzlocal_getLong64 OF((
+    const zlib_filefunc_def* pzlib_filefunc_def,
+    voidpf filestream,
+    ZPOS64_T *pX));
+
+local int unzlocal_getLong64 (pzlib_filefunc_def,filestream,pX)
+    const zlib_filefunc_def* pzlib_filefunc_def;
+    voidpf filestream;
+    ZPOS64_T *pX;
+{
+    uLong lo, hi;
+    int err;
+
+    err = unzlocal_getLong(pzlib_filefunc_def,filestream,&lo);
+    if (err==UNZ_OK)
+        err = unzlocal_getLong(pzlib_filefunc_def,filestream,&hi);
+
+    if (err==UNZ_OK)
+        *pX = (ZPOS64_T)lo | ((ZPOS64_T)hi<<32);
+    else
+        *pX = 0;
+    return err;
+}
+
+
 /* My own strcmpi / strcasecmp */
 local int strcmpcasenosensitive_internal (fileName1,fileName2)
     const char* fileName1;
@@ -324,19 +351,19 @@ extern int ZEXPORT unzStringFileNameCompare (fileName1,fileName2,iCaseSensitivit
   Locate the Central directory of a zipfile (at the end, just before
     the global comment)
 */
-local uLong unzlocal_SearchCentralDir OF((
+local ZPOS64_T unzlocal_SearchCentralDir OF((
     const zlib_filefunc_def* pzlib_filefunc_def,
     voidpf filestream));
 
-local uLong unzlocal_SearchCentralDir(pzlib_filefunc_def,filestream)
+local ZPOS64_T unzlocal_SearchCentralDir(pzlib_filefunc_def,filestream)
     const zlib_filefunc_def* pzlib_filefunc_def;
     voidpf filestream;
 {
     unsigned char* buf;
-    uLong uSizeFile;
-    uLong uBackRead;
-    uLong uMaxBack=0xffff; /* maximum size of global comment */
-    uLong uPosFound=0;
+    ZPOS64_T uSizeFile;
+    ZPOS64_T uBackRead;
+    ZPOS64_T uMaxBack=0xffff; /* maximum size of global comment */
+    ZPOS64_T uPosFound=0;
 
     if (ZSEEK(*pzlib_filefunc_def,filestream,0,ZLIB_FILEFUNC_SEEK_END) != 0)
         return 0;
@@ -354,7 +381,8 @@ local uLong unzlocal_SearchCentralDir(pzlib_filefunc_def,filestream)
     uBackRead = 4;
     while (uBackRead<uMaxBack)
     {
-        uLong uReadSize,uReadPos ;
+        uLong uReadSize;
+        ZPOS64_T uReadPos;
         int i;
         if (uBackRead+BUFREADCOMMENT>uMaxBack)
             uBackRead = uMaxBack;
@@ -363,7 +391,7 @@ local uLong unzlocal_SearchCentralDir(pzlib_filefunc_def,filestream)
         uReadPos = uSizeFile-uBackRead ;
 
         uReadSize = ((BUFREADCOMMENT+4) < (uSizeFile-uReadPos)) ?
-                     (BUFREADCOMMENT+4) : (uSizeFile-uReadPos);
+                     (BUFREADCOMMENT+4) : (uLong)(uSizeFile-uReadPos);
         if (ZSEEK(*pzlib_filefunc_def,filestream,uReadPos,ZLIB_FILEFUNC_SEEK_SET)!=0)
             break;
 
@@ -385,6 +413,67 @@ local uLong unzlocal_SearchCentralDir(pzlib_filefunc_def,filestream)
     return uPosFound;
 }
 
+/*
+  Locate the zip64 end of central directory record through the locator
+    right before the classic end of central directory, 0 if there is none
+*/
+local ZPOS64_T unzlocal_SearchCentralDir64 OF((
+    const zlib_filefunc_def* pzlib_filefunc_def,
+    voidpf filestream,
+    ZPOS64_T central_pos));
+
+local ZPOS64_T unzlocal_SearchCentralDir64(pzlib_filefunc_def,filestream,
+                                           central_pos)
+    const zlib_filefunc_def* pzlib_filefunc_def;
+    voidpf filestream;
+    ZPOS64_T central_pos;
+{
+    ZPOS64_T relativeOffset;
+    uLong uL;
+
+    if (central_pos<20)
+        return 0;
+    if (ZSEEK(*pzlib_filefunc_def,filestream,central_pos-20,
+              ZLIB_FILEFUNC_SEEK_SET)!=0)
+        return 0;
+
+    /* the locator signature */
+    if ((unzlocal_getLong(pzlib_filefunc_def,filestream,&uL)!=UNZ_OK) ||
+        (uL!=0x07064b50))
+        return 0;
+
+    /* number of the disk with the zip64 end of central dir, only one */
+    if ((unzlocal_getLong(pzlib_filefunc_def,filestream,&uL)!=UNZ_OK) ||
+        (uL!=0))
+        return 0;
+
+    /* relative offset of the zip64 end of central dir record */
+    if (unzlocal_getLong64(pzlib_filefunc_def,filestream,&relativeOffset)!=UNZ_OK)
+        return 0;
+
+    /* total number of disks */
+    if ((unzlocal_getLong(pzlib_filefunc_def,filestream,&uL)!=UNZ_OK) ||
+        (uL>1))
+        return 0;
+
+    if ((ZSEEK(*pzlib_filefunc_def,filestream,relativeOffset,
+               ZLIB_FILEFUNC_SEEK_SET)==0) &&
+        (unzlocal_getLong(pzlib_filefunc_def,filestream,&uL)==UNZ_OK) &&
+        (uL==0x06064b50))
+        return relativeOffset;
+
+    /* with bytes before the zipfile (sfx) the offset is off, without
+       extensible data the record sits right before the locator */
+    if ((central_pos>=20+56) &&
+        (ZSEEK(*pzlib_filefunc_def,filestream,central_pos-20-56,
+               ZLIB_FILEFUNC_SEEK_SET)==0) &&
+        (unzlocal_getLong(pzlib_filefunc_def,filestream,&uL)==UNZ_OK) &&
+        (uL==0x06064b50))
+        return central_pos-20-56;
+
+    return 0;
+}
+
 /*
   Open a Zip file. path contain the full pathname (by example,
      on a Windows NT computer "c:\\test\\zlib114.zip" or on an Unix computer
@@ -400,7 +489,8 @@ extern unzFile ZEXPORT unzOpen2 (path, pzlib_filefunc_def)
 {
     unz_s us;
     unz_s *s;
-    uLong central_pos,uL;
+    ZPOS64_T central_pos,central_end,uL64;
+    uLong uL;
 
     uLong number_disk;          /* number of the current dist, used for
                                    spaning ZIP, unsupported, always 0*/
@@ -416,7 +506,7 @@ extern unzFile ZEXPORT unzOpen2 (path, pzlib_filefunc_def)
         return NULL;
 
     if (pzlib_filefunc_def==NULL)
-        fill_memory_filefunc(&us.z_filefunc);
+        fill_fopen_filefunc(&us.z_filefunc);
     else
         us.z_filefunc = *pzlib_filefunc_def;
 
@@ -431,6 +521,15 @@ extern unzFile ZEXPORT unzOpen2 (path, pzlib_filefunc_def)
     if (central_pos==0)
         err=UNZ_ERRNO;
 
+    /* past 4GB or 65535 entries the real values are in a zip64 record */
+    central_end = 0;
+    if (err==UNZ_OK)
+        central_end = unzlocal_SearchCentralDir64(&us.z_filefunc,us.filestream,
+                                                  central_pos);
+    us.isZip64 = (central_end!=0);
+    if (!us.isZip64)
+        central_end = central_pos;
+
     if (ZSEEK(us.z_filefunc, us.filestream,
                                       central_pos,ZLIB_FILEFUNC_SEEK_SET)!=0)
         err=UNZ_ERRNO;
@@ -455,25 +554,88 @@ extern unzFile ZEXPORT unzOpen2 (path, pzlib_filefunc_def)
     if (unzlocal_getShort(&us.z_filefunc, us.filestream,&number_entry_CD)!=UNZ_OK)
         err=UNZ_ERRNO;
 
-    if ((number_entry_CD!=us.gi.number_entry) ||
-        (number_disk_with_CD!=0) ||
-        (number_disk!=0))
+    /* zip64 saturates these, the record has the real values */
+    if ((!us.isZip64) &&
+        ((number_entry_CD!=us.gi.number_entry) ||
+         (number_disk_with_CD!=0) ||
+         (number_disk!=0)))
         err=UNZ_BADZIPFILE;
 
     /* size of the central directory */
-    if (unzlocal_getLong(&us.z_filefunc, us.filestream,&us.size_central_dir)!=UNZ_OK)
+    if (unzlocal_getLong(&us.z_filefunc, us.filestream,&uL)!=UNZ_OK)
         err=UNZ_ERRNO;
+    us.size_central_dir = uL;
 
     /* offset of start of central directory with respect to the
           starting disk number */
-    if (unzlocal_getLong(&us.z_filefunc, us.filestream,&us.offset_central_dir)!=UNZ_OK)
+    if (unzlocal_getLong(&us.z_filefunc, us.filestream,&uL)!=UNZ_OK)
         err=UNZ_ERRNO;
+    us.offset_central_dir = uL;
 
     /* zipfile comment length */
     if (unzlocal_getShort(&us.z_filefunc, us.filestream,&us.gi.size_comment)!=UNZ_OK)
         err=UNZ_ERRNO;
 
-    if ((central_pos<us.offset_central_dir+us.size_central_dir) &&
+    if (us.isZip64)
+    {
+        if (ZSEEK(us.z_filefunc, us.filestream,
+                  central_end,ZLIB_FILEFUNC_SEEK_SET)!=0)
+            err=UNZ_ERRNO;
+
+        /* the signature, already checked */
+        if (unzlocal_getLong(&us.z_filefunc, us.filestream,&uL)!=UNZ_OK)
+            err=UNZ_ERRNO;
+
+        /* size of the zip64 end of central directory record */
+        if (unzlocal_getLong64(&us.z_filefunc, us.filestream,&uL64)!=UNZ_OK)
+            err=UNZ_ERRNO;
+
+        /* version made by */
+        if (unzlocal_getShort(&us.z_filefunc, us.filestream,&uL)!=UNZ_OK)
+            err=UNZ_ERRNO;
+
+        /* version needed to extract */
+        if (unzlocal_getShort(&us.z_filefunc, us.filestream,&uL)!=UNZ_OK)
+            err=UNZ_ERRNO;
+
+        /* number of this disk */
+        if (unzlocal_getLong(&us.z_filefunc, us.filestream,&number_disk)!=UNZ_OK)
+            err=UNZ_ERRNO;
+
+        /* number of the disk with the start of the central directory */
+        if (unzlocal_getLong(&us.z_filefunc, us.filestream,&number_disk_with_CD)!=UNZ_OK)
+            err=UNZ_ERRNO;
+
+        /* total number of entries in the central dir on this disk */
+        if (unzlocal_getLong64(&us.z_filefunc, us.filestream,&uL64)!=UNZ_OK)
+            err=UNZ_ERRNO;
+        us.gi.number_entry = (uLong)uL64;
+        if ((err==UNZ_OK) && (us.gi.number_entry!=uL64))
+            err=UNZ_BADZIPFILE;
+
+        /* total number of entries in the central dir */
+        if (unzlocal_getLong64(&us.z_filefunc, us.filestream,&uL64)!=UNZ_OK)
+            err=UNZ_ERRNO;
+        number_entry_CD = (uLong)uL64;
+        if ((err==UNZ_OK) && (number_entry_CD!=uL64))
+            err=UNZ_BADZIPFILE;
+
+        /* size of the central directory */
+        if (unzlocal_getLong64(&us.z_filefunc, us.filestream,&us.size_central_dir)!=UNZ_OK)
+            err=UNZ_ERRNO;
+
+        /* offset of start of central directory with respect to the
+              starting disk number */
+        if (unzlocal_getLong64(&us.z_filefunc, us.filestream,&us.offset_central_dir)!=UNZ_OK)
+            err=UNZ_ERRNO;
+
+        if ((number_entry_CD!=us.gi.number_entry) ||
+            (number_disk_with_CD!=0) ||
+            (number_disk!=0))
+            err=UNZ_BADZIPFILE;
+    }
+
+    if ((central_end<us.offset_central_dir+us.size_central_dir) &&
         (err==UNZ_OK))
         err=UNZ_BADZIPFILE;
 
@@ -483,7 +645,7 @@ extern unzFile ZEXPORT unzOpen2 (path, pzlib_filefunc_def)
         return NULL;
     }
 
-    us.byte_before_the_zipfile = central_pos -
+    us.byte_before_the_zipfile = central_end -
                             (us.offset_central_dir+us.size_central_dir);
     us.central_pos = central_pos;
     us.pfile_in_zip_read = NULL;
@@ -560,6 +722,67 @@ local void unzlocal_DosDateToTmuDate (ulDosDate, ptm)
     ptm->tm_sec =  (uInt) (2*(ulDosDate&0x1f)) ;
 }
 
+/*
+  Read the sizes and offset the central directory entry saturated to
+    0xffffffff from its zip64 extended information extra field
+*/
+local int unzlocal_GetZip64Extra OF((unz_s* s,
+                                     unz_file_info *pfile_info,
+                                     unz_file_info_internal *pfile_info_internal));
+
+local int unzlocal_GetZip64Extra (s, pfile_info, pfile_info_internal)
+    unz_s* s;
+    unz_file_info *pfile_info;
+    unz_file_info_internal *pfile_info_internal;
+{
+    ZPOS64_T* fields[3];
+    uLong uHeader,uSize,uDone=0;
+    int i;
+
+    /* only the saturated ones are there, always in this order */
+    fields[0]=&pfile_info->uncompressed_size;
+    fields[1]=&pfile_info->compressed_size;
+    fields[2]=&pfile_info_internal->offset_curfile;
+
+    if (ZSEEK(s->z_filefunc, s->filestream,
+              s->pos_in_central_dir+s->byte_before_the_zipfile+
+              SIZECENTRALDIRITEM+pfile_info->size_filename,
+              ZLIB_FILEFUNC_SEEK_SET)!=0)
+        return UNZ_ERRNO;
+
+    while (uDone+4<=pfile_info->size_file_extra)
+    {
+        if ((unzlocal_getShort(&s->z_filefunc, s->filestream,&uHeader)!=UNZ_OK) ||
+            (unzlocal_getShort(&s->z_filefunc, s->filestream,&uSize)!=UNZ_OK))
+            return UNZ_ERRNO;
+        uDone+=4;
+        if (uDone+uSize>pfile_info->size_file_extra)
+            return UNZ_BADZIPFILE;
+
+        if (uHeader==0x0001)
+        {
+            for (i=0;i<3;i++)
+            {
+                if (*fields[i]!=0xffffffff)
+                    continue;
+                if (uSize<8)
+                    return UNZ_BADZIPFILE;
+                if (unzlocal_getLong64(&s->z_filefunc, s->filestream,fields[i])!=UNZ_OK)
+                    return UNZ_ERRNO;
+                uSize-=8;
+            }
+            return UNZ_OK;
+        }
+
+        if (ZSEEK(s->z_filefunc, s->filestream,uSize,ZLIB_FILEFUNC_SEEK_CUR)!=0)
+            return UNZ_ERRNO;
+        uDone+=uSize;
+    }
+
+    /* saturated but no zip64 field to take the values from */
+    return UNZ_BADZIPFILE;
+}
+
 /*
   Get Info about the current file in the zipfile, with internal only info
 */
@@ -594,7 +817,7 @@ local int unzlocal_GetCurrentFileInfoInternal (file,
     unz_file_info file_info;
     unz_file_info_internal file_info_internal;
     int err=UNZ_OK;
-    uLong uMagic;
+    uLong uMagic,uL;
     long lSeek=0;
 
     if (file==NULL)
@@ -635,11 +858,13 @@ local int unzlocal_GetCurrentFileInfoInternal (file,
     if (unzlocal_getLong(&s->z_filefunc, s->filestream,&file_info.crc) != UNZ_OK)
         err=UNZ_ERRNO;
 
-    if (unzlocal_getLong(&s->z_filefunc, s->filestream,&file_info.compressed_size) != UNZ_OK)
+    if (unzlocal_getLong(&s->z_filefunc, s->filestream,&uL) != UNZ_OK)
         err=UNZ_ERRNO;
+    file_info.compressed_size = uL;
 
-    if (unzlocal_getLong(&s->z_filefunc, s->filestream,&file_info.uncompressed_size) != UNZ_OK)
+    if (unzlocal_getLong(&s->z_filefunc, s->filestream,&uL) != UNZ_OK)
         err=UNZ_ERRNO;
+    file_info.uncompressed_size = uL;
 
     if (unzlocal_getShort(&s->z_filefunc, s->filestream,&file_info.size_filename) != UNZ_OK)
         err=UNZ_ERRNO;
@@ -659,8 +884,9 @@ local int unzlocal_GetCurrentFileInfoInternal (file,
     if (unzlocal_getLong(&s->z_filefunc, s->filestream,&file_info.external_fa) != UNZ_OK)
         err=UNZ_ERRNO;
 
-    if (unzlocal_getLong(&s->z_filefunc, s->filestream,&file_info_internal.offset_curfile) != UNZ_OK)
+    if (unzlocal_getLong(&s->z_filefunc, s->filestream,&uL) != UNZ_OK)
         err=UNZ_ERRNO;
+    file_info_internal.offset_curfile = uL;
 
     lSeek+=file_info.size_filename;
     if ((err==UNZ_OK) && (szFileName!=NULL))
@@ -733,6 +959,12 @@ local int unzlocal_GetCurrentFileInfoInternal (file,
     else
         lSeek+=file_info.size_file_comment;
 
+    /* past 4GB the real values are in the zip64 extra field */
+    if ((err==UNZ_OK) && ((file_info.uncompressed_size==0xffffffff) ||
+        (file_info.compressed_size==0xffffffff) ||
+        (file_info_internal.offset_curfile==0xffffffff)))
+        err=unzlocal_GetZip64Extra(s,&file_info,&file_info_internal);
+
     if ((err==UNZ_OK) && (pfile_info!=NULL))
         *pfile_info=file_info;
 
@@ -806,7 +1038,7 @@ extern int ZEXPORT unzGoToNextFile (file)
     s=(unz_s*)file;
     if (!s->current_file_ok)
         return UNZ_END_OF_LIST_OF_FILE;
-    if (s->gi.number_entry != 0xffff)    /* 2^16 files overflow hack */
+    if (s->isZip64 || s->gi.number_entry != 0xffff) /* 2^16 files overflow hack */
       if (s->num_file+1==s->gi.number_entry)
         return UNZ_END_OF_LIST_OF_FILE;
 
@@ -843,7 +1075,7 @@ extern int ZEXPORT unzLocateFile (file, szFileName, iCaseSensitivity)
     unz_file_info cur_file_infoSaved;
     unz_file_info_internal cur_file_info_internalSaved;
     uLong num_fileSaved;
-    uLong pos_in_central_dirSaved;
+    ZPOS64_T pos_in_central_dirSaved;
 
 
     if (file==NULL)
@@ -903,7 +1135,7 @@ extern int ZEXPORT unzLocateFile (file, szFileName, iCaseSensitivity)
 /*
 typedef struct unz_file_pos_s
 {
-    uLong pos_in_zip_directory;   // offset in file
+    ZPOS64_T pos_in_zip_directory;   // offset in file
     uLong num_of_file;            // # of file
 } unz_file_pos;
 */
@@ -967,7 +1199,7 @@ local int unzlocal_CheckCurrentFileCoherencyHeader (s,piSizeVar,
                                                     psize_local_extrafield)
     unz_s* s;
     uInt* piSizeVar;
-    uLong *poffset_local_extrafield;
+    ZPOS64_T *poffset_local_extrafield;
     uInt  *psize_local_extrafield;
 {
     uLong uMagic,uData,uFlags;
@@ -1019,16 +1251,18 @@ local int unzlocal_CheckCurrentFileCoherencyHeader (s,piSizeVar,
                               ((uFlags & 8)==0))
         err=UNZ_BADZIPFILE;
 
+    /* saturated sizes are in the local zip64 extra field, the
+       central directory already has them */
     if (unzlocal_getLong(&s->z_filefunc, s->filestream,&uData) != UNZ_OK) /* size compr */
         err=UNZ_ERRNO;
     else if ((err==UNZ_OK) && (uData!=s->cur_file_info.compressed_size) &&
-                              ((uFlags & 8)==0))
+                              (uData!=0xffffffff) && ((uFlags & 8)==0))
         err=UNZ_BADZIPFILE;
 
     if (unzlocal_getLong(&s->z_filefunc, s->filestream,&uData) != UNZ_OK) /* size uncompr */
         err=UNZ_ERRNO;
     else if ((err==UNZ_OK) && (uData!=s->cur_file_info.uncompressed_size) &&
-                              ((uFlags & 8)==0))
+                              (uData!=0xffffffff) && ((uFlags & 8)==0))
         err=UNZ_BADZIPFILE;
 
 
@@ -1065,7 +1299,7 @@ extern int ZEXPORT unzOpenCurrentFile3 (file, method, level, raw, password)
     uInt iSizeVar;
     unz_s* s;
     file_in_zip_read_info_s* pfile_in_zip_read_info;
-    uLong offset_local_extrafield;  /* offset of the local extra field */
+    ZPOS64_T offset_local_extrafield;  /* offset of the local extra field */
     uInt  size_local_extrafield;    /* size of the local extra field */
 #    ifndef NOUNCRYPT
     char source[12];
@@ -1570,7 +1804,7 @@ extern int ZEXPORT unzGetGlobalComment (file, szComment, uSizeBuf)
 }
 
 /* Additions by RX '2004 */
-extern uLong ZEXPORT unzGetOffset (file)
+extern ZPOS64_T ZEXPORT unzGetOffset (file)
     unzFile file;
 {
     unz_s* s;
@@ -1580,7 +1814,7 @@ extern uLong ZEXPORT unzGetOffset (file)
     s=(unz_s*)file;
     if (!s->current_file_ok)
       return 0;
-    if (s->gi.number_entry != 0 && s->gi.number_entry != 0xffff)
+    if (s->gi.number_entry != 0 && (s->isZip64 || s->gi.number_entry != 0xffff))
       if (s->num_file==s->gi.number_entry)
          return 0;
     return s->pos_in_central_dir;
@@ -1588,7 +1822,7 @@ extern uLong ZEXPORT unzGetOffset (file)
 
 extern int ZEXPORT unzSetOffset (file, pos)
         unzFile file;
-        uLong pos;
+        ZPOS64_T pos;
 {
     unz_s* s;
     int err;
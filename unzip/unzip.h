@@ -106,8 +106,8 @@ typedef struct unz_file_info_s
     uLong compression_method;   /* compression method              2 bytes */
     uLong dosDate;              /* last mod file date in Dos fmt   4 bytes */
     uLong crc;                  /* crc-32                          4 bytes */
-    uLong compressed_size;      /* compressed size                 4 bytes */
-    uLong uncompressed_size;    /* uncompressed size               4 bytes */
+    ZPOS64_T compressed_size;   /* compressed size                 4 bytes, 8 in zip64 */
+    ZPOS64_T uncompressed_size; /* uncompressed size               4 bytes, 8 in zip64 */
     uLong size_filename;        /* filename length                 2 bytes */
     uLong size_file_extra;      /* extra field length              2 bytes */
     uLong size_file_comment;    /* file comment length             2 bytes */
@@ -141,6 +141,8 @@ extern unzFile ZEXPORT unzOpen OF((const char *path));
        return value is NULL.
      Else, the return value is a unzFile Handle, usable with other function
        of this unzip package.
+   ZIP64 archives, past 4GB or with more than 65535 entries, open
+     the same way.
 */
 
 extern unzFile ZEXPORT unzOpen2 OF((const char *path,
@@ -209,7 +211,7 @@ extern int ZEXPORT unzLocateFile OF((unzFile file,
 /* unz_file_info contain information about a file in the zipfile */
 typedef struct unz_file_pos_s
 {
-    uLong pos_in_zip_directory;   /* offset in zip file directory */
+    ZPOS64_T pos_in_zip_directory;/* offset in zip file directory */
     uLong num_of_file;            /* # of file */
 } unz_file_pos;
 
@@ -340,10 +342,10 @@ extern int ZEXPORT unzGetLocalExtrafield OF((unzFile file,
 /***************************************************************************/
 
 /* Get the current file offset */
-extern uLong ZEXPORT unzGetOffset (unzFile file);
+extern ZPOS64_T ZEXPORT unzGetOffset (unzFile file);
 
 /* Set the current file offset */
-extern int ZEXPORT unzSetOffset (unzFile file, uLong pos);
+extern int ZEXPORT unzSetOffset (unzFile file, ZPOS64_T pos);
 
 
 
@@ -9,6 +9,7 @@
 #include <stdbool.h>
 #include <inttypes.h>
 #include "cpu.h"
+#include "state.h"
 
 static uint8_t vrc_irqCtr;
 static uint8_t vrc_irqCurCtr;
@@ -30,6 +31,13 @@ void vrc_irq_init()
 	vrc_irqEnable_after_ack = false;
 	vrc_irqCyclemode = false;
 	vrc_irq_scanTblPos = 0;
+	stateAddVar(vrc_irqCtr);
+	stateAddVar(vrc_irqCurCtr);
+	stateAddVar(vrc_irqPrescaler);
+	stateAddVar(vrc_irq_scanTblPos);
+	stateAddVar(vrc_irqEnabled);
+	stateAddVar(vrc_irqEnable_after_ack);
+	stateAddVar(vrc_irqCyclemode);
 }
 
 void vrc_irq_setlatch(uint8_t val)